@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ast.h"
+#include "ast_file.h"
+#include "semantic_analyzer.h"
+#include "code_generator.h"
+#include "bytecode.h"
+#include "rule_image.h"
+#include "scanner_bridge.h"
+#include "toolchain.h"
+
+// Parser state from Phase 2
+extern AST* ast_root;
+extern int yyparse(void);
+
+void print_header() {
+    printf("LOGICC - SINGLE-PROCESS COMPILER\n");
+    printf("Lexical -> Syntax -> Semantic -> Code Generation (in memory)\n");
+    printf("\n\n");
+}
+
+void print_usage(const char* program) {
+    printf("Usage: %s [-d] [-a] [-b | -c | -f prefix | -s name | -j | -i | -n count | -r image] [-w window] [-o output.s] [input]\n", program);
+    printf("       %s -l image\n", program);
+    printf("\n");
+    printf("  input       Source file (default: test.txt)\n");
+    printf("  -o FILE     Assembly output (default: program.s, batch.s with -b,\n");
+    printf("              PREFIX.s with -f, NAME.s with -s)\n");
+    printf("  -d          Also write the intermediate files of the\n");
+    printf("              four-phase pipeline: tokens.txt, ast.bin,\n");
+    printf("              ast.txt, annotated_ast.bin, annotated_ast.txt,\n");
+    printf("              symbol_table.txt and semantic_errors.txt\n");
+    printf("  -a          Print AST memory statistics (nodes, array bytes)\n");
+    printf("  -c          Also write the program as an ELF object (the -o\n");
+    printf("              name with .o), ready for ld without running as\n");
+    printf("  -b          Emit batch kernels instead of a program: logic_batch\n");
+    printf("              evaluates 256 records per block with AVX2, or a\n");
+    printf("              scalar fallback; literal-initialised variables\n");
+    printf("              become input lanes\n");
+    printf("  -f PREFIX   Emit PREFIX_eval(inputs, outputs) as a function with\n");
+    printf("              its header PREFIX.h, the object PREFIX.o and the\n");
+    printf("              archive libPREFIX.a; inputs follow the -b convention\n");
+    printf("  -s NAME     Link the -b kernels with the streaming runtime as the\n");
+    printf("              executable NAME (assembly NAME.s): NAME in.bin out.bin\n");
+    printf("              evaluates every record of in.bin, one byte per\n");
+    printf("              input, and writes a result bitmap per variable\n");
+    printf("  -j          JIT: compile the -f function straight to machine\n");
+    printf("              code in memory and run it once with the inputs\n");
+    printf("              at their declared values; nothing is written\n");
+    printf("  -i          Interpret: compile to bytecode and run it once on\n");
+    printf("              the VM, with the same inputs as -j\n");
+    printf("  -n COUNT    Benchmark the VM against the JIT over COUNT\n");
+    printf("              evaluations and check that their results agree\n");
+    printf("  -r IMAGE    Write a rule image: bytecode, name and statement\n");
+    printf("              tables and the -j machine code in one file\n");
+    printf("  -l IMAGE    Load a rule image with one mmap and run it as -i\n");
+    printf("              does, without reading any source\n");
+    printf("  -w N        Peephole window in instructions (default %d, 0 = off)\n",
+           DEFAULT_PEEPHOLE_WINDOW);
+    printf("\n");
+}
+
+// The object written beside an assembly file: program.s -> program.o
+static void object_name(char* buffer, size_t size, const char* assembly_file) {
+    size_t length = strlen(assembly_file);
+    if (length > 2 && strcmp(assembly_file + length - 2, ".s") == 0) length -= 2;
+    snprintf(buffer, size, "%.*s.o", (int)length, assembly_file);
+}
+
+int main(int argc, char* argv[]) {
+    const char* input_file = "test.txt";
+    const char* output_file = NULL;
+    int dump_intermediates = 0;
+    int batch = 0;
+    const char* function_prefix = NULL;
+    const char* stream_name = NULL;
+    int jit = 0;
+    int object = 0;
+    int interpret = 0;
+    long benchmark_count = 0;
+    const char* image_file = NULL;
+    const char* load_file = NULL;
+    int ast_stats = 0;
+    int peephole_window = DEFAULT_PEEPHOLE_WINDOW;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "dacbf:s:jin:r:l:w:o:h")) != -1) {
+        switch (opt) {
+            case 'd':
+                dump_intermediates = 1;
+                break;
+            case 'a':
+                ast_stats = 1;
+                break;
+            case 'c':
+                object = 1;
+                break;
+            case 'b':
+                batch = 1;
+                break;
+            case 'f':
+                function_prefix = optarg;
+                break;
+            case 's':
+                stream_name = optarg;
+                break;
+            case 'j':
+                jit = 1;
+                break;
+            case 'i':
+                interpret = 1;
+                break;
+            case 'n':
+                benchmark_count = atol(optarg);
+                if (benchmark_count <= 0) {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'r':
+                image_file = optarg;
+                break;
+            case 'l':
+                load_file = optarg;
+                break;
+            case 'w':
+                peephole_window = atoi(optarg);
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind < argc) {
+        input_file = argv[optind];
+    }
+    if (batch + (function_prefix != NULL) + (stream_name != NULL) + jit + object + interpret + (benchmark_count > 0) +
+        (image_file != NULL) + (load_file != NULL) > 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // A rule image needs none of the four phases
+    if (load_file) {
+        RuleImage* image = load_rule_image(load_file);
+        int result = image ? rule_image_run_declared(image) : -1;
+        unload_rule_image(image);
+        if (result < 0) {
+            printf("LOGICC FAILED: Could not run %s\n\n", load_file);
+            return 1;
+        }
+        return 0;
+    }
+    char function_file[512];
+    if (!output_file && (function_prefix || stream_name)) {
+        snprintf(function_file, sizeof(function_file), "%s.s",
+                 function_prefix ? function_prefix : stream_name);
+        output_file = function_file;
+    }
+    if (!output_file) {
+        output_file = batch ? "batch.s" : "program.s";
+    }
+    char object_file[512];
+    object_name(object_file, sizeof(object_file), function_prefix ? function_prefix : output_file);
+
+    print_header();
+
+    // Phase 1 + 2: the flex scanner feeds yyparse directly
+    FILE* token_dump = NULL;
+    if (dump_intermediates) {
+        token_dump = fopen("tokens.txt", "w");
+        if (!token_dump) {
+            printf("ERROR: Cannot create tokens.txt\n\n");
+            return 1;
+        }
+    }
+
+    if (open_source_scanner(input_file, token_dump) != 0) {
+        printf("ERROR: %s not found!\n\n", input_file);
+        if (token_dump) fclose(token_dump);
+        return 1;
+    }
+
+    printf("PARSING SOURCE: %s\n", input_file);
+    int parse_result = yyparse();
+    int token_count = scanned_token_count();
+    close_source_scanner();
+    if (token_dump) fclose(token_dump);
+
+    if (parse_result != 0 || !ast_root || ast_root->root == NO_NODE) {
+        printf("LOGICC FAILED: Parsing errors occurred\n\n");
+        free_asts();
+        return 1;
+    }
+
+    printf(" Tokens scanned: %d\n", token_count);
+    printf(" Statements parsed: %u\n", ast_root->statement_count);
+    printf("\n\n");
+
+    if (ast_stats) {
+        print_ast_stats(stdout);
+        printf("\n\n");
+    }
+
+    if (dump_intermediates) {
+        write_ast_file(ast_root, "ast.bin", 0);
+        print_ast_to_file(ast_root, "ast.txt");
+    }
+
+    // Phase 3: semantic analysis on the parser's tree
+    SemanticContext* sem_ctx = create_semantic_context();
+    int analysis_result = perform_semantic_analysis(sem_ctx, ast_root);
+
+    if (dump_intermediates) {
+        write_ast_file(ast_root, "annotated_ast.bin", 1);
+        generate_annotated_ast(sem_ctx, ast_root, "annotated_ast.txt");
+        print_symbol_table_to_file(sem_ctx->symbol_table, "symbol_table.txt");
+        print_semantic_errors_to_file(sem_ctx, "semantic_errors.txt");
+    }
+
+    if (analysis_result != 0) {
+        print_semantic_errors(sem_ctx);
+        printf("LOGICC FAILED: Semantic errors occurred\n\n");
+        free_semantic_context(sem_ctx);
+        free_asts();
+        return 1;
+    }
+
+    // Phase 4: code generation from the same tree
+    int codegen_result;
+    char header_file[512];
+    if (jit) {
+        JitRule* rule = jit_compile_rule(ast_root, peephole_window);
+        codegen_result = rule ? 0 : -1;
+        if (rule) {
+            jit_run_declared(rule);
+            jit_free_rule(rule);
+        }
+    } else if (interpret) {
+        Bytecode* bytecode = compile_bytecode(ast_root);
+        codegen_result = bytecode ? 0 : -1;
+        if (bytecode) {
+            vm_run_declared(bytecode);
+            free_bytecode(bytecode);
+        }
+    } else if (benchmark_count > 0) {
+        codegen_result = benchmark_rule(ast_root, benchmark_count, peephole_window);
+    } else if (image_file) {
+        codegen_result = write_rule_image(ast_root, image_file, peephole_window, 1);
+    } else if (batch || stream_name) {
+        codegen_result = generate_batch_kernels(ast_root, output_file, peephole_window);
+    } else if (function_prefix) {
+        snprintf(header_file, sizeof(header_file), "%s.h", function_prefix);
+        codegen_result = generate_rule_function(ast_root, function_prefix, output_file,
+                                                header_file, object_file, peephole_window);
+    } else {
+        CodeGenContext* cg_ctx = create_codegen_context(TARGET_X86_64);
+        cg_ctx->peephole_window = peephole_window;
+        codegen_result = generate_assembly(cg_ctx, ast_root, output_file);
+        if (codegen_result == 0 && object) {
+            codegen_result = write_program_object(cg_ctx, object_file);
+        }
+        free_codegen_context(cg_ctx);
+    }
+
+    free_semantic_context(sem_ctx);
+    free_asts();
+    free_interned_symbols();
+
+    if (codegen_result != 0) {
+        printf("LOGICC FAILED: Code generation errors occurred\n\n");
+        return 1;
+    }
+
+    if (jit || interpret || benchmark_count > 0) {
+        return 0;
+    }
+    if (image_file) {
+        printf("Rule image written to %s\n", image_file);
+        return 0;
+    }
+    printf("Assembly written to %s\n", output_file);
+    if (object || function_prefix) {
+        printf("Object written to %s\n", object_file);
+    }
+    if (stream_name && build_stream_evaluator(output_file, stream_name) != 0) {
+        printf("LOGICC FAILED: Could not link %s\n\n", stream_name);
+        return 1;
+    }
+    if (function_prefix) {
+        printf("Header written to %s\n", header_file);
+        if (build_library(object_file, function_prefix) != 0) {
+            printf("LOGICC FAILED: Could not archive %s\n\n", object_file);
+            return 1;
+        }
+    }
+    if (dump_intermediates) {
+        printf("Intermediate files: tokens.txt ast.bin ast.txt annotated_ast.bin annotated_ast.txt symbol_table.txt semantic_errors.txt\n");
+    }
+
+    return 0;
+}
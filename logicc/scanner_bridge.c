@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ast.h"
+#include "parser.tab.h"  // Token codes shared with phase1/tokens.h
+#include "scanner_bridge.h"
+#include "source_map.h"
+
+// Phase 1 scanner, compiled with yylex renamed to lex_scan (see Makefile)
+extern int lex_scan(void);
+extern FILE* yyin;
+extern char* yytext;
+extern int yyleng;
+extern int yylineno;
+extern int yycolumn;
+extern const char* token_type_to_string(int type);
+
+// Line tracking read by the grammar actions in parser.y
+int current_line = 1;
+
+static FILE* token_dump = NULL;
+static int token_count = 0;
+
+// Mapped source scanned in place; unused when falling back to yyin
+static SourceMap source;
+
+
+// Open the source file for scanning: mapped when possible, else via yyin
+int open_source_scanner(const char* filename, FILE* dump) {
+    if (map_source_file(filename, &source) == 0) {
+        if (begin_source_scan(&source) != 0) {
+            unmap_source_file(&source);
+        }
+    }
+    
+    if (!source.data) {
+        yyin = fopen(filename, "r");
+        if (!yyin) {
+            fprintf(stderr, "Error: Cannot open source file '%s'\n", filename);
+            return -1;
+        }
+    }
+    
+    yylineno = 1;
+    yycolumn = 1;
+    current_line = 1;
+    token_count = 0;
+    token_dump = dump;
+    
+    if (token_dump) {
+        fprintf(token_dump, "# Tokens generated by Phase 1 Lexical Analyzer\n");
+        fprintf(token_dump, "# Input file: %s\n", filename);
+        fprintf(token_dump, "#\n");
+    }
+    
+    return 0;
+}
+
+// Bison's yylex function - pulls the next token from the flex scanner
+int yylex(void) {
+    int token = lex_scan();
+    current_line = yylineno;
+    
+    if (token == 0) {
+        return 0;  // EOF
+    }
+    
+    if (token == INVALID_TOKEN) {
+        if (token_dump) {
+            fprintf(token_dump, "INVALID_TOKEN %s\n", yytext);
+        }
+        return token;
+    }
+    
+    if (token == T_TRUE || token == T_FALSE) {
+        yylval.bool_val = (token == T_TRUE);
+        if (token_dump) {
+            fprintf(token_dump, "%s %s %d\n", token_type_to_string(token), yytext, yylval.bool_val);
+        }
+    } else {
+        if (token == IDENTIFIER) {
+            yylval.symbol = intern_name(yytext, yyleng);
+        }
+        if (token_dump) {
+            fprintf(token_dump, "%s %s\n", token_type_to_string(token), yytext);
+        }
+    }
+    
+    token_count++;
+    return token;
+}
+
+// Close the source file and finish the token dump
+void close_source_scanner(void) {
+    if (token_dump) {
+        fprintf(token_dump, "#\n");
+        fprintf(token_dump, "# Total tokens: %d\n", token_count);
+        fprintf(token_dump, "EOF\n");
+        token_dump = NULL;
+    }
+    
+    if (source.data) {
+        end_source_scan();
+        unmap_source_file(&source);
+    }
+    
+    if (yyin) {
+        fclose(yyin);
+        yyin = NULL;
+    }
+}
+
+int scanned_token_count(void) {
+    return token_count;
+}
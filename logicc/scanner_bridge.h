@@ -0,0 +1,13 @@
+#ifndef SCANNER_BRIDGE_H
+#define SCANNER_BRIDGE_H
+
+#include <stdio.h>
+
+// Feeds the Phase 1 flex scanner straight into the Phase 2 bison parser,
+// replacing the tokens.txt round trip. When token_dump is non-NULL every
+// token is also written to it in the Phase 1 tokens.txt format.
+int open_source_scanner(const char* filename, FILE* token_dump);
+void close_source_scanner(void);
+int scanned_token_count(void);
+
+#endif // SCANNER_BRIDGE_H
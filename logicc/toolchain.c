@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "toolchain.h"
+
+// Streaming runtime source, set by the Makefile
+#ifndef STREAM_RUNTIME
+#define STREAM_RUNTIME "../phase4/stream_runtime.c"
+#endif
+
+// Run an external tool and wait for it; returns its exit status
+static int run_tool(char* const argv[]) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        execvp(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    int status;
+    if (waitpid(pid, &status, 0) < 0) {
+        perror("waitpid");
+        return -1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int build_library(const char* object_file, const char* prefix) {
+    char archive_file[512];
+    snprintf(archive_file, sizeof(archive_file), "lib%s.a", prefix);
+
+    char* archive[] = {"ar", "rcs", archive_file, (char*)object_file, NULL};
+    unlink(archive_file); // ar would otherwise add to a stale archive
+    if (run_tool(archive) != 0) return -1;
+    printf("Library written to %s\n", archive_file);
+    return 0;
+}
+
+int build_stream_evaluator(const char* assembly_file, const char* executable) {
+    char* compile[] = {"cc", "-O2", "-o", (char*)executable, STREAM_RUNTIME,
+                       (char*)assembly_file, NULL};
+    if (run_tool(compile) != 0) return -1;
+    printf("Evaluator written to %s\n", executable);
+    return 0;
+}
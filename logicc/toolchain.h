@@ -0,0 +1,16 @@
+#ifndef TOOLCHAIN_H
+#define TOOLCHAIN_H
+
+// Runs the system archiver and C compiler on generated code. Kept out of
+// main_logicc.c because <sys/wait.h> pulls in <sys/ucontext.h>, whose
+// REG_* names clash with the code generator's registers.
+
+// Archive object_file (written by phase 4, no assembler needed) as
+// libPREFIX.a; returns 0 on success
+int build_library(const char* object_file, const char* prefix);
+
+// Link batch kernels (assembly_file, from -s) with the streaming runtime
+// as the executable; returns 0 on success
+int build_stream_evaluator(const char* assembly_file, const char* executable);
+
+#endif // TOOLCHAIN_H
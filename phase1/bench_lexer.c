@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tokens.h"
+#include "source_map.h"
+#include "fast_lexer.h"
+
+// Lexer benchmark: runs the flex scanner and the hand-written backend over
+// the same corpus, reports MB/s and tokens/s for both, and checks that they
+// produce the same token stream (kind, offset, length, line, column).
+//
+//   lexer_bench              generated corpus (32 MB)
+//   lexer_bench FILE         corpus read from FILE
+//   lexer_bench -s MB        generated corpus of MB megabytes
+
+#define TIMED_PASSES 5
+
+// Flex scanner state from lex.yy.c
+extern int yylex(void);
+extern char* yytext;
+extern int yyleng;
+
+typedef struct {
+    FastToken* tokens;
+    size_t count;
+    size_t capacity;
+} TokenList;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void list_add(TokenList* list, const FastToken* token) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4096;
+        list->tokens = realloc(list->tokens, list->capacity * sizeof(FastToken));
+        if (!list->tokens) {
+            fprintf(stderr, "Out of memory for token list\n");
+            exit(1);
+        }
+    }
+    list->tokens[list->count++] = *token;
+}
+
+// Statements covering every lexical form of lexer.l
+static const char* corpus_lines[] = {
+    "x%d = TRUE\n",
+    "y%d = x%d AND NOT x%d OR false\n",
+    "z_%d equals (x%d -> y%d) <=> E_Q q%d x%d\n",
+    "\tw%d = x%d xnor y%d === U_Q r%d (x%d && y%d || ~z_%d)\r\n",
+    "v%d = x%d ==> y%d <--> x%d <==> y%d --> x%d => y%d <-> x%d\n",
+    "long_identifier_name_for_simd_scanning_%d = IMPLIES implies XOR xor iff IFF if IF\n",
+    "u%d EQUALS D_IMPLIES DOUBLEIMPLIES EQUIVALENT equivalent TRUE true FALSE and or not\n",
+    "\n    t%d  =   not   (  a%d   XOR   b%d  )      \n",
+};
+
+// Build a corpus of at least target bytes, followed by the two NUL bytes
+// yy_scan_buffer needs
+static char* generate_corpus(size_t target, size_t* size) {
+    size_t capacity = target + 4096;
+    char* corpus = malloc(capacity + 2);
+    if (!corpus) {
+        return NULL;
+    }
+
+    size_t used = 0;
+    int n = 0;
+    int lines = sizeof(corpus_lines) / sizeof(corpus_lines[0]);
+    while (used < target) {
+        const char* format = corpus_lines[n % lines];
+        int written = snprintf(corpus + used, capacity - used, format, n, n, n, n, n, n, n, n, n);
+        if (written < 0 || (size_t)written >= capacity - used) {
+            break;
+        }
+        used += written;
+        n++;
+    }
+
+    corpus[used] = '\0';
+    corpus[used + 1] = '\0';
+    *size = used;
+    return corpus;
+}
+
+// One flex pass; records tokens when list is non-NULL
+static size_t run_flex(SourceMap* source, TokenList* list) {
+    size_t count = 0;
+    if (begin_source_scan(source) != 0) {
+        fprintf(stderr, "yy_scan_buffer rejected the corpus\n");
+        exit(1);
+    }
+    yylineno = 1;
+    yycolumn = 1;
+
+    int kind;
+    while ((kind = yylex()) != 0) {
+        if (list) {
+            FastToken token;
+            token.kind = kind;
+            token.offset = (uint32_t)(yytext - source->data);
+            token.length = (uint32_t)yyleng;
+            token.line = yylineno;
+            token.column = token_column;
+            list_add(list, &token);
+        }
+        count++;
+    }
+
+    end_source_scan();
+    return count;
+}
+
+// One fast-backend pass; records tokens when list is non-NULL
+static size_t run_fast(SourceMap* source, TokenList* list) {
+    size_t count = 0;
+    FastLexer lexer;
+    FastToken token;
+
+    fast_lexer_init(&lexer, source->data, source->size);
+    while (fast_lexer_next(&lexer, &token) != 0) {
+        if (list) {
+            list_add(list, &token);
+        }
+        count++;
+    }
+    return count;
+}
+
+static void report(const char* name, size_t bytes, size_t tokens, double seconds) {
+    double mb = bytes / (1024.0 * 1024.0);
+    printf(" %-16s %10.1f MB/s %12.2f Mtokens/s %10.3f s/pass\n",
+           name, mb / seconds, tokens / seconds / 1e6, seconds);
+}
+
+// Best of TIMED_PASSES runs
+static double time_backend(size_t (*run)(SourceMap*, TokenList*), SourceMap* source, size_t* tokens) {
+    double best = 0;
+    for (int i = 0; i < TIMED_PASSES; i++) {
+        double start = now_seconds();
+        *tokens = run(source, NULL);
+        double elapsed = now_seconds() - start;
+        if (i == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+static int compare_streams(const TokenList* flex, const TokenList* fast) {
+    size_t count = flex->count < fast->count ? flex->count : fast->count;
+    for (size_t i = 0; i < count; i++) {
+        const FastToken* a = &flex->tokens[i];
+        const FastToken* b = &fast->tokens[i];
+        if (a->kind != b->kind || a->offset != b->offset || a->length != b->length ||
+            a->line != b->line || a->column != b->column) {
+            printf(" MISMATCH at token %zu:\n", i + 1);
+            printf("   flex: %s offset %u length %u line %d column %d\n",
+                   token_type_to_string(a->kind), a->offset, a->length, a->line, a->column);
+            printf("   fast: %s offset %u length %u line %d column %d\n",
+                   token_type_to_string(b->kind), b->offset, b->length, b->line, b->column);
+            return -1;
+        }
+    }
+    if (flex->count != fast->count) {
+        printf(" MISMATCH: flex produced %zu tokens, fast produced %zu\n", flex->count, fast->count);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    const char* corpus_file = NULL;
+    size_t target = 32u * 1024 * 1024;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            target = (size_t)atoi(argv[++i]) * 1024 * 1024;
+        } else if (argv[i][0] != '-' && !corpus_file) {
+            corpus_file = argv[i];
+        } else {
+            printf("Usage: %s [-s MB] [corpus]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("LEXER BENCHMARK\n");
+    printf("\n");
+
+    SourceMap source;
+    int mapped = 0;
+    if (corpus_file) {
+        if (map_source_file(corpus_file, &source) != 0) {
+            printf("ERROR: Cannot map corpus '%s'\n", corpus_file);
+            return 1;
+        }
+        mapped = 1;
+        printf(" Corpus: %s\n", corpus_file);
+    } else {
+        memset(&source, 0, sizeof(source));
+        source.data = generate_corpus(target, &source.size);
+        if (!source.data) {
+            printf("ERROR: Cannot allocate corpus\n");
+            return 1;
+        }
+        printf(" Corpus: generated\n");
+    }
+    printf(" Size: %.1f MB\n", source.size / (1024.0 * 1024.0));
+    printf(" Fast backend vector width: %s\n", fast_lexer_simd_name());
+    printf("\n");
+
+    // Same token stream from both backends
+    TokenList flex_tokens = {0};
+    TokenList fast_tokens = {0};
+    run_flex(&source, &flex_tokens);
+    run_fast(&source, &fast_tokens);
+    int result = compare_streams(&flex_tokens, &fast_tokens);
+    if (result == 0) {
+        printf(" Token streams identical: %zu tokens\n", flex_tokens.count);
+    }
+    free(flex_tokens.tokens);
+    free(fast_tokens.tokens);
+    printf("\n");
+
+    size_t flex_count = 0;
+    size_t fast_count = 0;
+    double flex_time = time_backend(run_flex, &source, &flex_count);
+    double fast_time = time_backend(run_fast, &source, &fast_count);
+
+    printf(" Best of %d passes:\n", TIMED_PASSES);
+    report("flex (lexer.l)", source.size, flex_count, flex_time);
+    report("fast_lexer.c", source.size, fast_count, fast_time);
+    printf(" Speedup: %.2fx\n", flex_time / fast_time);
+    printf("\n");
+
+    if (mapped) {
+        unmap_source_file(&source);
+    } else {
+        free(source.data);
+    }
+
+    return result == 0 ? 0 : 1;
+}
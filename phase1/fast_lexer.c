@@ -0,0 +1,330 @@
+#include <string.h>
+#include "tokens.h"
+#include "fast_lexer.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Character classes for first-byte dispatch
+enum {
+    CC_OTHER = 0,
+    CC_SPACE,       // ' ', '\t', '\r'
+    CC_NEWLINE,     // '\n'
+    CC_IDENT,       // [A-Za-z_]
+    CC_DIGIT,       // [0-9], only valid after the first identifier byte
+    CC_AMP,         // &&
+    CC_BAR,         // ||
+    CC_TILDE,       // ~
+    CC_MINUS,       // -> -->
+    CC_EQUAL,       // = === ==> =>
+    CC_LESS,        // <-> <=> <--> <==>
+    CC_LPAREN,
+    CC_RPAREN
+};
+
+static unsigned char char_class[256];
+static int char_class_ready = 0;
+
+static void init_char_classes(void) {
+    memset(char_class, CC_OTHER, sizeof(char_class));
+    for (int c = 'a'; c <= 'z'; c++) char_class[c] = CC_IDENT;
+    for (int c = 'A'; c <= 'Z'; c++) char_class[c] = CC_IDENT;
+    for (int c = '0'; c <= '9'; c++) char_class[c] = CC_DIGIT;
+    char_class['_'] = CC_IDENT;
+    char_class[' '] = CC_SPACE;
+    char_class['\t'] = CC_SPACE;
+    char_class['\r'] = CC_SPACE;
+    char_class['\n'] = CC_NEWLINE;
+    char_class['&'] = CC_AMP;
+    char_class['|'] = CC_BAR;
+    char_class['~'] = CC_TILDE;
+    char_class['-'] = CC_MINUS;
+    char_class['='] = CC_EQUAL;
+    char_class['<'] = CC_LESS;
+    char_class['('] = CC_LPAREN;
+    char_class[')'] = CC_RPAREN;
+    char_class_ready = 1;
+}
+
+// Keyword and word-operator forms of lexer.l. Slots are
+// KEYWORD_HASH(first, last, length); the function was searched offline to
+// be collision-free for exactly these 28 words, so one compare decides.
+typedef struct {
+    const char* word;
+    unsigned length;
+    int kind;
+} Keyword;
+
+#define KEYWORD_HASH(first, last, length) \
+    (((unsigned)(first) + 2u * (unsigned)(last) + 8u * (unsigned)(length)) & 63u)
+
+static const Keyword keywords[64] = {
+    [1] = { "and", 3, AND },
+    [3] = { "OR", 2, OR },
+    [5] = { "if", 2, IF },
+    [7] = { "implies", 7, IMPLIES },
+    [13] = { "iff", 3, IFF_KEYWORD },
+    [14] = { "NOT", 3, NOT },
+    [15] = { "U_Q", 3, FORALL },
+    [18] = { "DOUBLEIMPLIES", 13, IFF },
+    [20] = { "XOR", 3, XOR },
+    [24] = { "false", 5, T_FALSE },
+    [27] = { "EQUALS", 6, ASSIGN },
+    [28] = { "XNOR", 4, XNOR },
+    [29] = { "equivalent", 10, EQUIV },
+    [30] = { "true", 4, T_TRUE },
+    [33] = { "AND", 3, AND },
+    [35] = { "or", 2, OR },
+    [37] = { "IF", 2, IF },
+    [39] = { "IMPLIES", 7, IMPLIES },
+    [45] = { "IFF", 3, IFF_KEYWORD },
+    [46] = { "not", 3, NOT },
+    [50] = { "D_IMPLIES", 9, IFF },
+    [52] = { "xor", 3, XOR },
+    [56] = { "FALSE", 5, T_FALSE },
+    [59] = { "equals", 6, ASSIGN },
+    [60] = { "xnor", 4, XNOR },
+    [61] = { "EQUIVALENT", 10, EQUIV },
+    [62] = { "TRUE", 4, T_TRUE },
+    [63] = { "E_Q", 3, EXISTS },
+};
+
+// Classify a scanned identifier-shaped word
+static int lookup_keyword(const unsigned char* word, size_t length) {
+    if (length < 2 || length > 13) {
+        return IDENTIFIER;
+    }
+
+    const Keyword* keyword = &keywords[KEYWORD_HASH(word[0], word[length - 1], length)];
+    if (keyword->length == length && memcmp(keyword->word, word, length) == 0) {
+        return keyword->kind;
+    }
+    return IDENTIFIER;
+}
+
+// Account for the newlines of a skipped block; bit i of mask is data[base + i]
+static inline void note_newlines(FastLexer* lexer, size_t base, uint32_t mask) {
+    if (mask) {
+        lexer->line += __builtin_popcount(mask);
+        lexer->line_start = base + (31 - __builtin_clz(mask)) + 1;
+    }
+}
+
+// Advance past [ \t\r\n]*, keeping line numbers in step
+static void skip_whitespace(FastLexer* lexer) {
+    const unsigned char* data = (const unsigned char*)lexer->data;
+    const size_t size = lexer->size;
+    size_t pos = lexer->pos;
+
+    // Most tokens are followed by at most one space
+    if (pos >= size || (char_class[data[pos]] != CC_SPACE && char_class[data[pos]] != CC_NEWLINE)) {
+        return;
+    }
+
+#if defined(__AVX2__)
+    const __m256i space32 = _mm256_set1_epi8(' ');
+    const __m256i tab32 = _mm256_set1_epi8('\t');
+    const __m256i cr32 = _mm256_set1_epi8('\r');
+    const __m256i newline32 = _mm256_set1_epi8('\n');
+    while (pos + 32 <= size) {
+        __m256i c = _mm256_loadu_si256((const __m256i*)(data + pos));
+        __m256i nl = _mm256_cmpeq_epi8(c, newline32);
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(c, space32),
+                                                     _mm256_cmpeq_epi8(c, tab32)),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(c, cr32), nl));
+        uint32_t stop = ~(uint32_t)_mm256_movemask_epi8(ws);
+        uint32_t newlines = (uint32_t)_mm256_movemask_epi8(nl);
+        if (stop) {
+            int n = __builtin_ctz(stop);
+            note_newlines(lexer, pos, newlines & ((1u << n) - 1));
+            lexer->pos = pos + n;
+            return;
+        }
+        note_newlines(lexer, pos, newlines);
+        pos += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i space16 = _mm_set1_epi8(' ');
+    const __m128i tab16 = _mm_set1_epi8('\t');
+    const __m128i cr16 = _mm_set1_epi8('\r');
+    const __m128i newline16 = _mm_set1_epi8('\n');
+    while (pos + 16 <= size) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(data + pos));
+        __m128i nl = _mm_cmpeq_epi8(c, newline16);
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, space16),
+                                               _mm_cmpeq_epi8(c, tab16)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(c, cr16), nl));
+        uint32_t stop = ~(uint32_t)_mm_movemask_epi8(ws) & 0xFFFFu;
+        uint32_t newlines = (uint32_t)_mm_movemask_epi8(nl);
+        if (stop) {
+            int n = __builtin_ctz(stop);
+            note_newlines(lexer, pos, newlines & ((1u << n) - 1));
+            lexer->pos = pos + n;
+            return;
+        }
+        note_newlines(lexer, pos, newlines);
+        pos += 16;
+    }
+#endif
+
+    while (pos < size && (char_class[data[pos]] == CC_SPACE || char_class[data[pos]] == CC_NEWLINE)) {
+        if (data[pos] == '\n') {
+            lexer->line++;
+            lexer->line_start = pos + 1;
+        }
+        pos++;
+    }
+    lexer->pos = pos;
+}
+
+// Offset of the first byte at or after pos that is not [A-Za-z0-9_]
+static size_t scan_identifier_end(const unsigned char* data, size_t pos, size_t size) {
+#if defined(__AVX2__)
+    const __m256i case32 = _mm256_set1_epi8(0x20);
+    const __m256i before_a32 = _mm256_set1_epi8('a' - 1);
+    const __m256i after_z32 = _mm256_set1_epi8('z' + 1);
+    const __m256i before_0_32 = _mm256_set1_epi8('0' - 1);
+    const __m256i after_9_32 = _mm256_set1_epi8('9' + 1);
+    const __m256i underscore32 = _mm256_set1_epi8('_');
+    while (pos + 32 <= size) {
+        __m256i c = _mm256_loadu_si256((const __m256i*)(data + pos));
+        // Bytes >= 0x80 compare as negative and fall outside every range
+        __m256i lower = _mm256_or_si256(c, case32);
+        __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, before_a32),
+                                         _mm256_cmpgt_epi8(after_z32, lower));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, before_0_32),
+                                         _mm256_cmpgt_epi8(after_9_32, c));
+        __m256i ident = _mm256_or_si256(_mm256_or_si256(alpha, digit),
+                                        _mm256_cmpeq_epi8(c, underscore32));
+        uint32_t stop = ~(uint32_t)_mm256_movemask_epi8(ident);
+        if (stop) {
+            return pos + __builtin_ctz(stop);
+        }
+        pos += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i case16 = _mm_set1_epi8(0x20);
+    const __m128i before_a16 = _mm_set1_epi8('a' - 1);
+    const __m128i after_z16 = _mm_set1_epi8('z' + 1);
+    const __m128i before_0_16 = _mm_set1_epi8('0' - 1);
+    const __m128i after_9_16 = _mm_set1_epi8('9' + 1);
+    const __m128i underscore16 = _mm_set1_epi8('_');
+    while (pos + 16 <= size) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(data + pos));
+        __m128i lower = _mm_or_si128(c, case16);
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a16),
+                                      _mm_cmplt_epi8(lower, after_z16));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, before_0_16),
+                                      _mm_cmplt_epi8(c, after_9_16));
+        __m128i ident = _mm_or_si128(_mm_or_si128(alpha, digit),
+                                     _mm_cmpeq_epi8(c, underscore16));
+        uint32_t stop = ~(uint32_t)_mm_movemask_epi8(ident) & 0xFFFFu;
+        if (stop) {
+            return pos + __builtin_ctz(stop);
+        }
+        pos += 16;
+    }
+#endif
+
+    while (pos < size && (char_class[data[pos]] == CC_IDENT || char_class[data[pos]] == CC_DIGIT)) {
+        pos++;
+    }
+    return pos;
+}
+
+void fast_lexer_init(FastLexer* lexer, const char* data, size_t size) {
+    if (!char_class_ready) {
+        init_char_classes();
+    }
+
+    lexer->data = data;
+    lexer->size = size;
+    lexer->pos = 0;
+    lexer->line = 1;
+    lexer->line_start = 0;
+}
+
+int fast_lexer_next(FastLexer* lexer, FastToken* token) {
+    skip_whitespace(lexer);
+
+    const unsigned char* data = (const unsigned char*)lexer->data;
+    const size_t size = lexer->size;
+    const size_t start = lexer->pos;
+
+    // Operator lookahead; reads past the end see NUL, which matches nothing
+    #define PEEK(n) (start + (n) < size ? data[start + (n)] : '\0')
+
+    int kind = 0;
+    size_t length = 0;
+
+    if (start < size) {
+        kind = INVALID_TOKEN;
+        length = 1;
+
+        switch (char_class[data[start]]) {
+            case CC_IDENT:
+                length = scan_identifier_end(data, start + 1, size) - start;
+                kind = lookup_keyword(data + start, length);
+                break;
+            case CC_AMP:
+                if (PEEK(1) == '&') { kind = AND; length = 2; }
+                break;
+            case CC_BAR:
+                if (PEEK(1) == '|') { kind = OR; length = 2; }
+                break;
+            case CC_TILDE:
+                kind = NOT;
+                break;
+            case CC_MINUS:
+                if (PEEK(1) == '>') { kind = IMPLIES; length = 2; }
+                else if (PEEK(1) == '-' && PEEK(2) == '>') { kind = IMPLIES; length = 3; }
+                break;
+            case CC_EQUAL:
+                kind = ASSIGN;
+                if (PEEK(1) == '=' && PEEK(2) == '=') { kind = EQUIV; length = 3; }
+                else if (PEEK(1) == '=' && PEEK(2) == '>') { kind = IMPLIES; length = 3; }
+                else if (PEEK(1) == '>') { kind = IMPLIES; length = 2; }
+                break;
+            case CC_LESS:
+                if (PEEK(1) == '-' && PEEK(2) == '>') { kind = IFF; length = 3; }
+                else if (PEEK(1) == '=' && PEEK(2) == '>') { kind = IFF; length = 3; }
+                else if (PEEK(1) == '-' && PEEK(2) == '-' && PEEK(3) == '>') { kind = IFF; length = 4; }
+                else if (PEEK(1) == '=' && PEEK(2) == '=' && PEEK(3) == '>') { kind = IFF; length = 4; }
+                break;
+            case CC_LPAREN:
+                kind = LPAREN;
+                break;
+            case CC_RPAREN:
+                kind = RPAREN;
+                break;
+            default:
+                break;
+        }
+    }
+
+    #undef PEEK
+
+    token->kind = kind;
+    token->offset = (uint32_t)start;
+    token->length = (uint32_t)length;
+    token->line = lexer->line;
+    token->column = (int)(start - lexer->line_start) + 1;
+
+    lexer->pos = start + length;
+    return kind;
+}
+
+const char* fast_lexer_simd_name(void) {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,37 @@
+#ifndef FAST_LEXER_H
+#define FAST_LEXER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Hand-written lexer backend producing the same token stream as lexer.l:
+// a 256-entry character class table drives dispatch, SSE2/AVX2 loops skip
+// whitespace and find identifier ends, and keyword/word-operator forms are
+// looked up in a perfect hash after the identifier is scanned.
+
+typedef struct {
+    int kind;           // Token code from tokens.h, 0 at end of input
+    uint32_t offset;    // Lexeme start in the source
+    uint32_t length;    // Lexeme length in bytes
+    int line;           // Same numbering as yylineno
+    int column;         // Same numbering as token_column
+} FastToken;
+
+typedef struct {
+    const char* data;
+    size_t size;
+    size_t pos;
+    int line;
+    size_t line_start;  // Offset of the first byte of the current line
+} FastLexer;
+
+void fast_lexer_init(FastLexer* lexer, const char* data, size_t size);
+
+// Scan the next token; returns its kind (0 at end of input). An
+// unrecognized character is returned as a one-byte INVALID_TOKEN.
+int fast_lexer_next(FastLexer* lexer, FastToken* token);
+
+// Vector width compiled in: "AVX2", "SSE2" or "scalar"
+const char* fast_lexer_simd_name(void);
+
+#endif // FAST_LEXER_H
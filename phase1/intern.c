@@ -0,0 +1,181 @@
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+
+// Names live in fixed chunks so symbol_name() pointers stay valid while
+// the table grows; slots is an open-addressing index of IDs (power of two,
+// at most half full) probed with the cached 32-bit hash.
+
+#define NAME_CHUNK_SIZE (64 * 1024)
+
+typedef struct NameChunk {
+    struct NameChunk* next;
+    size_t used;
+    size_t size;
+    char data[];
+} NameChunk;
+
+static NameChunk* chunks = NULL;
+
+static const char** names = NULL;
+static uint32_t* lengths = NULL;
+static uint32_t* hashes = NULL;
+static uint32_t symbol_count = 0;
+static uint32_t symbol_capacity = 0;
+
+static SymbolId* slots = NULL;
+static uint32_t slot_mask = 0;
+
+// FNV-1a
+static uint32_t hash_name(const char* name, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Copy a name into the chunk pool, NUL-terminated
+static const char* store_name(const char* name, size_t length) {
+    if (!chunks || chunks->size - chunks->used < length + 1) {
+        size_t size = length + 1 > NAME_CHUNK_SIZE ? length + 1 : NAME_CHUNK_SIZE;
+        NameChunk* chunk = malloc(sizeof(NameChunk) + size);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->next = chunks;
+        chunk->used = 0;
+        chunk->size = size;
+        chunks = chunk;
+    }
+
+    char* copy = chunks->data + chunks->used;
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+    chunks->used += length + 1;
+    return copy;
+}
+
+// Rebuild the slot index at twice the size
+static int grow_slots(void) {
+    uint32_t new_size = slot_mask ? (slot_mask + 1) * 2 : 256;
+    SymbolId* new_slots = malloc(new_size * sizeof(SymbolId));
+    if (!new_slots) {
+        return -1;
+    }
+    memset(new_slots, 0xFF, new_size * sizeof(SymbolId));
+
+    uint32_t new_mask = new_size - 1;
+    for (SymbolId id = 0; id < symbol_count; id++) {
+        uint32_t slot = hashes[id] & new_mask;
+        while (new_slots[slot] != NO_SYMBOL) {
+            slot = (slot + 1) & new_mask;
+        }
+        new_slots[slot] = id;
+    }
+
+    free(slots);
+    slots = new_slots;
+    slot_mask = new_mask;
+    return 0;
+}
+
+static int grow_symbols(void) {
+    uint32_t new_capacity = symbol_capacity ? symbol_capacity * 2 : 128;
+    const char** new_names = realloc(names, new_capacity * sizeof(*names));
+    if (!new_names) return -1;
+    names = new_names;
+    uint32_t* new_lengths = realloc(lengths, new_capacity * sizeof(*lengths));
+    if (!new_lengths) return -1;
+    lengths = new_lengths;
+    uint32_t* new_hashes = realloc(hashes, new_capacity * sizeof(*hashes));
+    if (!new_hashes) return -1;
+    hashes = new_hashes;
+    symbol_capacity = new_capacity;
+    return 0;
+}
+
+SymbolId intern_name(const char* name, size_t length) {
+    if (!name) {
+        return NO_SYMBOL;
+    }
+
+    uint32_t hash = hash_name(name, length);
+
+    if (slots) {
+        uint32_t slot = hash & slot_mask;
+        while (slots[slot] != NO_SYMBOL) {
+            SymbolId id = slots[slot];
+            if (hashes[id] == hash && lengths[id] == length &&
+                memcmp(names[id], name, length) == 0) {
+                return id;
+            }
+            slot = (slot + 1) & slot_mask;
+        }
+    }
+
+    // New name: keep the index at most half full
+    if (!slots || (symbol_count + 1) * 2 > slot_mask + 1) {
+        if (grow_slots() != 0) {
+            return NO_SYMBOL;
+        }
+    }
+    if (symbol_count == symbol_capacity && grow_symbols() != 0) {
+        return NO_SYMBOL;
+    }
+
+    const char* stored = store_name(name, length);
+    if (!stored) {
+        return NO_SYMBOL;
+    }
+
+    SymbolId id = symbol_count++;
+    names[id] = stored;
+    lengths[id] = (uint32_t)length;
+    hashes[id] = hash;
+
+    uint32_t slot = hash & slot_mask;
+    while (slots[slot] != NO_SYMBOL) {
+        slot = (slot + 1) & slot_mask;
+    }
+    slots[slot] = id;
+
+    return id;
+}
+
+SymbolId intern_string(const char* name) {
+    return name ? intern_name(name, strlen(name)) : NO_SYMBOL;
+}
+
+const char* symbol_name(SymbolId id) {
+    return id < symbol_count ? names[id] : "<no symbol>";
+}
+
+size_t symbol_name_length(SymbolId id) {
+    return id < symbol_count ? lengths[id] : 0;
+}
+
+uint32_t interned_symbol_count(void) {
+    return symbol_count;
+}
+
+void free_interned_symbols(void) {
+    while (chunks) {
+        NameChunk* next = chunks->next;
+        free(chunks);
+        chunks = next;
+    }
+
+    free(names);
+    free(lengths);
+    free(hashes);
+    free(slots);
+    names = NULL;
+    lengths = NULL;
+    hashes = NULL;
+    slots = NULL;
+    symbol_count = 0;
+    symbol_capacity = 0;
+    slot_mask = 0;
+}
@@ -0,0 +1,27 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Process-wide identifier interning. Each distinct name is stored once and
+// gets a dense SymbolId (0, 1, 2, ... in order of first appearance); the
+// AST, the symbol table and the code generator key everything by that ID
+// and compare IDs instead of strings.
+
+typedef uint32_t SymbolId;
+
+#define NO_SYMBOL UINT32_MAX
+
+// Intern a name (need not be NUL-terminated) and return its ID
+SymbolId intern_name(const char* name, size_t length);
+SymbolId intern_string(const char* name);
+
+// Stored name and length of an interned ID (valid until free_interned_symbols)
+const char* symbol_name(SymbolId id);
+size_t symbol_name_length(SymbolId id);
+
+uint32_t interned_symbol_count(void);
+void free_interned_symbols(void);
+
+#endif // INTERN_H
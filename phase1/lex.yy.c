@@ -577,6 +577,20 @@ char *yytext;
 
 YYSTYPE yylval;
 
+// Column tracking: token_column is where the current match starts,
+// yycolumn is where the next one will start (both 1-based)
+int yycolumn = 1;
+int token_column = 1;
+
+static void track_column(const char* text, int length) {
+    token_column = yycolumn;
+    for (int i = 0; i < length; i++) {
+        yycolumn = (text[i] == '\n') ? 1 : yycolumn + 1;
+    }
+}
+
+#define YY_USER_ACTION track_column(yytext, yyleng);
+
 const char* token_type_to_string(TokenType type) {
     switch (type) {
         case AND: return "AND";
@@ -602,9 +616,9 @@ const char* token_type_to_string(TokenType type) {
         default: return "UNKNOWN";
     }
 }
-#line 606 "lex.yy.c"
+#line 620 "lex.yy.c"
 #define YY_NO_INPUT 1
-#line 608 "lex.yy.c"
+#line 622 "lex.yy.c"
 
 #define INITIAL 0
 
@@ -819,10 +833,10 @@ YY_DECL
 		}
 
 	{
-#line 51 "lexer.l"
+#line 65 "lexer.l"
 
 
-#line 826 "lex.yy.c"
+#line 840 "lex.yy.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -891,82 +905,82 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 53 "lexer.l"
+#line 67 "lexer.l"
 { return AND; }
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 54 "lexer.l"
+#line 68 "lexer.l"
 { return OR; }
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 55 "lexer.l"
+#line 69 "lexer.l"
 { return NOT; }
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 56 "lexer.l"
+#line 70 "lexer.l"
 { return XOR; }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 57 "lexer.l"
+#line 71 "lexer.l"
 { return XNOR; }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 59 "lexer.l"
+#line 73 "lexer.l"
 { return IMPLIES; }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 60 "lexer.l"
+#line 74 "lexer.l"
 { return IFF; }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 62 "lexer.l"
+#line 76 "lexer.l"
 { return ASSIGN; }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 63 "lexer.l"
+#line 77 "lexer.l"
 { return EQUIV; }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 65 "lexer.l"
+#line 79 "lexer.l"
 { return EXISTS; }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 66 "lexer.l"
+#line 80 "lexer.l"
 { return FORALL; }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 68 "lexer.l"
+#line 82 "lexer.l"
 { return IF; }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 69 "lexer.l"
+#line 83 "lexer.l"
 { return IFF_KEYWORD; }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 71 "lexer.l"
+#line 85 "lexer.l"
 { return LPAREN; }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 72 "lexer.l"
+#line 86 "lexer.l"
 { return RPAREN; }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 74 "lexer.l"
+#line 88 "lexer.l"
 { 
     yylval.bool_val = 1; 
     return T_TRUE; 
@@ -974,7 +988,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 78 "lexer.l"
+#line 92 "lexer.l"
 { 
     yylval.bool_val = 0; 
     return T_FALSE; 
@@ -982,7 +996,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 83 "lexer.l"
+#line 97 "lexer.l"
 { 
     yylval.str = yytext; 
     return IDENTIFIER; 
@@ -991,12 +1005,12 @@ YY_RULE_SETUP
 case 19:
 /* rule 19 can match eol */
 YY_RULE_SETUP
-#line 88 "lexer.l"
+#line 102 "lexer.l"
 ;
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 90 "lexer.l"
+#line 104 "lexer.l"
 {
     fprintf(stderr, "Lexer error: Unrecognized character '%s' at line %d\n", yytext, yylineno);
     return INVALID_TOKEN;
@@ -1004,10 +1018,10 @@ YY_RULE_SETUP
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 95 "lexer.l"
+#line 109 "lexer.l"
 ECHO;
 	YY_BREAK
-#line 1011 "lex.yy.c"
+#line 1025 "lex.yy.c"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -1983,5 +1997,5 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 95 "lexer.l"
+#line 109 "lexer.l"
 
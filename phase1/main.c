@@ -3,20 +3,28 @@
 #include <string.h>
 #include <unistd.h>
 #include "tokens.h"
+#include "token_stream.h"
+#include "source_map.h"
+#include "fast_lexer.h"
+#include "intern.h"
 
 // External declarations for flex-generated functions
 extern int yylex(void);
 extern FILE* yyin;
 extern char* yytext;
+extern int yyleng;
 
 void yyerror(const char* msg) {
     fprintf(stderr, "Error: %s at line %d\n", msg, yylineno);
 }
 
-void print_header() {
+void print_header(int write_text) {
     printf("LEXICAL ANALYZER\n");
     printf("Input:  test.txt\n");
-    printf("Output: tokens.txt - token streams\n");
+    printf("Output: tokens.bin - binary token stream\n");
+    if (write_text) {
+        printf("        tokens.txt - readable token listing\n");
+    }
 }
 
 void print_input_content(const char* filename) {
@@ -43,6 +51,25 @@ void print_input_content(const char* filename) {
     printf("\n\n");
 }
 
+// Same listing as print_input_content, read from the mapped source
+void print_mapped_content(const char* filename, const SourceMap* source) {
+    printf("INPUT FILE: %s\n", filename);
+    printf("\n");
+    
+    const char* line = source->data;
+    const char* end = source->data + source->size;
+    int line_num = 1;
+    while (line < end) {
+        const char* newline = memchr(line, '\n', end - line);
+        const char* line_end = newline ? newline : end;
+        printf(" %2d: %.*s\n", line_num++, (int)(line_end - line), line);
+        line = newline ? newline + 1 : end;
+    }
+    
+    printf("\n");
+    printf("\n\n");
+}
+
 void print_token_header() {
     printf("TOKENIZATION PROCESS\n");
     printf("\n");
@@ -50,8 +77,8 @@ void print_token_header() {
     printf(" ────────────────────────────────────────────────────────────────────\n");
 }
 
-void print_token_line(int line, const char* token_type, const char* lexeme, const char* value, const char* description) {
-    printf(" %-4d %-12s %-15s %-6s %s\n", line, token_type, lexeme, value ? value : "─", description);
+void print_token_line(int line, const char* token_type, const char* lexeme, int length, const char* value, const char* description) {
+    printf(" %-4d %-12s %-15.*s %-6s %s\n", line, token_type, length, lexeme, value ? value : "─", description);
 }
 
 void print_token_footer(int token_count) {
@@ -92,91 +119,291 @@ const char* get_token_description(TokenType type) {
     }
 }
 
-int tokenize_file_to_tokens(const char* input_filename, const char* output_filename) {
-    // Open input file
-    FILE* input_file = fopen(input_filename, "r");
-    if (!input_file) {
-        printf("ERROR: Cannot open input file '%s'\n\n", input_filename);
+// Token records collected during scanning, written to the binary stream
+// in one pass once the input is exhausted. Identifiers are interned as
+// they are scanned, so each distinct name is copied once (straight from
+// the mapped source or yytext) and the string table is the intern table.
+typedef struct {
+    TokenRecord* records;
+    uint32_t count;
+    uint32_t capacity;
+} TokenStreamBuilder;
+
+// Append one token; identifiers are interned and stored by symbol ID
+int stream_add_token(TokenStreamBuilder* builder, int kind, const char* lexeme, int length, int line, int column) {
+    if (length > UINT16_MAX) {
+        printf("ERROR: Lexeme at line %d is longer than %d bytes\n\n", line, UINT16_MAX);
         return -1;
     }
-    fclose(input_file);
     
-    // Open output file for tokens
-    FILE* token_file = fopen(output_filename, "w");
-    if (!token_file) {
-        printf("ERROR: Cannot create output file '%s'\n\n", output_filename);
-        return -1;
+    if (builder->count == builder->capacity) {
+        uint32_t new_capacity = builder->capacity ? builder->capacity * 2 : 64;
+        TokenRecord* records = realloc(builder->records, new_capacity * sizeof(TokenRecord));
+        if (!records) {
+            printf("ERROR: Out of memory for token records\n\n");
+            return -1;
+        }
+        builder->records = records;
+        builder->capacity = new_capacity;
     }
     
-    // Set input for flex
-    FILE* old_yyin = yyin;
-    yyin = fopen(input_filename, "r");
-    if (!yyin) {
-        printf("ERROR: Cannot reopen input file for tokenization\n\n");
-        fclose(token_file);
+    TokenRecord* record = &builder->records[builder->count++];
+    record->kind = (uint16_t)kind;
+    record->length = (uint16_t)length;
+    record->line = (uint32_t)line;
+    record->column = (uint32_t)column;
+    record->symbol = TOKEN_STREAM_NO_SYMBOL;
+    
+    if (kind == IDENTIFIER) {
+        record->symbol = intern_name(lexeme, length);
+        if (record->symbol == NO_SYMBOL) {
+            printf("ERROR: Out of memory for identifier names\n\n");
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+// Write header, records and the interned names in symbol ID order
+int stream_write(const TokenStreamBuilder* builder, FILE* out) {
+    uint32_t symbol_count = interned_symbol_count();
+    uint32_t string_table_size = 0;
+    for (SymbolId id = 0; id < symbol_count; id++) {
+        string_table_size += (uint32_t)symbol_name_length(id) + 1;
+    }
+    
+    TokenStreamHeader header;
+    memcpy(header.magic, TOKEN_STREAM_MAGIC, sizeof(header.magic));
+    header.version = TOKEN_STREAM_VERSION;
+    header.token_count = builder->count;
+    header.symbol_count = symbol_count;
+    header.string_table_size = string_table_size;
+    
+    if (fwrite(&header, sizeof(header), 1, out) != 1) {
+        return -1;
+    }
+    if (builder->count > 0 &&
+        fwrite(builder->records, sizeof(TokenRecord), builder->count, out) != builder->count) {
+        return -1;
+    }
+    for (SymbolId id = 0; id < symbol_count; id++) {
+        size_t length = symbol_name_length(id) + 1;
+        if (fwrite(symbol_name(id), 1, length, out) != length) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void stream_free(TokenStreamBuilder* builder) {
+    free(builder->records);
+    memset(builder, 0, sizeof(*builder));
+    free_interned_symbols();
+}
+
+// Record, list and print one token; the lexeme need not be NUL-terminated
+int emit_token(TokenStreamBuilder* builder, FILE* text_file, int token, const char* lexeme, int length, int line, int column) {
+    if (stream_add_token(builder, token, lexeme, length, line, column) != 0) {
         return -1;
     }
     
-    // Reset line number
-    extern int yylineno;
-    yylineno = 1;
+    if (token == INVALID_TOKEN) {
+        print_token_line(line, "INVALID", lexeme, length, "ERROR", "Unrecognized character");
+        if (text_file) fprintf(text_file, "INVALID_TOKEN %.*s\n", length, lexeme);
+        return 0;
+    }
+    
+    const char* token_name = token_type_to_string(token);
+    const char* description = get_token_description(token);
+    char value_str[20] = "─";
+    
+    // Handle different token types
+    if (token == T_TRUE || token == T_FALSE) {
+        snprintf(value_str, sizeof(value_str), "%s", token == T_TRUE ? "true" : "false");
+        if (text_file) fprintf(text_file, "%s %.*s %d\n", token_name, length, lexeme, token == T_TRUE);
+    } else if (token == IDENTIFIER) {
+        snprintf(value_str, sizeof(value_str), "%.*s", length, lexeme);
+        if (text_file) fprintf(text_file, "%s %.*s\n", token_name, length, lexeme);
+    } else {
+        if (text_file) fprintf(text_file, "%s %.*s\n", token_name, length, lexeme);
+    }
     
-    // Write header to token file
-    fprintf(token_file, "# Tokens generated by Phase 1 Lexical Analyzer\n");
-    fprintf(token_file, "# Input file: %s\n", input_filename);
-    fprintf(token_file, "#\n");
+    print_token_line(line, token_name, lexeme, length,
+                    (token == T_TRUE || token == T_FALSE || token == IDENTIFIER) ? value_str : NULL, 
+                    description);
+    
+    return 0;
+}
+
+// Scan tokens from the current flex input until EOF or an invalid token
+int scan_tokens(TokenStreamBuilder* builder, FILE* text_file) {
+    // Reset line and column numbers
+    yylineno = 1;
+    yycolumn = 1;
     
     // Print tokenization header
     print_token_header();
     
-    // Tokenize input and write to file
     int token;
     int token_count = 0;
     
     while ((token = yylex()) != 0) {
+        if (emit_token(builder, text_file, token, yytext, yyleng, yylineno, token_column) != 0) {
+            return -1;
+        }
         if (token == INVALID_TOKEN) {
-            print_token_line(yylineno, "INVALID", yytext, "ERROR", "Unrecognized character");
-            fprintf(token_file, "INVALID_TOKEN %s\n", yytext);
             break;
         }
-        
-        const char* token_name = token_type_to_string(token);
-        const char* description = get_token_description(token);
-        char value_str[20] = "─";
-        
-        // Handle different token types
-        if (token == T_TRUE || token == T_FALSE) {
-            snprintf(value_str, sizeof(value_str), "%s", yylval.bool_val ? "true" : "false");
-            fprintf(token_file, "%s %s %d\n", token_name, yytext, yylval.bool_val);
-        } else if (token == IDENTIFIER) {
-            snprintf(value_str, sizeof(value_str), "%s", yytext);
-            fprintf(token_file, "%s %s\n", token_name, yytext);
-        } else {
-            fprintf(token_file, "%s %s\n", token_name, yytext);
+        token_count++;
+    }
+    
+    return token_count;
+}
+
+// Same loop over the hand-written backend (fast_lexer.c)
+int scan_tokens_fast(TokenStreamBuilder* builder, FILE* text_file, const SourceMap* source) {
+    FastLexer lexer;
+    FastToken token;
+    int token_count = 0;
+    
+    fast_lexer_init(&lexer, source->data, source->size);
+    
+    // Print tokenization header
+    print_token_header();
+    
+    while (fast_lexer_next(&lexer, &token) != 0) {
+        const char* lexeme = source->data + token.offset;
+        if (token.kind == INVALID_TOKEN) {
+            // Same diagnostic as the catch-all rule in lexer.l
+            fprintf(stderr, "Lexer error: Unrecognized character '%c' at line %d\n", *lexeme, token.line);
+        }
+        if (emit_token(builder, text_file, token.kind, lexeme, (int)token.length, token.line, token.column) != 0) {
+            return -1;
+        }
+        if (token.kind == INVALID_TOKEN) {
+            break;
         }
-        
-        print_token_line(yylineno, token_name, yytext, 
-                        (token == T_TRUE || token == T_FALSE || token == IDENTIFIER) ? value_str : NULL, 
-                        description);
-        
         token_count++;
     }
     
-    // Write footer to token file
-    fprintf(token_file, "#\n");
-    fprintf(token_file, "# Total tokens: %d\n", token_count);
-    fprintf(token_file, "EOF\n");
+    return token_count;
+}
+
+// Open the binary stream and the optional text listing
+int open_token_outputs(const char* input_filename, const char* output_filename, const char* text_filename,
+                       FILE** token_file, FILE** text_file) {
+    *token_file = fopen(output_filename, "wb");
+    if (!*token_file) {
+        printf("ERROR: Cannot create output file '%s'\n\n", output_filename);
+        return -1;
+    }
     
-    // Cleanup
-    fclose(yyin);
-    yyin = old_yyin;
+    // Optional readable listing in the old tokens.txt format
+    *text_file = NULL;
+    if (text_filename) {
+        *text_file = fopen(text_filename, "w");
+        if (!*text_file) {
+            printf("ERROR: Cannot create output file '%s'\n\n", text_filename);
+            fclose(*token_file);
+            return -1;
+        }
+        
+        fprintf(*text_file, "# Tokens generated by Phase 1 Lexical Analyzer\n");
+        fprintf(*text_file, "# Input file: %s\n", input_filename);
+        fprintf(*text_file, "#\n");
+    }
+    
+    return 0;
+}
+
+// Write the collected stream and close both outputs
+int finish_token_outputs(TokenStreamBuilder* builder, int token_count, const char* output_filename,
+                         FILE* token_file, FILE* text_file) {
+    int failed = token_count < 0;
+    
+    if (!failed && stream_write(builder, token_file) != 0) {
+        printf("ERROR: Cannot write token stream to '%s'\n\n", output_filename);
+        failed = 1;
+    }
+    stream_free(builder);
     fclose(token_file);
     
+    // Write footer to text token file
+    if (text_file) {
+        fprintf(text_file, "#\n");
+        fprintf(text_file, "# Total tokens: %d\n", token_count);
+        fprintf(text_file, "EOF\n");
+        fclose(text_file);
+    }
+    
+    if (failed) {
+        return -1;
+    }
+    
     print_token_footer(token_count);
     
     return token_count;
 }
 
+// Tokenize through stdio: flex reads the file via yyin
+int tokenize_file_to_tokens(const char* input_filename, const char* output_filename, const char* text_filename) {
+    // Set input for flex
+    FILE* old_yyin = yyin;
+    yyin = fopen(input_filename, "r");
+    if (!yyin) {
+        printf("ERROR: Cannot open input file '%s'\n\n", input_filename);
+        yyin = old_yyin;
+        return -1;
+    }
+    
+    FILE* token_file;
+    FILE* text_file;
+    if (open_token_outputs(input_filename, output_filename, text_filename, &token_file, &text_file) != 0) {
+        fclose(yyin);
+        yyin = old_yyin;
+        return -1;
+    }
+    
+    TokenStreamBuilder builder = {0};
+    int token_count = scan_tokens(&builder, text_file);
+    
+    // Cleanup
+    fclose(yyin);
+    yyin = old_yyin;
+    
+    return finish_token_outputs(&builder, token_count, output_filename, token_file, text_file);
+}
+
+// Tokenize a mapped source in place: yytext (or the fast backend's
+// lexemes) point into the mapping, and identifiers are interned straight
+// from it
+int tokenize_mapped_source(SourceMap* source, const char* input_filename,
+                           const char* output_filename, const char* text_filename, int use_fast) {
+    if (!use_fast && begin_source_scan(source) != 0) {
+        printf("ERROR: Cannot scan mapped input file '%s'\n\n", input_filename);
+        return -1;
+    }
+    
+    FILE* token_file;
+    FILE* text_file;
+    if (open_token_outputs(input_filename, output_filename, text_filename, &token_file, &text_file) != 0) {
+        if (!use_fast) end_source_scan();
+        return -1;
+    }
+    
+    TokenStreamBuilder builder = {0};
+    int token_count;
+    if (use_fast) {
+        token_count = scan_tokens_fast(&builder, text_file, source);
+    } else {
+        token_count = scan_tokens(&builder, text_file);
+        end_source_scan();
+    }
+    
+    return finish_token_outputs(&builder, token_count, output_filename, token_file, text_file);
+}
+
 void create_default_test_file() {
     FILE* test_file = fopen("test.txt", "w");
     if (test_file) {
@@ -196,26 +423,75 @@ void create_default_test_file() {
     }
 }
 
-int main() {
-    print_header();
+// Backend used when --backend is not given (make LEXER_BACKEND=fast)
+#ifndef LEXER_BACKEND
+#define LEXER_BACKEND "flex"
+#endif
+
+int main(int argc, char* argv[]) {
+    // --text also writes the readable tokens.txt listing,
+    // --stdio reads the input through yyin instead of mapping it,
+    // --backend=flex|fast picks the flex scanner or fast_lexer.c
+    int write_text = 0;
+    int use_stdio = 0;
+    const char* backend = LEXER_BACKEND;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--text") == 0) {
+            write_text = 1;
+        } else if (strcmp(argv[i], "--stdio") == 0) {
+            use_stdio = 1;
+        } else if (strncmp(argv[i], "--backend=", 10) == 0) {
+            backend = argv[i] + 10;
+        } else {
+            printf("Usage: %s [--text] [--stdio] [--backend=flex|fast]\n\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    int use_fast = strcmp(backend, "fast") == 0;
+    if (!use_fast && strcmp(backend, "flex") != 0) {
+        printf("ERROR: Unknown lexer backend '%s' (expected flex or fast)\n\n", backend);
+        return 1;
+    }
+    if (use_fast && use_stdio) {
+        printf("ERROR: The fast backend scans mapped input only; drop --stdio\n\n");
+        return 1;
+    }
+    
+    print_header(write_text);
     
     // Check if test.txt exists, if not create it
-    FILE* test_file = fopen("test.txt", "r");
-    if (!test_file) {
+    if (access("test.txt", F_OK) != 0) {
         create_default_test_file();
-    } else {
-        fclose(test_file);
     }
     
-    // Display input file content
-    print_input_content("test.txt");
+    // Map the input once; fall back to flex over stdio if it cannot be mapped
+    const char* text_output = write_text ? "tokens.txt" : NULL;
+    SourceMap source;
+    int token_count;
     
-    // Process the test file
-    int token_count = tokenize_file_to_tokens("test.txt", "tokens.txt");
+    if (!use_stdio && map_source_file("test.txt", &source) == 0) {
+        // Display input file content
+        print_mapped_content("test.txt", &source);
+        
+        if (use_fast) {
+            printf("LEXER BACKEND: fast (%s)\n\n", fast_lexer_simd_name());
+        }
+        
+        // Process the test file
+        token_count = tokenize_mapped_source(&source, "test.txt", "tokens.bin", text_output, use_fast);
+        unmap_source_file(&source);
+    } else {
+        // Display input file content
+        print_input_content("test.txt");
+        
+        // Process the test file
+        token_count = tokenize_file_to_tokens("test.txt", "tokens.bin", text_output);
+    }
     
     if (token_count >= 0) {
         // Display output file information
-        print_output_file_info("tokens.txt", token_count);
+        print_output_file_info("tokens.bin", token_count);
         
         
         return 0;
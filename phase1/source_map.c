@@ -0,0 +1,85 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "source_map.h"
+
+// Flex buffer API from lex.yy.c
+typedef struct yy_buffer_state* YY_BUFFER_STATE;
+extern YY_BUFFER_STATE yy_scan_buffer(char* base, size_t size);
+extern void yy_delete_buffer(YY_BUFFER_STATE buffer);
+
+static YY_BUFFER_STATE scan_buffer = NULL;
+
+// Map the file copy-on-write with two zero bytes after it. Zero-filled
+// anonymous pages are reserved first and the file is mapped over their
+// start, so the terminators exist even when the file ends on a page
+// boundary. Flex briefly writes a NUL after each match, so the mapping
+// is writable but private.
+int map_source_file(const char* filename, SourceMap* map) {
+    memset(map, 0, sizeof(*map));
+    
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > INT_MAX - 2) {
+        close(fd);
+        return -1;
+    }
+    
+    size_t size = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t map_size = (size + 2 + page - 1) / page * page;
+    
+    char* base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    
+    if (size > 0 &&
+        mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, map_size);
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    
+    if (size > 0) {
+        posix_madvise(base, size, POSIX_MADV_SEQUENTIAL);
+    }
+    
+    map->data = base;
+    map->size = size;
+    map->map_size = map_size;
+    return 0;
+}
+
+void unmap_source_file(SourceMap* map) {
+    if (map->data) {
+        munmap(map->data, map->map_size);
+    }
+    memset(map, 0, sizeof(*map));
+}
+
+int begin_source_scan(SourceMap* map) {
+    end_source_scan();
+    
+    // yy_scan_buffer takes the size including both terminators
+    scan_buffer = yy_scan_buffer(map->data, map->size + 2);
+    return scan_buffer ? 0 : -1;
+}
+
+void end_source_scan(void) {
+    if (scan_buffer) {
+        yy_delete_buffer(scan_buffer);
+        scan_buffer = NULL;
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef SOURCE_MAP_H
+#define SOURCE_MAP_H
+
+#include <stddef.h>
+
+// Source file mapped into memory and scanned in place by flex
+// (yy_scan_buffer) instead of being read through yyin and stdio
+typedef struct {
+    char* data;        // File contents followed by two NUL bytes
+    size_t size;       // File size in bytes (without the terminators)
+    size_t map_size;   // Length of the whole mapping
+} SourceMap;
+
+// Map a regular file; returns -1 if it cannot be mapped (missing, not a
+// regular file, or larger than flex's int-sized buffers allow)
+int map_source_file(const char* filename, SourceMap* map);
+void unmap_source_file(SourceMap* map);
+
+// Make the mapping the current flex buffer; yylex then scans it in place
+// and yytext points into map->data
+int begin_source_scan(SourceMap* map);
+void end_source_scan(void);
+
+#endif // SOURCE_MAP_H
@@ -0,0 +1,37 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <stdint.h>
+
+// Binary token stream (tokens.bin) written by Phase 1 and mapped by Phase 2
+//
+// File layout, native byte order:
+//   TokenStreamHeader
+//   TokenRecord[token_count]
+//   string table (symbol_count NUL-terminated names, in symbol ID order)
+//
+// Identifiers are interned by the lexer (intern.h), so each distinct name
+// is stored once and records refer to it by its dense symbol ID. All
+// fields are 32-bit aligned, so a mapped file can be read in place.
+
+#define TOKEN_STREAM_MAGIC "LTOK"
+#define TOKEN_STREAM_VERSION 2
+#define TOKEN_STREAM_NO_SYMBOL 0xFFFFFFFFu
+
+typedef struct {
+    char magic[4];              // TOKEN_STREAM_MAGIC, no terminator
+    uint32_t version;           // TOKEN_STREAM_VERSION
+    uint32_t token_count;       // Number of records (no EOF record)
+    uint32_t symbol_count;      // Names in the string table
+    uint32_t string_table_size; // Bytes following the records
+} TokenStreamHeader;
+
+typedef struct {
+    uint16_t kind;              // Token code from tokens.h
+    uint16_t length;            // Lexeme length in the source
+    uint32_t line;              // Source line of the first character
+    uint32_t column;            // Source column of the first character (1-based)
+    uint32_t symbol;            // Symbol ID of an identifier, or TOKEN_STREAM_NO_SYMBOL
+} TokenRecord;
+
+#endif // TOKEN_STREAM_H
@@ -2,9 +2,11 @@
 #define TOKENS_H
 
 // Token types enumeration - matches your original lexer.l
+// Codes start at 258 so they line up with the bison token numbers
+// declared in phase2/parser.y (256/257 are reserved by bison)
 typedef enum {
     // Logical operators
-    AND = 256,
+    AND = 258,
     OR,
     NOT,
     XOR,
@@ -54,6 +56,8 @@ extern YYSTYPE yylval;
 int yylex(void);
 void yyerror(const char* msg);
 extern int yylineno;
+extern int yycolumn;      // Column where the next match starts
+extern int token_column;  // Column where the last match started
 extern char* yytext;
 
 // Utility functions
@@ -1,147 +1,308 @@
 #include "ast.h"
 #include <string.h>
+#include <sys/mman.h>
 
-// Create identifier node
-ASTNode* create_identifier_node(const char* name, int line) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = AST_IDENTIFIER;
-    node->data.identifier = strdup(name);
-    node->line_number = line;
-    return node;
+// Every AST of the compilation unit, released together by free_asts
+static AST* ast_list = NULL;
+static size_t ast_node_count = 0;
+
+#define AST_INITIAL_CAPACITY 256
+
+// Create an empty AST and add it to the unit
+AST* create_ast(void) {
+    AST* ast = calloc(1, sizeof(AST));
+    if (!ast) {
+        fprintf(stderr, "Out of memory for AST\n");
+        exit(1);
+    }
+    ast->root = NO_NODE;
+    ast->next = ast_list;
+    ast_list = ast;
+    return ast;
 }
 
-// Create boolean literal node
-ASTNode* create_boolean_node(int value, int line) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = AST_BOOLEAN_LITERAL;
-    node->data.bool_value = value;
-    node->line_number = line;
-    return node;
+// Arrays of a mapped AST file point into the mapping rather than the heap
+static int in_mapping(const AST* ast, const void* array) {
+    const char* start = ast->mapping;
+    return start && (const char*)array >= start && (const char*)array < start + ast->mapping_size;
 }
 
-// Create binary operation node
-ASTNode* create_binary_node(ASTNodeType type, ASTNode* left, ASTNode* right, int line) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = type;
-    node->data.binary.left = left;
-    node->data.binary.right = right;
-    node->line_number = line;
-    return node;
+// Resize one node array with realloc; a mapped array is copied to the
+// heap on first growth
+static void* grow_array(const AST* ast, void* array, size_t used, size_t count, size_t element_size) {
+    void* grown;
+    if (in_mapping(ast, array)) {
+        grown = malloc(count * element_size);
+        if (grown) {
+            memcpy(grown, array, used * element_size);
+        }
+    } else {
+        grown = realloc(array, count * element_size);
+    }
+    if (!grown) {
+        fprintf(stderr, "Out of memory for AST\n");
+        exit(1);
+    }
+    return grown;
 }
 
-// Create unary operation node
-ASTNode* create_unary_node(ASTNodeType type, ASTNode* operand, int line) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = type;
-    node->data.unary.operand = operand;
-    node->line_number = line;
-    return node;
+static void free_array(const AST* ast, void* array) {
+    if (!in_mapping(ast, array)) {
+        free(array);
+    }
 }
 
-// Create assignment node
-ASTNode* create_assignment_node(const char* variable, ASTNode* value, int line) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = AST_ASSIGNMENT;
-    node->data.assignment.variable = strdup(variable);
-    node->data.assignment.value = value;
-    node->line_number = line;
-    return node;
+// Size the node arrays for at least nodes entries
+void ast_reserve(AST* ast, uint32_t nodes) {
+    if (nodes <= ast->capacity) return;
+
+    ast->kinds = grow_array(ast, ast->kinds, ast->count, nodes, sizeof(uint8_t));
+    ast->attributes = grow_array(ast, ast->attributes, ast->count, nodes, sizeof(uint8_t));
+    ast->left = grow_array(ast, ast->left, ast->count, nodes, sizeof(NodeIndex));
+    ast->right = grow_array(ast, ast->right, ast->count, nodes, sizeof(NodeIndex));
+    ast->operands = grow_array(ast, ast->operands, ast->count, nodes, sizeof(uint32_t));
+    ast->lines = grow_array(ast, ast->lines, ast->count, nodes, sizeof(int));
+    ast->capacity = nodes;
 }
 
-// Create quantifier node
-ASTNode* create_quantifier_node(ASTNodeType type, const char* variable, ASTNode* expression, int line) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = type;
-    node->data.quantifier.variable = strdup(variable);
-    node->data.quantifier.expression = expression;
-    node->line_number = line;
+// Append a node with its semantic attributes cleared
+static NodeIndex new_node(AST* ast, ASTNodeType type, NodeIndex left, NodeIndex right,
+                          uint32_t operand, int line) {
+    if (ast->count == ast->capacity) {
+        if (ast->capacity >= NO_NODE / 2) {
+            fprintf(stderr, "Too many AST nodes\n");
+            exit(1);
+        }
+        ast_reserve(ast, ast->capacity ? ast->capacity * 2 : AST_INITIAL_CAPACITY);
+    }
+
+    NodeIndex node = ast->count++;
+    ast->kinds[node] = (uint8_t)type;
+    ast->attributes[node] = 0;
+    ast->left[node] = left;
+    ast->right[node] = right;
+    ast->operands[node] = operand;
+    ast->lines[node] = line;
+    ast_node_count++;
     return node;
 }
 
-// Create program node
-ASTNode* create_program_node(int line) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = AST_PROGRAM;
-    node->data.program.statements = malloc(sizeof(ASTNode*) * 10);
-    node->data.program.count = 0;
-    node->data.program.capacity = 10;
-    node->line_number = line;
-    return node;
+// Hash of a node's structure (murmur3 finalizer over the mixed fields)
+static uint32_t node_hash(ASTNodeType type, NodeIndex left, NodeIndex right, uint32_t operand) {
+    uint32_t hash = (uint32_t)type * 0x9E3779B1u;
+    hash = (hash ^ left) * 0x85EBCA6Bu;
+    hash = (hash ^ right) * 0xC2B2AE35u;
+    hash ^= operand;
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    return hash;
 }
 
-// Create expression statement node
-ASTNode* create_expression_stmt_node(ASTNode* expression, int line) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = AST_EXPRESSION_STMT;
-    node->data.unary.operand = expression;
-    node->line_number = line;
-    return node;
+// Rebuild the hash-consing index at twice the size
+static void grow_cons_table(AST* ast) {
+    uint32_t size = ast->cons_mask ? (ast->cons_mask + 1) * 2 : 256;
+    NodeIndex* slots = malloc(size * sizeof(NodeIndex));
+    if (!slots) {
+        fprintf(stderr, "Out of memory for AST\n");
+        exit(1);
+    }
+    memset(slots, 0xFF, size * sizeof(NodeIndex));
+
+    uint32_t mask = size - 1;
+    for (uint32_t i = 0; ast->cons_mask && i <= ast->cons_mask; i++) {
+        NodeIndex node = ast->cons_slots[i];
+        if (node == NO_NODE || node >= ast->count) continue;
+        uint32_t slot = node_hash((ASTNodeType)ast->kinds[node], ast->left[node],
+                                  ast->right[node], ast->operands[node]) & mask;
+        while (slots[slot] != NO_NODE) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = node;
+    }
+
+    free(ast->cons_slots);
+    ast->cons_slots = slots;
+    ast->cons_mask = mask;
 }
 
-// Add statement to program
-void add_statement_to_program(ASTNode* program, ASTNode* statement) {
-    if (program->type != AST_PROGRAM && program->type != AST_STATEMENT_LIST) {
-        return;
+// Return the existing node with this structure, or append a new one.
+// Children are always older than their parent, so sharing keeps the
+// arrays in post-order; a shared node keeps the line of its first use.
+static NodeIndex cons_node(AST* ast, ASTNodeType type, NodeIndex left, NodeIndex right,
+                           uint32_t operand, int line) {
+    if ((ast->cons_count + 1) * 2 > ast->cons_mask + 1 || !ast->cons_slots) {
+        grow_cons_table(ast);
     }
-    
-    if (program->data.program.count >= program->data.program.capacity) {
-        program->data.program.capacity *= 2;
-        program->data.program.statements = realloc(program->data.program.statements,
-                                                 sizeof(ASTNode*) * program->data.program.capacity);
+
+    uint32_t slot = node_hash(type, left, right, operand) & ast->cons_mask;
+    NodeIndex node;
+    while ((node = ast->cons_slots[slot]) != NO_NODE) {
+        // Slots left behind by a discarded partial statement point past count
+        if (node < ast->count && ast->kinds[node] == type && ast->left[node] == left &&
+            ast->right[node] == right && ast->operands[node] == operand) {
+            ast->shared_count++;
+            return node;
+        }
+        slot = (slot + 1) & ast->cons_mask;
     }
-    
-    program->data.program.statements[program->data.program.count++] = statement;
+
+    node = new_node(ast, type, left, right, operand, line);
+    ast->cons_slots[slot] = node;
+    ast->cons_count++;
+    return node;
 }
 
-// Free AST memory
-void free_ast(ASTNode* node) {
-    if (!node) return;
-    
-    switch (node->type) {
-        case AST_IDENTIFIER:
-            free(node->data.identifier);
-            break;
-            
-        case AST_ASSIGNMENT:
-            free(node->data.assignment.variable);
-            free_ast(node->data.assignment.value);
-            break;
-            
+// Operators whose operands may be swapped
+static int is_commutative(ASTNodeType type) {
+    switch (type) {
         case AST_AND:
         case AST_OR:
         case AST_XOR:
         case AST_XNOR:
-        case AST_IMPLIES:
         case AST_IFF:
         case AST_EQUIV:
-            free_ast(node->data.binary.left);
-            free_ast(node->data.binary.right);
-            break;
-            
-        case AST_NOT:
-        case AST_EXPRESSION_STMT:
-            free_ast(node->data.unary.operand);
-            break;
-            
-        case AST_EXISTS:
-        case AST_FORALL:
-            free(node->data.quantifier.variable);
-            free_ast(node->data.quantifier.expression);
-            break;
-            
-        case AST_PROGRAM:
-        case AST_STATEMENT_LIST:
-            for (int i = 0; i < node->data.program.count; i++) {
-                free_ast(node->data.program.statements[i]);
-            }
-            free(node->data.program.statements);
-            break;
-            
+            return 1;
         default:
-            break;
+            return 0;
     }
-    
-    free(node);
+}
+
+// Create identifier node
+NodeIndex create_identifier_node(AST* ast, SymbolId name, int line) {
+    return cons_node(ast, AST_IDENTIFIER, NO_NODE, NO_NODE, name, line);
+}
+
+// Create boolean literal node
+NodeIndex create_boolean_node(AST* ast, int value, int line) {
+    return cons_node(ast, AST_BOOLEAN_LITERAL, NO_NODE, NO_NODE, value ? 1 : 0, line);
+}
+
+// Create binary operation node; commutative operands are put in index
+// order first so "P AND Q" and "Q AND P" share one node
+NodeIndex create_binary_node(AST* ast, ASTNodeType type, NodeIndex left, NodeIndex right, int line) {
+    if (is_commutative(type) && left > right) {
+        NodeIndex swap = left;
+        left = right;
+        right = swap;
+    }
+    return cons_node(ast, type, left, right, 0, line);
+}
+
+// Create unary operation node
+NodeIndex create_unary_node(AST* ast, ASTNodeType type, NodeIndex operand, int line) {
+    return cons_node(ast, type, operand, NO_NODE, 0, line);
+}
+
+// Create assignment node
+NodeIndex create_assignment_node(AST* ast, SymbolId variable, NodeIndex value, int line) {
+    return new_node(ast, AST_ASSIGNMENT, value, NO_NODE, variable, line);
+}
+
+// Create quantifier node
+NodeIndex create_quantifier_node(AST* ast, ASTNodeType type, SymbolId variable, NodeIndex expression, int line) {
+    return cons_node(ast, type, expression, NO_NODE, variable, line);
+}
+
+// Create expression statement node
+NodeIndex create_expression_stmt_node(AST* ast, NodeIndex expression, int line) {
+    return new_node(ast, AST_EXPRESSION_STMT, expression, NO_NODE, 0, line);
+}
+
+// Record the root of a finished statement
+void add_statement(AST* ast, NodeIndex statement) {
+    if (statement == NO_NODE) return;
+
+    if (ast->statement_count == ast->statement_capacity) {
+        uint32_t capacity = ast->statement_capacity ? ast->statement_capacity * 2 : 64;
+        ast->statements = grow_array(ast, ast->statements, ast->statement_count, capacity, sizeof(NodeIndex));
+        ast->statement_capacity = capacity;
+    }
+    ast->statements[ast->statement_count++] = statement;
+}
+
+// Create the PROGRAM node after the last statement; it becomes the root
+NodeIndex create_program_node(AST* ast, int line) {
+    ast->root = new_node(ast, AST_PROGRAM, NO_NODE, NO_NODE, ast->statement_count, line);
+    return ast->root;
+}
+
+// Statements are consecutive in post-order, so each one starts right
+// after the root of the previous one
+NodeIndex statement_first_node(const AST* ast, uint32_t statement) {
+    return statement == 0 ? 0 : ast->statements[statement - 1] + 1;
+}
+
+void set_node_attributes(AST* ast, NodeIndex node, int semantic_type, int is_constant, int bool_value) {
+    ast->attributes[node] = (uint8_t)((semantic_type & AST_ATTR_TYPE_MASK) |
+                                      (is_constant ? AST_ATTR_CONSTANT : 0) |
+                                      (bool_value ? AST_ATTR_VALUE : 0));
+}
+
+int node_semantic_type(const AST* ast, NodeIndex node) {
+    return ast->attributes[node] & AST_ATTR_TYPE_MASK;
+}
+
+int node_is_constant(const AST* ast, NodeIndex node) {
+    return (ast->attributes[node] & AST_ATTR_CONSTANT) != 0;
+}
+
+int node_constant_value(const AST* ast, NodeIndex node) {
+    return (ast->attributes[node] & AST_ATTR_VALUE) != 0;
+}
+
+int node_is_input_free(const AST* ast, NodeIndex node) {
+    return (ast->attributes[node] & AST_ATTR_INPUT_FREE) != 0;
+}
+
+// Release every AST of the current compilation unit in one call
+void free_asts(void) {
+    AST* next;
+    for (AST* ast = ast_list; ast; ast = next) {
+        next = ast->next;
+        free_array(ast, ast->kinds);
+        free_array(ast, ast->attributes);
+        free_array(ast, ast->left);
+        free_array(ast, ast->right);
+        free_array(ast, ast->operands);
+        free_array(ast, ast->lines);
+        free_array(ast, ast->statements);
+        free(ast->cons_slots);
+        if (ast->mapping) {
+            munmap(ast->mapping, ast->mapping_size);
+        }
+        free(ast);
+    }
+    ast_list = NULL;
+    ast_node_count = 0;
+}
+
+// Report nodes and the memory of their arrays for the current compilation
+// unit: bytes in use against bytes allocated, which doubling leaves ahead
+void print_ast_stats(FILE* out) {
+    size_t node_size = 2 * sizeof(uint8_t) + 2 * sizeof(NodeIndex) + sizeof(uint32_t) + sizeof(int);
+    size_t used = 0, reserved = 0, table = 0;
+    size_t shared = 0;
+    for (AST* ast = ast_list; ast; ast = ast->next) {
+        used += (size_t)ast->count * node_size + (size_t)ast->statement_count * sizeof(NodeIndex);
+        reserved += (size_t)ast->capacity * node_size +
+                    (size_t)ast->statement_capacity * sizeof(NodeIndex);
+        if (ast->cons_slots) {
+            table += ((size_t)ast->cons_mask + 1) * sizeof(NodeIndex);
+        }
+        shared += ast->shared_count;
+    }
+
+    fprintf(out, "AST MEMORY\n");
+    fprintf(out, " Nodes: %zu (%zu bytes each)\n", ast_node_count, node_size);
+    fprintf(out, " Shared subexpressions: %zu\n", shared);
+    fprintf(out, " Node arrays: %zu bytes used, %zu bytes allocated\n", used, reserved);
+    if (reserved > 0) {
+        fprintf(out, " Utilization: %.1f%%\n", 100.0 * used / reserved);
+    }
+    fprintf(out, " Hash-consing table: %zu bytes\n", table);
 }
 
 // Convert AST node type to string
@@ -170,32 +331,41 @@ const char* ast_node_type_to_string(ASTNodeType type) {
 }
 
 // Print AST with indentation
-void print_ast(ASTNode* node, int indent) {
-    if (!node) {
-        for (int i = 0; i < indent; i++) printf("  ");
-        printf("(null)\n");
+void print_ast(const AST* ast, NodeIndex node, int indent) {
+    fprint_ast(stdout, ast, node, indent);
+}
+
+static void print_indent(FILE* out, int indent) {
+    for (int i = 0; i < indent; i++) fprintf(out, "  ");
+}
+
+// Print AST with indentation to a stream
+void fprint_ast(FILE* out, const AST* ast, NodeIndex node, int indent) {
+    print_indent(out, indent);
+    if (!ast || node == NO_NODE) {
+        fprintf(out, "(null)\n");
         return;
     }
     
-    for (int i = 0; i < indent; i++) printf("  ");
+    ASTNodeType type = (ASTNodeType)ast->kinds[node];
+    int line = ast->lines[node];
     
-    switch (node->type) {
+    switch (type) {
         case AST_IDENTIFIER:
-            printf("IDENTIFIER: %s (line %d)\n", node->data.identifier, node->line_number);
+            fprintf(out, "IDENTIFIER: %s (line %d)\n", symbol_name(ast->operands[node]), line);
             break;
             
         case AST_BOOLEAN_LITERAL:
-            printf("BOOLEAN: %s (line %d)\n", 
-                   node->data.bool_value ? "TRUE" : "FALSE", node->line_number);
+            fprintf(out, "BOOLEAN: %s (line %d)\n", ast->operands[node] ? "TRUE" : "FALSE", line);
             break;
             
         case AST_ASSIGNMENT:
-            printf("ASSIGNMENT (line %d)\n", node->line_number);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Variable: %s\n", node->data.assignment.variable);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Value:\n");
-            print_ast(node->data.assignment.value, indent + 2);
+            fprintf(out, "ASSIGNMENT (line %d)\n", line);
+            print_indent(out, indent + 1);
+            fprintf(out, "Variable: %s\n", symbol_name(ast->operands[node]));
+            print_indent(out, indent + 1);
+            fprintf(out, "Value:\n");
+            fprint_ast(out, ast, ast->left[node], indent + 2);
             break;
             
         case AST_AND:
@@ -205,55 +375,54 @@ void print_ast(ASTNode* node, int indent) {
         case AST_IMPLIES:
         case AST_IFF:
         case AST_EQUIV:
-            printf("%s (line %d)\n", ast_node_type_to_string(node->type), node->line_number);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Left:\n");
-            print_ast(node->data.binary.left, indent + 2);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Right:\n");
-            print_ast(node->data.binary.right, indent + 2);
+            fprintf(out, "%s (line %d)\n", ast_node_type_to_string(type), line);
+            print_indent(out, indent + 1);
+            fprintf(out, "Left:\n");
+            fprint_ast(out, ast, ast->left[node], indent + 2);
+            print_indent(out, indent + 1);
+            fprintf(out, "Right:\n");
+            fprint_ast(out, ast, ast->right[node], indent + 2);
             break;
             
         case AST_NOT:
-            printf("NOT (line %d)\n", node->line_number);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Operand:\n");
-            print_ast(node->data.unary.operand, indent + 2);
+            fprintf(out, "NOT (line %d)\n", line);
+            print_indent(out, indent + 1);
+            fprintf(out, "Operand:\n");
+            fprint_ast(out, ast, ast->left[node], indent + 2);
             break;
             
         case AST_EXISTS:
         case AST_FORALL:
-            printf("%s (line %d)\n", ast_node_type_to_string(node->type), node->line_number);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Variable: %s\n", node->data.quantifier.variable);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Expression:\n");
-            print_ast(node->data.quantifier.expression, indent + 2);
+            fprintf(out, "%s (line %d)\n", ast_node_type_to_string(type), line);
+            print_indent(out, indent + 1);
+            fprintf(out, "Variable: %s\n", symbol_name(ast->operands[node]));
+            print_indent(out, indent + 1);
+            fprintf(out, "Expression:\n");
+            fprint_ast(out, ast, ast->left[node], indent + 2);
             break;
             
         case AST_PROGRAM:
-            printf("PROGRAM (line %d) - %d statements\n", node->line_number, node->data.program.count);
-            for (int i = 0; i < node->data.program.count; i++) {
-                for (int j = 0; j < indent + 1; j++) printf("  ");
-                printf("Statement %d:\n", i + 1);
-                print_ast(node->data.program.statements[i], indent + 2);
+            fprintf(out, "PROGRAM (line %d) - %u statements\n", line, ast->statement_count);
+            for (uint32_t i = 0; i < ast->statement_count; i++) {
+                print_indent(out, indent + 1);
+                fprintf(out, "Statement %u:\n", i + 1);
+                fprint_ast(out, ast, ast->statements[i], indent + 2);
             }
             break;
             
         case AST_EXPRESSION_STMT:
-            printf("EXPRESSION_STMT (line %d)\n", node->line_number);
-            print_ast(node->data.unary.operand, indent + 1);
+            fprintf(out, "EXPRESSION_STMT (line %d)\n", line);
+            fprint_ast(out, ast, ast->left[node], indent + 1);
             break;
             
         default:
-            printf("UNKNOWN NODE TYPE\n");
+            fprintf(out, "UNKNOWN NODE TYPE\n");
             break;
     }
 }
 
 // Print AST to file
-void print_ast_to_file(ASTNode* node, const char* filename) {
-    FILE* old_stdout = stdout;
+void print_ast_to_file(const AST* ast, const char* filename) {
     FILE* file = fopen(filename, "w");
     
     if (!file) {
@@ -261,19 +430,202 @@ void print_ast_to_file(ASTNode* node, const char* filename) {
         return;
     }
     
-    // Redirect stdout to file
-    stdout = file;
-    
-    printf("# Abstract Syntax Tree (AST)\n");
-    printf("# Generated by Phase 2: Syntax Analysis\n");
-    printf("# Input: tokens.txt\n");
-    printf("#\n\n");
+    fprintf(file, "# Abstract Syntax Tree (AST)\n");
+    fprintf(file, "# Generated by Phase 2: Syntax Analysis\n");
+    fprintf(file, "# Input: tokens.bin\n");
+    fprintf(file, "#\n\n");
     
-    print_ast(node, 0);
+    fprint_ast(file, ast, ast ? ast->root : NO_NODE, 0);
     
-    printf("\n# End of AST\n");
+    fprintf(file, "\n# End of AST\n");
     
-    // Restore stdout
     fclose(file);
-    stdout = old_stdout;
-}
\ No newline at end of file
+}
+
+// Next meaningful line of a printed AST (comments and blank lines skipped),
+// with surrounding whitespace removed
+static char* next_ast_line(FILE* file, char* buffer, int size) {
+    while (fgets(buffer, size, file)) {
+        char* start = buffer;
+        while (*start == ' ' || *start == '\t') start++;
+        
+        char* end = start + strlen(start);
+        while (end > start && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ')) end--;
+        *end = '\0';
+        
+        if (*start == '\0' || *start == '#') {
+            continue;
+        }
+        return start;
+    }
+    return NULL;
+}
+
+// Map the leading keyword of a printed node back to its type
+static int parse_ast_keyword(const char* line, ASTNodeType* type) {
+    static const struct {
+        const char* keyword;
+        ASTNodeType type;
+    } keywords[] = {
+        {"PROGRAM", AST_PROGRAM},
+        {"ASSIGNMENT", AST_ASSIGNMENT},
+        {"EXPRESSION_STMT", AST_EXPRESSION_STMT},
+        {"IDENTIFIER", AST_IDENTIFIER},
+        {"BOOLEAN", AST_BOOLEAN_LITERAL},
+        {"AND", AST_AND},
+        {"OR", AST_OR},
+        {"XOR", AST_XOR},
+        {"XNOR", AST_XNOR},
+        {"NOT", AST_NOT},
+        {"IMPLIES", AST_IMPLIES},
+        {"IFF", AST_IFF},
+        {"EQUIV", AST_EQUIV},
+        {"EXISTS", AST_EXISTS},
+        {"FORALL", AST_FORALL},
+    };
+    
+    size_t len = strcspn(line, " :");
+    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+        if (strlen(keywords[i].keyword) == len && strncmp(line, keywords[i].keyword, len) == 0) {
+            *type = keywords[i].type;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// read_node result for a nested PROGRAM whose statements were added directly
+#define NESTED_PROGRAM (NO_NODE - 1)
+
+static void read_statements(FILE* file, AST* ast, const char* header);
+
+// Read one node (and its subtree) in the format written by fprint_ast.
+// Children are read before their parent is created, so nodes are appended
+// in post-order.
+static NodeIndex read_node(FILE* file, AST* ast) {
+    char buffer[512];
+    char name[256];
+    int line_num = 1;
+    
+    char* line = next_ast_line(file, buffer, sizeof(buffer));
+    if (!line || strcmp(line, "(null)") == 0) {
+        return NO_NODE;
+    }
+    
+    ASTNodeType type;
+    if (!parse_ast_keyword(line, &type)) {
+        fprintf(stderr, "Error: Unrecognized AST line '%s'\n", line);
+        return NO_NODE;
+    }
+    
+    char* line_marker = strstr(line, "(line ");
+    if (line_marker) {
+        sscanf(line_marker, "(line %d)", &line_num);
+    }
+    
+    switch (type) {
+        case AST_IDENTIFIER:
+            if (sscanf(line, "IDENTIFIER: %255s", name) != 1) return NO_NODE;
+            return create_identifier_node(ast, intern_string(name), line_num);
+            
+        case AST_BOOLEAN_LITERAL:
+            return create_boolean_node(ast, strncmp(line, "BOOLEAN: TRUE", 13) == 0, line_num);
+            
+        case AST_ASSIGNMENT: {
+            line = next_ast_line(file, buffer, sizeof(buffer));
+            if (!line || sscanf(line, "Variable: %255s", name) != 1) return NO_NODE;
+            SymbolId variable = intern_string(name);
+            next_ast_line(file, buffer, sizeof(buffer));  // "Value:"
+            NodeIndex value = read_node(file, ast);
+            return create_assignment_node(ast, variable, value, line_num);
+        }
+            
+        case AST_AND:
+        case AST_OR:
+        case AST_XOR:
+        case AST_XNOR:
+        case AST_IMPLIES:
+        case AST_IFF:
+        case AST_EQUIV: {
+            next_ast_line(file, buffer, sizeof(buffer));  // "Left:"
+            NodeIndex left = read_node(file, ast);
+            next_ast_line(file, buffer, sizeof(buffer));  // "Right:"
+            NodeIndex right = read_node(file, ast);
+            return create_binary_node(ast, type, left, right, line_num);
+        }
+            
+        case AST_NOT: {
+            next_ast_line(file, buffer, sizeof(buffer));  // "Operand:"
+            NodeIndex operand = read_node(file, ast);
+            return create_unary_node(ast, AST_NOT, operand, line_num);
+        }
+            
+        case AST_EXISTS:
+        case AST_FORALL: {
+            line = next_ast_line(file, buffer, sizeof(buffer));
+            if (!line || sscanf(line, "Variable: %255s", name) != 1) return NO_NODE;
+            SymbolId variable = intern_string(name);
+            next_ast_line(file, buffer, sizeof(buffer));  // "Expression:"
+            NodeIndex expression = read_node(file, ast);
+            return create_quantifier_node(ast, type, variable, expression, line_num);
+        }
+            
+        case AST_EXPRESSION_STMT: {
+            NodeIndex expression = read_node(file, ast);
+            return create_expression_stmt_node(ast, expression, line_num);
+        }
+            
+        case AST_PROGRAM:
+            // Older dumps nest the statement list as a second PROGRAM
+            read_statements(file, ast, line);
+            return NESTED_PROGRAM;
+            
+        default:
+            return NO_NODE;
+    }
+}
+
+// Read the statements announced by a "PROGRAM ... - N statements" line
+static void read_statements(FILE* file, AST* ast, const char* header) {
+    char buffer[512];
+    int count = 0;
+    
+    const char* count_marker = strstr(header, " - ");
+    if (count_marker) {
+        sscanf(count_marker, " - %d statements", &count);
+    }
+    
+    for (int i = 0; i < count; i++) {
+        next_ast_line(file, buffer, sizeof(buffer));  // "Statement N:"
+        uint32_t mark = ast->count;
+        NodeIndex statement = read_node(file, ast);
+        if (statement == NESTED_PROGRAM) continue;
+        if (statement == NO_NODE) {
+            ast->count = mark;  // Drop a partial subtree so ranges stay contiguous
+            continue;
+        }
+        add_statement(ast, statement);
+    }
+}
+
+// Read a printed PROGRAM into a new AST
+AST* read_ast(FILE* file) {
+    char buffer[512];
+    int line_num = 1;
+    
+    char* line = next_ast_line(file, buffer, sizeof(buffer));
+    ASTNodeType type;
+    if (!line || !parse_ast_keyword(line, &type) || type != AST_PROGRAM) {
+        return NULL;
+    }
+    
+    char* line_marker = strstr(line, "(line ");
+    if (line_marker) {
+        sscanf(line_marker, "(line %d)", &line_num);
+    }
+    
+    AST* ast = create_ast();
+    read_statements(file, ast, line);
+    create_program_node(ast, line_num);
+    return ast;
+}
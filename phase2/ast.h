@@ -4,6 +4,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include "intern.h"
 
 // Forward declaration to avoid circular dependency
 #ifndef _GNU_SOURCE
@@ -43,70 +45,112 @@ typedef enum {
     AST_EXPRESSION_STMT
 } ASTNodeType;
 
-// AST Node structure
-typedef struct ASTNode {
-    ASTNodeType type;
-    
-    union {
-        // For identifiers
-        char* identifier;
-        
-        // For boolean literals
-        int bool_value;
-        
-        // For binary operations
-        struct {
-            struct ASTNode* left;
-            struct ASTNode* right;
-        } binary;
-        
-        // For unary operations
-        struct {
-            struct ASTNode* operand;
-        } unary;
-        
-        // For assignments
-        struct {
-            char* variable;
-            struct ASTNode* value;
-        } assignment;
-        
-        // For quantifiers
-        struct {
-            char* variable;
-            struct ASTNode* expression;
-        } quantifier;
-        
-        // For program/statement lists
-        struct {
-            struct ASTNode** statements;
-            int count;
-            int capacity;
-        } program;
-        
-    } data;
-    
-    // Source location info
-    int line_number;
-    
-} ASTNode;
+// Node index into an AST's arrays
+typedef uint32_t NodeIndex;
+
+#define NO_NODE UINT32_MAX
+
+// Semantic attributes (filled in by Phase 3), packed into one byte per node.
+// Expression nodes may be shared between statements, so their CONSTANT is
+// what literals alone decide. On an ASSIGNMENT or EXPRESSION_STMT node it
+// is the statement's value with earlier constant assignments propagated;
+// INPUT_FREE then says the value holds even when the inputs (variables
+// first assigned a literal) are supplied at run time.
+#define AST_ATTR_TYPE_MASK 0x0F     // SymbolType from phase3/symbol_table.h
+#define AST_ATTR_CONSTANT  0x10     // Value known at compile time
+#define AST_ATTR_VALUE     0x20     // That value
+#define AST_ATTR_INPUT_FREE 0x40    // Known without the inputs' literals
+
+// Flat AST of one compilation unit: parallel arrays indexed by NodeIndex,
+// laid out in post-order. Every child precedes its parent, statements
+// follow each other in source order, and the PROGRAM node comes last.
+//
+// Expression nodes are hash-consed: structurally identical subexpressions
+// (commutative operands in canonical order) are one node, so the tree is
+// a DAG. Statement i's new nodes occupy the contiguous range
+// [statement_first_node(ast, i), statements[i]]; its operands may also
+// refer to older nodes shared with earlier statements. A linear scan over
+// all nodes visits each unique subexpression once. The arrays grow with
+// realloc, or point into a mapped AST file, and every AST of the unit is
+// released by free_asts.
+//
+//   kind                left         right      operand
+//   IDENTIFIER          -            -          SymbolId
+//   BOOLEAN_LITERAL     -            -          0 or 1
+//   ASSIGNMENT          value        -          SymbolId of the variable
+//   AND ... EQUIV       left         right      -
+//   NOT                 operand      -          -
+//   EXISTS, FORALL      expression   -          SymbolId of the bound variable
+//   EXPRESSION_STMT     expression   -          -
+//   PROGRAM             -            -          statement count
+typedef struct AST {
+    uint8_t* kinds;             // ASTNodeType
+    uint8_t* attributes;        // AST_ATTR_* bits
+    NodeIndex* left;
+    NodeIndex* right;
+    uint32_t* operands;
+    int* lines;
+    uint32_t count;
+    uint32_t capacity;
+
+    NodeIndex* statements;      // Root of each statement, in source order
+    uint32_t statement_count;
+    uint32_t statement_capacity;
+
+    NodeIndex* cons_slots;      // Hash-consing index (open addressing, power of two)
+    uint32_t cons_mask;
+    uint32_t cons_count;
+    uint32_t shared_count;      // Constructor calls answered by an existing node
 
-// Function prototypes
-ASTNode* create_identifier_node(const char* name, int line);
-ASTNode* create_boolean_node(int value, int line);
-ASTNode* create_binary_node(ASTNodeType type, ASTNode* left, ASTNode* right, int line);
-ASTNode* create_unary_node(ASTNodeType type, ASTNode* operand, int line);
-ASTNode* create_assignment_node(const char* variable, ASTNode* value, int line);
-ASTNode* create_quantifier_node(ASTNodeType type, const char* variable, ASTNode* expression, int line);
-ASTNode* create_program_node(int line);
-ASTNode* create_expression_stmt_node(ASTNode* expression, int line);
+    NodeIndex root;             // PROGRAM node, NO_NODE until the unit is closed
 
-void add_statement_to_program(ASTNode* program, ASTNode* statement);
-void free_ast(ASTNode* node);
+    void* mapping;              // Mapped AST file some arrays point into (ast_file.h)
+    size_t mapping_size;
+    struct AST* next;           // Other ASTs of the unit, for free_asts
+} AST;
+
+// Create an empty AST of the unit; reserve sizes its arrays up front
+AST* create_ast(void);
+void ast_reserve(AST* ast, uint32_t nodes);
+
+// Node constructors return the node's index; expression constructors
+// return an existing node when an identical one was already built
+NodeIndex create_identifier_node(AST* ast, SymbolId name, int line);
+NodeIndex create_boolean_node(AST* ast, int value, int line);
+NodeIndex create_binary_node(AST* ast, ASTNodeType type, NodeIndex left, NodeIndex right, int line);
+NodeIndex create_unary_node(AST* ast, ASTNodeType type, NodeIndex operand, int line);
+NodeIndex create_assignment_node(AST* ast, SymbolId variable, NodeIndex value, int line);
+NodeIndex create_quantifier_node(AST* ast, ASTNodeType type, SymbolId variable, NodeIndex expression, int line);
+NodeIndex create_expression_stmt_node(AST* ast, NodeIndex expression, int line);
+
+// Record a finished statement, then close the unit with its PROGRAM node
+void add_statement(AST* ast, NodeIndex statement);
+NodeIndex create_program_node(AST* ast, int line);
+
+// First node created for statement i
+NodeIndex statement_first_node(const AST* ast, uint32_t statement);
+
+// Semantic attribute access
+void set_node_attributes(AST* ast, NodeIndex node, int semantic_type, int is_constant, int bool_value);
+int node_semantic_type(const AST* ast, NodeIndex node);
+int node_is_constant(const AST* ast, NodeIndex node);
+int node_constant_value(const AST* ast, NodeIndex node);
+int node_is_input_free(const AST* ast, NodeIndex node);
+
+// ASTs are never freed individually: free_asts releases every AST of the
+// compilation unit, its arrays and any mapped file at once.
+// print_ast_stats reports the nodes and their arrays' bytes.
+void free_asts(void);
+void print_ast_stats(FILE* out);
 
 // AST printing functions
-void print_ast(ASTNode* node, int indent);
-void print_ast_to_file(ASTNode* node, const char* filename);
+void print_ast(const AST* ast, NodeIndex node, int indent);
+void fprint_ast(FILE* out, const AST* ast, NodeIndex node, int indent);
+void print_ast_to_file(const AST* ast, const char* filename);
 const char* ast_node_type_to_string(ASTNodeType type);
 
+// AST reading (inverse of fprint_ast, used by the file-based phases); reads
+// a PROGRAM into a new AST, or NULL on malformed input
+AST* read_ast(FILE* file);
+
 #endif // AST_H
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ast_file.h"
+
+// Sections are padded so the 32-bit columns stay aligned in a mapping
+static size_t padded(size_t size) {
+    return (size + 3) & ~(size_t)3;
+}
+
+static int write_padded(const void* data, size_t size, FILE* out) {
+    static const char zeros[4] = {0};
+    if (size > 0 && fwrite(data, 1, size, out) != size) {
+        return -1;
+    }
+    size_t pad = padded(size) - size;
+    return pad > 0 && fwrite(zeros, 1, pad, out) != pad ? -1 : 0;
+}
+
+// Symbol operands are the only operand values that name a string
+static int has_symbol_operand(ASTNodeType type) {
+    return type == AST_IDENTIFIER || type == AST_ASSIGNMENT ||
+           type == AST_EXISTS || type == AST_FORALL;
+}
+
+// Write header, columns, statements and the interned names in symbol ID order
+int write_ast_file(const AST* ast, const char* filename, int annotated) {
+    FILE* out = fopen(filename, "wb");
+    if (!out) {
+        return -1;
+    }
+
+    uint32_t symbol_count = interned_symbol_count();
+    uint32_t string_table_size = 0;
+    for (SymbolId id = 0; id < symbol_count; id++) {
+        string_table_size += (uint32_t)symbol_name_length(id) + 1;
+    }
+
+    AstFileHeader header;
+    memcpy(header.magic, AST_FILE_MAGIC, sizeof(header.magic));
+    header.version = AST_FILE_VERSION;
+    header.flags = annotated ? AST_FILE_ANNOTATED : 0;
+    header.node_count = ast->count;
+    header.statement_count = ast->statement_count;
+    header.root = ast->root;
+    header.symbol_count = symbol_count;
+    header.string_table_size = string_table_size;
+
+    size_t n = ast->count;
+    int result = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                 write_padded(ast->kinds, n, out) == 0 &&
+                 (!annotated || write_padded(ast->attributes, n, out) == 0) &&
+                 write_padded(ast->left, n * sizeof(NodeIndex), out) == 0 &&
+                 write_padded(ast->right, n * sizeof(NodeIndex), out) == 0 &&
+                 write_padded(ast->operands, n * sizeof(uint32_t), out) == 0 &&
+                 write_padded(ast->lines, n * sizeof(int), out) == 0 &&
+                 write_padded(ast->statements, ast->statement_count * sizeof(NodeIndex), out) == 0
+                 ? 0 : -1;
+
+    for (SymbolId id = 0; result == 0 && id < symbol_count; id++) {
+        size_t length = symbol_name_length(id) + 1;
+        if (fwrite(symbol_name(id), 1, length, out) != length) {
+            result = -1;
+        }
+    }
+
+    if (fclose(out) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+int read_ast_file_header(const char* filename, AstFileHeader* header) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        return -1;
+    }
+
+    int result = fread(header, sizeof(*header), 1, file) == 1 &&
+                 memcmp(header->magic, AST_FILE_MAGIC, sizeof(header->magic)) == 0 ? 0 : -1;
+    fclose(file);
+    return result;
+}
+
+// Check for the binary AST magic
+int is_ast_file(const char* filename) {
+    AstFileHeader header;
+    return read_ast_file_header(filename, &header) == 0;
+}
+
+// Children must precede their parent and the kinds must be known, so the
+// phases can rely on the post-order layout without further checks
+static int validate_nodes(const AST* ast, uint32_t symbol_count) {
+    for (NodeIndex i = 0; i < ast->count; i++) {
+        ASTNodeType type = (ASTNodeType)ast->kinds[i];
+        if (type > AST_EXPRESSION_STMT) {
+            return -1;
+        }
+        if ((ast->left[i] != NO_NODE && ast->left[i] >= i) ||
+            (ast->right[i] != NO_NODE && ast->right[i] >= i)) {
+            return -1;
+        }
+        if (has_symbol_operand(type) && ast->operands[i] >= symbol_count) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < ast->statement_count; i++) {
+        if (ast->statements[i] >= ast->count ||
+            (i > 0 && ast->statements[i] <= ast->statements[i - 1])) {
+            return -1;
+        }
+    }
+    return ast->root == NO_NODE || ast->root < ast->count ? 0 : -1;
+}
+
+// Map an AST file, intern its string table and point a new AST at the columns
+AST* map_ast_file(const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open AST file '%s'\n", filename);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AstFileHeader)) {
+        fprintf(stderr, "Error: AST file '%s' is truncated\n", filename);
+        close(fd);
+        return NULL;
+    }
+
+    // Copy-on-write: Phase 3 writes attributes, a symbol remap writes operands
+    char* map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map AST file '%s'\n", filename);
+        return NULL;
+    }
+
+    const AstFileHeader* header = (const AstFileHeader*)map;
+    size_t n = header->node_count;
+    int annotated = (header->flags & AST_FILE_ANNOTATED) != 0;
+    size_t kinds_size = padded(n);
+    size_t attributes_size = annotated ? padded(n) : 0;
+    size_t column_size = n * sizeof(uint32_t);
+    size_t statements_size = (size_t)header->statement_count * sizeof(NodeIndex);
+    size_t expected = sizeof(AstFileHeader) + kinds_size + attributes_size +
+                      4 * column_size + statements_size + header->string_table_size;
+
+    if (memcmp(header->magic, AST_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != AST_FILE_VERSION ||
+        expected != (size_t)st.st_size ||
+        (header->string_table_size > 0 && map[st.st_size - 1] != '\0')) {
+        fprintf(stderr, "Error: '%s' is not a valid version %d AST file\n",
+                filename, AST_FILE_VERSION);
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    AST* ast = create_ast();
+    ast->mapping = map;
+    ast->mapping_size = st.st_size;
+
+    char* section = map + sizeof(AstFileHeader);
+    ast->kinds = (uint8_t*)section;
+    section += kinds_size;
+    if (annotated) {
+        ast->attributes = (uint8_t*)section;
+        section += attributes_size;
+    } else {
+        ast->attributes = calloc(n ? n : 1, sizeof(uint8_t));
+        if (!ast->attributes) {
+            fprintf(stderr, "Error: Out of memory reading '%s'\n", filename);
+            return NULL;
+        }
+    }
+    ast->left = (NodeIndex*)section;
+    section += column_size;
+    ast->right = (NodeIndex*)section;
+    section += column_size;
+    ast->operands = (uint32_t*)section;
+    section += column_size;
+    ast->lines = (int*)section;
+    section += column_size;
+    ast->statements = (NodeIndex*)section;
+    section += statements_size;
+    ast->count = ast->capacity = header->node_count;
+    ast->statement_count = ast->statement_capacity = header->statement_count;
+    ast->root = header->root;
+
+    // Intern the string table; IDs only need translating when this process
+    // had already interned other names in a different order
+    SymbolId* symbols = malloc((header->symbol_count ? header->symbol_count : 1) * sizeof(SymbolId));
+    if (!symbols) {
+        fprintf(stderr, "Error: Out of memory reading '%s'\n", filename);
+        return NULL;
+    }
+
+    int identity = 1;
+    const char* name = section;
+    const char* strings_end = name + header->string_table_size;
+    for (uint32_t i = 0; i < header->symbol_count; i++) {
+        const char* name_end = name < strings_end ? memchr(name, '\0', strings_end - name) : NULL;
+        if (!name_end) {
+            fprintf(stderr, "Error: String table of '%s' holds fewer than %u names\n",
+                    filename, header->symbol_count);
+            free(symbols);
+            return NULL;
+        }
+        symbols[i] = intern_name(name, name_end - name);
+        identity = identity && symbols[i] == i;
+        name = name_end + 1;
+    }
+
+    if (validate_nodes(ast, header->symbol_count) != 0) {
+        fprintf(stderr, "Error: '%s' holds a malformed node array\n", filename);
+        free(symbols);
+        return NULL;
+    }
+
+    if (!identity) {
+        for (NodeIndex i = 0; i < ast->count; i++) {
+            if (has_symbol_operand((ASTNodeType)ast->kinds[i])) {
+                ast->operands[i] = symbols[ast->operands[i]];
+            }
+        }
+    }
+
+    free(symbols);
+    return ast;
+}
@@ -0,0 +1,53 @@
+#ifndef AST_FILE_H
+#define AST_FILE_H
+
+#include <stdint.h>
+#include "ast.h"
+
+// Binary AST file (ast.bin from Phase 2, annotated_ast.bin from Phase 3)
+//
+// File layout, native byte order, every section 4-byte aligned:
+//   AstFileHeader
+//   uint8_t   kinds[node_count]         (padded to 4 bytes)
+//   uint8_t   attributes[node_count]    (padded; only with AST_FILE_ANNOTATED)
+//   NodeIndex left[node_count]
+//   NodeIndex right[node_count]
+//   uint32_t  operands[node_count]
+//   int32_t   lines[node_count]
+//   NodeIndex statements[statement_count]
+//   string table (symbol_count NUL-terminated names, in symbol ID order)
+//
+// The columns are the in-memory AST arrays (ast.h), so a reader maps the
+// file and points the AST at them. Symbol operands are IDs into the
+// string table; they equal the reader's own IDs when it interns the table
+// first, as a fresh Phase 3 or Phase 4 process does.
+
+#define AST_FILE_MAGIC "LAST"
+#define AST_FILE_VERSION 1
+
+#define AST_FILE_ANNOTATED 0x1      // Attribute column present (Phase 3 output)
+
+typedef struct {
+    char magic[4];              // AST_FILE_MAGIC, no terminator
+    uint32_t version;           // AST_FILE_VERSION
+    uint32_t flags;             // AST_FILE_* bits
+    uint32_t node_count;
+    uint32_t statement_count;
+    uint32_t root;              // PROGRAM node
+    uint32_t symbol_count;      // Names in the string table
+    uint32_t string_table_size; // Bytes at the end of the file
+} AstFileHeader;
+
+// Write ast (with its attribute column when annotated is set); 0 on success
+int write_ast_file(const AST* ast, const char* filename, int annotated);
+
+// Check the magic of a file, and read its header
+int is_ast_file(const char* filename);
+int read_ast_file_header(const char* filename, AstFileHeader* header);
+
+// Map an AST file and return an AST whose arrays point into the mapping
+// (copy-on-write, so later phases may annotate it); NULL if the file is
+// malformed. The mapping is released by free_asts.
+AST* map_ast_file(const char* filename);
+
+#endif // AST_FILE_H
@@ -3,24 +3,62 @@
 #include <string.h>
 #include <unistd.h>
 #include "ast.h"
+#include "ast_file.h"
 #include "parser.tab.h"  // This will contain token definitions
+#include "token_parser.h"
 
 // External declarations
-extern ASTNode* ast_root;
-extern int parse_tokens_from_file(const char* filename);
+extern AST* ast_root;
 
-void print_header() {
+void print_header(int write_text) {
     printf("ROADMAP COMPILER - PHASE 2\n");
     printf("SYNTAX ANALYSIS\n");
-    printf(" Input:  tokens.txt (from Phase 1)\n");
-    printf(" Output: ast.txt (Abstract Syntax Tree)\n");
+    printf(" Input:  tokens.bin (from Phase 1)\n");
+    printf(" Output: ast.bin (binary Abstract Syntax Tree)\n");
+    if (write_text) {
+        printf("         ast.txt (readable tree dump)\n");
+    }
+    printf("\n\n");
+}
+
+void print_token_stream_info(const char* filename) {
+    if (open_token_stream(filename) != 0) {
+        printf(" [ERROR: Cannot read token stream]\n");
+        printf("\n\n");
+        return;
+    }
+    
+    uint32_t token_count;
+    const TokenRecord* records = token_stream_records(&token_count);
+    
+    printf(" Tokens Preview:\n");
+    printf(" ────────────────────────────────────────\n");
+    
+    for (uint32_t i = 0; i < token_count && i < 10; i++) {
+        SymbolId symbol = token_stream_symbol(&records[i]);
+        printf(" %2u: %-12s %u:%-3u %s\n", i + 1, token_type_to_string(records[i].kind),
+               records[i].line, records[i].column, symbol != NO_SYMBOL ? symbol_name(symbol) : "");
+    }
+    
+    if (token_count > 10) {
+        printf(" ... and %u more tokens\n", token_count - 10);
+    }
+    
+    printf(" Total tokens: %u\n", token_count);
     printf("\n\n");
+    
+    close_token_stream();
 }
 
 void print_token_file_info(const char* filename) {
     printf(" INPUT FILE: %s\n", filename);
     printf("\n");
     
+    if (is_token_stream_file(filename)) {
+        print_token_stream_info(filename);
+        return;
+    }
+    
     FILE* file = fopen(filename, "r");
     if (!file) {
         printf(" [ERROR: Cannot read token file]\n");
@@ -74,8 +112,8 @@ void print_token_file_info(const char* filename) {
     printf("\n\n");
 }
 
-void print_ast_summary(ASTNode* root) {
-    if (!root) {
+void print_ast_summary(const AST* ast) {
+    if (!ast || ast->root == NO_NODE) {
         printf(" AST GENERATION\n");
         printf(" No AST generated\n");
         printf("\n\n");
@@ -85,18 +123,21 @@ void print_ast_summary(ASTNode* root) {
     printf(" AST STRUCTURE OVERVIEW\n");
     printf("\n");
     
-    switch (root->type) {
+    ASTNodeType root_type = (ASTNodeType)ast->kinds[ast->root];
+    switch (root_type) {
         case AST_PROGRAM:
             printf("Root: PROGRAM node\n");
-            printf("Statements: %d\n", root->data.program.count);
+            printf("Statements: %u\n", ast->statement_count);
+            printf("Nodes: %u\n", ast->count);
+            printf("Shared subexpressions: %u\n", ast->shared_count);
             
             // Analyze statement types
             int assignments = 0, expressions = 0;
-            for (int i = 0; i < root->data.program.count; i++) {
-                ASTNode* stmt = root->data.program.statements[i];
-                if (stmt->type == AST_ASSIGNMENT) {
+            for (uint32_t i = 0; i < ast->statement_count; i++) {
+                ASTNodeType type = (ASTNodeType)ast->kinds[ast->statements[i]];
+                if (type == AST_ASSIGNMENT) {
                     assignments++;
-                } else if (stmt->type == AST_EXPRESSION_STMT) {
+                } else if (type == AST_EXPRESSION_STMT) {
                     expressions++;
                 }
             }
@@ -106,7 +147,7 @@ void print_ast_summary(ASTNode* root) {
             break;
             
         default:
-            printf("Root: %s node\n", ast_node_type_to_string(root->type));
+            printf("Root: %s node\n", ast_node_type_to_string(root_type));
             break;
     }
     
@@ -114,6 +155,23 @@ void print_ast_summary(ASTNode* root) {
     printf("\n\n");
 }
 
+void print_binary_output_info(const char* filename) {
+    printf("OUTPUT FILE: %s\n", filename);
+
+    AstFileHeader header;
+    if (read_ast_file_header(filename, &header) != 0) {
+        printf(" File not created\n");
+        printf("\n\n");
+        return;
+    }
+    
+    printf("Format: Binary AST, version %u\n", header.version);
+    printf("Nodes: %u\n", header.node_count);
+    printf("Statements: %u\n", header.statement_count);
+    printf("Symbols: %u\n", header.symbol_count);
+    printf("\n\n");
+}
+
 void print_output_file_info(const char* filename) {
     printf("OUTPUT FILE: %s\n", filename);
 
@@ -139,10 +197,10 @@ void print_output_file_info(const char* filename) {
 }
 
 
-void display_sample_ast(ASTNode* root) {
+void display_sample_ast(const AST* ast) {
     printf(" AST SAMPLE\n");
     
-    if (!root) {
+    if (!ast || ast->root == NO_NODE) {
         printf(" (No AST to display)\n");
         printf("\n\n");
         return;
@@ -158,7 +216,7 @@ void display_sample_ast(ASTNode* root) {
     }
     
     stdout = temp_file;
-    print_ast(root, 0);
+    print_ast(ast, ast->root, 0);
     stdout = old_stdout;
     
     // Read back and display first 15 lines
@@ -172,7 +230,7 @@ void display_sample_ast(ASTNode* root) {
     }
     
     if (line_count >= 15) {
-        printf(" ... (truncated, see ast.txt for complete tree)\n");
+        printf(" ... (truncated, run with --text for the complete tree in ast.txt)\n");
     }
     
     fclose(temp_file);
@@ -180,20 +238,36 @@ void display_sample_ast(ASTNode* root) {
 }
 
 int main(int argc, char* argv[]) {
-    print_header();
+    // --text also writes the readable ast.txt dump
+    const char* input_file = NULL;
+    int write_text = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--text") == 0) {
+            write_text = 1;
+        } else if (argv[i][0] != '-' && !input_file) {
+            input_file = argv[i];
+        } else {
+            printf("Usage: %s [--text] [tokens.bin]\n\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    print_header(write_text);
     
     // Determine input file
-    const char* input_file = "tokens.txt";  // Default
-    if (argc > 1) {
-        input_file = argv[1];
+    int default_input = input_file == NULL;
+    if (default_input) {
+        input_file = "tokens.bin";
+    } else {
         printf("Using input file: %s\n\n", input_file);
     }
     
     // Check if input file exists
     if (access(input_file, F_OK) != 0) {
         printf("ERROR: %s not found!\n", input_file);
-        if (argc == 1) {
-            printf("   Please run Phase 1 first to generate tokens.txt\n");
+        if (default_input) {
+            printf("   Please run Phase 1 first to generate tokens.bin\n");
         } else {
             printf("   Please check the file path and try again\n");
         }
@@ -212,7 +286,7 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    if (!ast_root) {
+    if (!ast_root || ast_root->root == NO_NODE) {
         printf("PHASE 2 FAILED: No AST generated\n\n");
         return 1;
     }
@@ -220,24 +294,38 @@ int main(int argc, char* argv[]) {
     // Display AST summary
     print_ast_summary(ast_root);
     
-    // Generate AST output file
+    // Generate AST output files
     printf(" GENERATING AST\n");
-    printf(" Writing AST to ast.txt...\n");
+    printf(" Writing AST to ast.bin...\n");
     
-    print_ast_to_file(ast_root, "ast.txt");
+    if (write_ast_file(ast_root, "ast.bin", 0) != 0) {
+        printf("PHASE 2 FAILED: Cannot write ast.bin\n\n");
+        free_asts();
+        free_interned_symbols();
+        return 1;
+    }
+    printf("ast.bin created successfully\n");
     
-    printf("ast.txt created successfully\n");
+    if (write_text) {
+        printf(" Writing AST to ast.txt...\n");
+        print_ast_to_file(ast_root, "ast.txt");
+        printf("ast.txt created successfully\n");
+    }
     printf("\n");
     printf("\n\n");
     
     // Display output file info
-    print_output_file_info("ast.txt");
+    print_binary_output_info("ast.bin");
+    if (write_text) {
+        print_output_file_info("ast.txt");
+    }
     
     // Show sample of AST
     display_sample_ast(ast_root);
     
     // Cleanup
-    free_ast(ast_root);
+    free_asts();
+    free_interned_symbols();
     
     return 0;
 }
\ No newline at end of file
@@ -73,22 +73,27 @@
 #include <stdlib.h>
 #include <string.h>
 
-// Forward declarations
-typedef struct ASTNode ASTNode;
-
 #include "ast.h"
 
 // Global variables
 extern FILE* token_input;
 extern int current_line;
-ASTNode* ast_root = NULL;
+AST* ast_root = NULL;     // Built by the actions below, in reduction (post-) order
+
+// AST under construction; a driver may create and size it before yyparse
+static AST* tree(void) {
+    if (!ast_root) {
+        ast_root = create_ast();
+    }
+    return ast_root;
+}
 
 // Function prototypes
 int yylex(void);
 void yyerror(const char* msg);
 int parse_tokens_from_file(const char* filename);
 
-#line 92 "parser.tab.c"
+#line 97 "parser.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -119,24 +124,24 @@ enum yysymbol_kind_t
   YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
   YYSYMBOL_YYerror = 1,                    /* error  */
   YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
-  YYSYMBOL_T_TRUE = 3,                     /* T_TRUE  */
-  YYSYMBOL_T_FALSE = 4,                    /* T_FALSE  */
-  YYSYMBOL_IDENTIFIER = 5,                 /* IDENTIFIER  */
-  YYSYMBOL_AND = 6,                        /* AND  */
-  YYSYMBOL_OR = 7,                         /* OR  */
-  YYSYMBOL_NOT = 8,                        /* NOT  */
-  YYSYMBOL_XOR = 9,                        /* XOR  */
-  YYSYMBOL_XNOR = 10,                      /* XNOR  */
-  YYSYMBOL_IMPLIES = 11,                   /* IMPLIES  */
-  YYSYMBOL_IFF = 12,                       /* IFF  */
-  YYSYMBOL_EQUIV = 13,                     /* EQUIV  */
-  YYSYMBOL_EXISTS = 14,                    /* EXISTS  */
-  YYSYMBOL_FORALL = 15,                    /* FORALL  */
-  YYSYMBOL_IF = 16,                        /* IF  */
-  YYSYMBOL_IFF_KEYWORD = 17,               /* IFF_KEYWORD  */
-  YYSYMBOL_ASSIGN = 18,                    /* ASSIGN  */
-  YYSYMBOL_LPAREN = 19,                    /* LPAREN  */
-  YYSYMBOL_RPAREN = 20,                    /* RPAREN  */
+  YYSYMBOL_AND = 3,                        /* AND  */
+  YYSYMBOL_OR = 4,                         /* OR  */
+  YYSYMBOL_NOT = 5,                        /* NOT  */
+  YYSYMBOL_XOR = 6,                        /* XOR  */
+  YYSYMBOL_XNOR = 7,                       /* XNOR  */
+  YYSYMBOL_IMPLIES = 8,                    /* IMPLIES  */
+  YYSYMBOL_IFF = 9,                        /* IFF  */
+  YYSYMBOL_ASSIGN = 10,                    /* ASSIGN  */
+  YYSYMBOL_EQUIV = 11,                     /* EQUIV  */
+  YYSYMBOL_EXISTS = 12,                    /* EXISTS  */
+  YYSYMBOL_FORALL = 13,                    /* FORALL  */
+  YYSYMBOL_IF = 14,                        /* IF  */
+  YYSYMBOL_IFF_KEYWORD = 15,               /* IFF_KEYWORD  */
+  YYSYMBOL_LPAREN = 16,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 17,                    /* RPAREN  */
+  YYSYMBOL_T_TRUE = 18,                    /* T_TRUE  */
+  YYSYMBOL_T_FALSE = 19,                   /* T_FALSE  */
+  YYSYMBOL_IDENTIFIER = 20,                /* IDENTIFIER  */
   YYSYMBOL_INVALID_TOKEN = 21,             /* INVALID_TOKEN  */
   YYSYMBOL_EOF_TOKEN = 22,                 /* EOF_TOKEN  */
   YYSYMBOL_YYACCEPT = 23,                  /* $accept  */
@@ -144,11 +149,12 @@ enum yysymbol_kind_t
   YYSYMBOL_statement_list = 25,            /* statement_list  */
   YYSYMBOL_statement = 26,                 /* statement  */
   YYSYMBOL_assignment = 27,                /* assignment  */
-  YYSYMBOL_expression = 28,                /* expression  */
-  YYSYMBOL_logical_expr = 29,              /* logical_expr  */
-  YYSYMBOL_term = 30,                      /* term  */
-  YYSYMBOL_factor = 31,                    /* factor  */
-  YYSYMBOL_quantified_expr = 32            /* quantified_expr  */
+  YYSYMBOL_28_1 = 28,                      /* @1  */
+  YYSYMBOL_expression = 29,                /* expression  */
+  YYSYMBOL_logical_expr = 30,              /* logical_expr  */
+  YYSYMBOL_term = 31,                      /* term  */
+  YYSYMBOL_factor = 32,                    /* factor  */
+  YYSYMBOL_quantified_expr = 33            /* quantified_expr  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -476,19 +482,19 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  23
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   67
+#define YYLAST   76
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  23
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  10
+#define YYNNTS  11
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  26
+#define YYNRULES  27
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  43
+#define YYNSTATES  44
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK   277
+#define YYMAXUTOK   278
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
@@ -529,16 +535,16 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
-      15,    16,    17,    18,    19,    20,    21,    22
+      15,    16,    17,    18,    19,    20,    21,    22,     2
 };
 
 #if YYDEBUG
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_uint8 yyrline[] =
 {
-       0,    60,    60,    74,    81,    87,    96,    99,   105,   112,
-     118,   121,   124,   127,   130,   133,   136,   139,   145,   148,
-     154,   158,   161,   164,   167,   173,   177
+       0,    75,    75,    78,    85,    88,    94,    97,   105,   105,
+     111,   117,   120,   123,   126,   129,   132,   135,   138,   144,
+     147,   153,   156,   159,   162,   165,   171,   174
 };
 #endif
 
@@ -554,11 +560,11 @@ static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "\"end of file\"", "error", "\"invalid token\"", "T_TRUE", "T_FALSE",
-  "IDENTIFIER", "AND", "OR", "NOT", "XOR", "XNOR", "IMPLIES", "IFF",
-  "EQUIV", "EXISTS", "FORALL", "IF", "IFF_KEYWORD", "ASSIGN", "LPAREN",
-  "RPAREN", "INVALID_TOKEN", "EOF_TOKEN", "$accept", "program",
-  "statement_list", "statement", "assignment", "expression",
+  "\"end of file\"", "error", "\"invalid token\"", "AND", "OR", "NOT",
+  "XOR", "XNOR", "IMPLIES", "IFF", "ASSIGN", "EQUIV", "EXISTS", "FORALL",
+  "IF", "IFF_KEYWORD", "LPAREN", "RPAREN", "T_TRUE", "T_FALSE",
+  "IDENTIFIER", "INVALID_TOKEN", "EOF_TOKEN", "$accept", "program",
+  "statement_list", "statement", "assignment", "@1", "expression",
   "logical_expr", "term", "factor", "quantified_expr", YY_NULLPTR
 };
 
@@ -569,7 +575,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-16)
+#define YYPACT_NINF (-22)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -583,11 +589,11 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
-      22,   -16,   -16,   -15,    43,     4,     5,    30,    11,    22,
-     -16,   -16,   -16,    54,   -16,   -16,   -16,    30,   -16,   -16,
-      30,    30,    -5,   -16,   -16,    30,    30,    30,    30,    30,
-      30,    30,   -16,    54,    54,   -16,   -16,     6,     6,     6,
-      33,    44,    44
+      23,    51,   -19,   -18,    32,   -22,   -22,    -5,    10,    23,
+     -22,   -22,   -22,    50,   -22,   -22,   -22,   -22,   -22,    32,
+      32,     0,   -22,   -22,   -22,    32,    32,    32,    32,    32,
+      32,    32,    50,    50,   -22,    32,   -22,     9,     9,     9,
+      69,    26,    26,   -22
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -595,23 +601,25 @@ static const yytype_int8 yypact[] =
    means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-       3,    21,    22,    20,     0,     0,     0,     0,     0,     2,
-       4,     6,     7,     9,    17,    19,    24,     0,    20,    18,
-       0,     0,     0,     1,     5,     0,     0,     0,     0,     0,
-       0,     0,     8,    25,    26,    23,    16,    13,    14,    15,
-      12,    10,    11
+       3,     0,     0,     0,     0,    22,    23,    21,     0,     2,
+       4,     6,     7,    10,    18,    20,    25,    21,    19,     0,
+       0,     0,     8,     1,     5,     0,     0,     0,     0,     0,
+       0,     0,    26,    27,    24,     0,    17,    14,    15,    16,
+      13,    11,    12,     9
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -16,   -16,   -16,     7,   -16,     0,    -7,   -16,    24,   -16
+     -22,   -22,   -22,     4,   -22,   -22,   -21,    -4,   -22,    17,
+     -22
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-       0,     8,     9,    10,    11,    12,    13,    14,    15,    16
+       0,     8,     9,    10,    11,    35,    12,    13,    14,    15,
+      16
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -619,51 +627,53 @@ static const yytype_int8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int8 yytable[] =
 {
-      22,    25,    26,    17,    27,    28,    29,    30,    31,    20,
-      21,    23,    25,    33,    34,    35,    24,    32,    36,    37,
-      38,    39,    40,    41,    42,     1,     2,     3,    19,     0,
-       4,     0,     0,     1,     2,    18,     5,     6,     4,    25,
-      26,     7,    27,    28,     5,     6,     1,     2,    18,     7,
-      25,    26,     0,    27,    28,    29,     0,     5,     6,     0,
-      25,    26,     7,    27,    28,    29,    30,    31
+      21,    19,    20,    25,    26,    22,    27,    28,    29,    30,
+      23,    31,    25,    24,    43,    32,    33,    34,    18,     0,
+       0,    36,    37,    38,    39,    40,    41,    42,     1,    25,
+      26,     0,    27,    28,    29,     2,     3,     1,     0,     4,
+       0,     5,     6,     7,     2,     3,     0,     0,     4,     0,
+       5,     6,    17,    25,    26,     0,    27,    28,    29,    30,
+       0,    31,     0,     2,     3,     0,     0,     4,     0,     5,
+       6,    17,    25,    26,     0,    27,    28
 };
 
 static const yytype_int8 yycheck[] =
 {
-       7,     6,     7,    18,     9,    10,    11,    12,    13,     5,
-       5,     0,     6,    20,    21,    20,     9,    17,    25,    26,
-      27,    28,    29,    30,    31,     3,     4,     5,     4,    -1,
-       8,    -1,    -1,     3,     4,     5,    14,    15,     8,     6,
-       7,    19,     9,    10,    14,    15,     3,     4,     5,    19,
-       6,     7,    -1,     9,    10,    11,    -1,    14,    15,    -1,
-       6,     7,    19,     9,    10,    11,    12,    13
+       4,    20,    20,     3,     4,    10,     6,     7,     8,     9,
+       0,    11,     3,     9,    35,    19,    20,    17,     1,    -1,
+      -1,    25,    26,    27,    28,    29,    30,    31,     5,     3,
+       4,    -1,     6,     7,     8,    12,    13,     5,    -1,    16,
+      -1,    18,    19,    20,    12,    13,    -1,    -1,    16,    -1,
+      18,    19,    20,     3,     4,    -1,     6,     7,     8,     9,
+      -1,    11,    -1,    12,    13,    -1,    -1,    16,    -1,    18,
+      19,    20,     3,     4,    -1,     6,     7
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
    state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
-       0,     3,     4,     5,     8,    14,    15,    19,    24,    25,
-      26,    27,    28,    29,    30,    31,    32,    18,     5,    31,
-       5,     5,    29,     0,    26,     6,     7,     9,    10,    11,
-      12,    13,    28,    29,    29,    20,    29,    29,    29,    29,
-      29,    29,    29
+       0,     5,    12,    13,    16,    18,    19,    20,    24,    25,
+      26,    27,    29,    30,    31,    32,    33,    20,    32,    20,
+      20,    30,    10,     0,    26,     3,     4,     6,     7,     8,
+       9,    11,    30,    30,    17,    28,    30,    30,    30,    30,
+      30,    30,    30,    29
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    23,    24,    24,    25,    25,    26,    26,    27,    28,
-      29,    29,    29,    29,    29,    29,    29,    29,    30,    30,
-      31,    31,    31,    31,    31,    32,    32
+       0,    23,    24,    24,    25,    25,    26,    26,    28,    27,
+      29,    30,    30,    30,    30,    30,    30,    30,    30,    31,
+      31,    32,    32,    32,    32,    32,    33,    33
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
-       0,     2,     1,     0,     1,     2,     1,     1,     3,     1,
-       3,     3,     3,     3,     3,     3,     3,     1,     2,     1,
-       1,     1,     1,     3,     1,     3,     3
+       0,     2,     1,     0,     1,     2,     1,     1,     0,     4,
+       1,     3,     3,     3,     3,     3,     3,     3,     1,     2,
+       1,     1,     1,     1,     3,     1,     3,     3
 };
 
 
@@ -1127,229 +1137,213 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* program: statement_list  */
-#line 60 "parser.y"
+#line 75 "parser.y"
                    {
-        ast_root = create_program_node(current_line);
-        if ((yyvsp[0].node)) {
-            // If we have a statement list, copy its statements to the program
-            if ((yyvsp[0].node)->type == AST_STATEMENT_LIST) {
-                for (int i = 0; i < (yyvsp[0].node)->data.program.count; i++) {
-                    add_statement_to_program(ast_root, (yyvsp[0].node)->data.program.statements[i]);
-                }
-            } else {
-                add_statement_to_program(ast_root, (yyvsp[0].node));
-            }
-        }
-        (yyval.node) = ast_root;
+        create_program_node(tree(), current_line);
     }
-#line 1146 "parser.tab.c"
+#line 1145 "parser.tab.c"
     break;
 
   case 3: /* program: %empty  */
-#line 74 "parser.y"
+#line 78 "parser.y"
                   {
-        ast_root = create_program_node(current_line);
-        (yyval.node) = ast_root;
+        create_program_node(tree(), current_line);
     }
-#line 1155 "parser.tab.c"
+#line 1153 "parser.tab.c"
     break;
 
   case 4: /* statement_list: statement  */
-#line 81 "parser.y"
+#line 85 "parser.y"
               {
-        (yyval.node) = create_program_node(current_line);
-        if ((yyvsp[0].node)) {
-            add_statement_to_program((yyval.node), (yyvsp[0].node));
-        }
+        add_statement(tree(), (yyvsp[0].node));
     }
-#line 1166 "parser.tab.c"
+#line 1161 "parser.tab.c"
     break;
 
   case 5: /* statement_list: statement_list statement  */
-#line 87 "parser.y"
+#line 88 "parser.y"
                                {
-        (yyval.node) = (yyvsp[-1].node);
-        if ((yyvsp[0].node)) {
-            add_statement_to_program((yyval.node), (yyvsp[0].node));
-        }
+        add_statement(tree(), (yyvsp[0].node));
     }
-#line 1177 "parser.tab.c"
+#line 1169 "parser.tab.c"
     break;
 
   case 6: /* statement: assignment  */
-#line 96 "parser.y"
+#line 94 "parser.y"
                {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1185 "parser.tab.c"
+#line 1177 "parser.tab.c"
     break;
 
   case 7: /* statement: expression  */
-#line 99 "parser.y"
+#line 97 "parser.y"
                  {
-        (yyval.node) = create_expression_stmt_node((yyvsp[0].node), current_line);
+        (yyval.node) = create_expression_stmt_node(tree(), (yyvsp[0].node), current_line);
     }
-#line 1193 "parser.tab.c"
+#line 1185 "parser.tab.c"
     break;
 
-  case 8: /* assignment: IDENTIFIER ASSIGN expression  */
+  case 8: /* @1: %empty  */
 #line 105 "parser.y"
-                                 {
-        (yyval.node) = create_assignment_node((yyvsp[-2].str), (yyvsp[0].node), current_line);
-        free((yyvsp[-2].str)); // Free the string since we copied it
+                      { (yyval.line) = current_line; }
+#line 1191 "parser.tab.c"
+    break;
+
+  case 9: /* assignment: IDENTIFIER ASSIGN @1 expression  */
+#line 105 "parser.y"
+                                                              {
+        (yyval.node) = create_assignment_node(tree(), (yyvsp[-3].symbol), (yyvsp[0].node), (yyvsp[-1].line));
     }
-#line 1202 "parser.tab.c"
+#line 1199 "parser.tab.c"
     break;
 
-  case 9: /* expression: logical_expr  */
-#line 112 "parser.y"
+  case 10: /* expression: logical_expr  */
+#line 111 "parser.y"
                  {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1210 "parser.tab.c"
+#line 1207 "parser.tab.c"
     break;
 
-  case 10: /* logical_expr: logical_expr IFF logical_expr  */
-#line 118 "parser.y"
+  case 11: /* logical_expr: logical_expr IFF logical_expr  */
+#line 117 "parser.y"
                                   {
-        (yyval.node) = create_binary_node(AST_IFF, (yyvsp[-2].node), (yyvsp[0].node), current_line);
+        (yyval.node) = create_binary_node(tree(), AST_IFF, (yyvsp[-2].node), (yyvsp[0].node), current_line);
     }
-#line 1218 "parser.tab.c"
+#line 1215 "parser.tab.c"
     break;
 
-  case 11: /* logical_expr: logical_expr EQUIV logical_expr  */
-#line 121 "parser.y"
+  case 12: /* logical_expr: logical_expr EQUIV logical_expr  */
+#line 120 "parser.y"
                                       {
-        (yyval.node) = create_binary_node(AST_EQUIV, (yyvsp[-2].node), (yyvsp[0].node), current_line);
+        (yyval.node) = create_binary_node(tree(), AST_EQUIV, (yyvsp[-2].node), (yyvsp[0].node), current_line);
     }
-#line 1226 "parser.tab.c"
+#line 1223 "parser.tab.c"
     break;
 
-  case 12: /* logical_expr: logical_expr IMPLIES logical_expr  */
-#line 124 "parser.y"
+  case 13: /* logical_expr: logical_expr IMPLIES logical_expr  */
+#line 123 "parser.y"
                                         {
-        (yyval.node) = create_binary_node(AST_IMPLIES, (yyvsp[-2].node), (yyvsp[0].node), current_line);
+        (yyval.node) = create_binary_node(tree(), AST_IMPLIES, (yyvsp[-2].node), (yyvsp[0].node), current_line);
     }
-#line 1234 "parser.tab.c"
+#line 1231 "parser.tab.c"
     break;
 
-  case 13: /* logical_expr: logical_expr OR logical_expr  */
-#line 127 "parser.y"
+  case 14: /* logical_expr: logical_expr OR logical_expr  */
+#line 126 "parser.y"
                                    {
-        (yyval.node) = create_binary_node(AST_OR, (yyvsp[-2].node), (yyvsp[0].node), current_line);
+        (yyval.node) = create_binary_node(tree(), AST_OR, (yyvsp[-2].node), (yyvsp[0].node), current_line);
     }
-#line 1242 "parser.tab.c"
+#line 1239 "parser.tab.c"
     break;
 
-  case 14: /* logical_expr: logical_expr XOR logical_expr  */
-#line 130 "parser.y"
+  case 15: /* logical_expr: logical_expr XOR logical_expr  */
+#line 129 "parser.y"
                                     {
-        (yyval.node) = create_binary_node(AST_XOR, (yyvsp[-2].node), (yyvsp[0].node), current_line);
+        (yyval.node) = create_binary_node(tree(), AST_XOR, (yyvsp[-2].node), (yyvsp[0].node), current_line);
     }
-#line 1250 "parser.tab.c"
+#line 1247 "parser.tab.c"
     break;
 
-  case 15: /* logical_expr: logical_expr XNOR logical_expr  */
-#line 133 "parser.y"
+  case 16: /* logical_expr: logical_expr XNOR logical_expr  */
+#line 132 "parser.y"
                                      {
-        (yyval.node) = create_binary_node(AST_XNOR, (yyvsp[-2].node), (yyvsp[0].node), current_line);
+        (yyval.node) = create_binary_node(tree(), AST_XNOR, (yyvsp[-2].node), (yyvsp[0].node), current_line);
     }
-#line 1258 "parser.tab.c"
+#line 1255 "parser.tab.c"
     break;
 
-  case 16: /* logical_expr: logical_expr AND logical_expr  */
-#line 136 "parser.y"
+  case 17: /* logical_expr: logical_expr AND logical_expr  */
+#line 135 "parser.y"
                                     {
-        (yyval.node) = create_binary_node(AST_AND, (yyvsp[-2].node), (yyvsp[0].node), current_line);
+        (yyval.node) = create_binary_node(tree(), AST_AND, (yyvsp[-2].node), (yyvsp[0].node), current_line);
     }
-#line 1266 "parser.tab.c"
+#line 1263 "parser.tab.c"
     break;
 
-  case 17: /* logical_expr: term  */
-#line 139 "parser.y"
+  case 18: /* logical_expr: term  */
+#line 138 "parser.y"
            {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1274 "parser.tab.c"
+#line 1271 "parser.tab.c"
     break;
 
-  case 18: /* term: NOT factor  */
-#line 145 "parser.y"
+  case 19: /* term: NOT factor  */
+#line 144 "parser.y"
                {
-        (yyval.node) = create_unary_node(AST_NOT, (yyvsp[0].node), current_line);
+        (yyval.node) = create_unary_node(tree(), AST_NOT, (yyvsp[0].node), current_line);
     }
-#line 1282 "parser.tab.c"
+#line 1279 "parser.tab.c"
     break;
 
-  case 19: /* term: factor  */
-#line 148 "parser.y"
+  case 20: /* term: factor  */
+#line 147 "parser.y"
              {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1290 "parser.tab.c"
+#line 1287 "parser.tab.c"
     break;
 
-  case 20: /* factor: IDENTIFIER  */
-#line 154 "parser.y"
+  case 21: /* factor: IDENTIFIER  */
+#line 153 "parser.y"
                {
-        (yyval.node) = create_identifier_node((yyvsp[0].str), current_line);
-        free((yyvsp[0].str)); // Free the string since we copied it
+        (yyval.node) = create_identifier_node(tree(), (yyvsp[0].symbol), current_line);
     }
-#line 1299 "parser.tab.c"
+#line 1295 "parser.tab.c"
     break;
 
-  case 21: /* factor: T_TRUE  */
-#line 158 "parser.y"
+  case 22: /* factor: T_TRUE  */
+#line 156 "parser.y"
              {
-        (yyval.node) = create_boolean_node(1, current_line);
+        (yyval.node) = create_boolean_node(tree(), 1, current_line);
     }
-#line 1307 "parser.tab.c"
+#line 1303 "parser.tab.c"
     break;
 
-  case 22: /* factor: T_FALSE  */
-#line 161 "parser.y"
+  case 23: /* factor: T_FALSE  */
+#line 159 "parser.y"
               {
-        (yyval.node) = create_boolean_node(0, current_line);
+        (yyval.node) = create_boolean_node(tree(), 0, current_line);
     }
-#line 1315 "parser.tab.c"
+#line 1311 "parser.tab.c"
     break;
 
-  case 23: /* factor: LPAREN logical_expr RPAREN  */
-#line 164 "parser.y"
+  case 24: /* factor: LPAREN logical_expr RPAREN  */
+#line 162 "parser.y"
                                  {
         (yyval.node) = (yyvsp[-1].node);
     }
-#line 1323 "parser.tab.c"
+#line 1319 "parser.tab.c"
     break;
 
-  case 24: /* factor: quantified_expr  */
-#line 167 "parser.y"
+  case 25: /* factor: quantified_expr  */
+#line 165 "parser.y"
                       {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1331 "parser.tab.c"
+#line 1327 "parser.tab.c"
     break;
 
-  case 25: /* quantified_expr: EXISTS IDENTIFIER logical_expr  */
-#line 173 "parser.y"
+  case 26: /* quantified_expr: EXISTS IDENTIFIER logical_expr  */
+#line 171 "parser.y"
                                    {
-        (yyval.node) = create_quantifier_node(AST_EXISTS, (yyvsp[-1].str), (yyvsp[0].node), current_line);
-        free((yyvsp[-1].str));
+        (yyval.node) = create_quantifier_node(tree(), AST_EXISTS, (yyvsp[-1].symbol), (yyvsp[0].node), current_line);
     }
-#line 1340 "parser.tab.c"
+#line 1335 "parser.tab.c"
     break;
 
-  case 26: /* quantified_expr: FORALL IDENTIFIER logical_expr  */
-#line 177 "parser.y"
+  case 27: /* quantified_expr: FORALL IDENTIFIER logical_expr  */
+#line 174 "parser.y"
                                      {
-        (yyval.node) = create_quantifier_node(AST_FORALL, (yyvsp[-1].str), (yyvsp[0].node), current_line);
-        free((yyvsp[-1].str));
+        (yyval.node) = create_quantifier_node(tree(), AST_FORALL, (yyvsp[-1].symbol), (yyvsp[0].node), current_line);
     }
-#line 1349 "parser.tab.c"
+#line 1343 "parser.tab.c"
     break;
 
 
-#line 1353 "parser.tab.c"
+#line 1347 "parser.tab.c"
 
       default: break;
     }
@@ -1542,7 +1536,7 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 183 "parser.y"
+#line 179 "parser.y"
 
 
 void yyerror(const char* msg) {
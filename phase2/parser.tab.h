@@ -44,6 +44,13 @@
 #if YYDEBUG
 extern int yydebug;
 #endif
+/* "%code requires" blocks.  */
+#line 28 "parser.y"
+
+#include "intern.h"
+#include "ast.h"
+
+#line 54 "parser.tab.h"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
@@ -53,25 +60,25 @@ extern int yydebug;
     YYEMPTY = -2,
     YYEOF = 0,                     /* "end of file"  */
     YYerror = 256,                 /* error  */
-    YYUNDEF = 257,                 /* "invalid token"  */
-    T_TRUE = 258,                  /* T_TRUE  */
-    T_FALSE = 259,                 /* T_FALSE  */
-    IDENTIFIER = 260,              /* IDENTIFIER  */
-    AND = 261,                     /* AND  */
-    OR = 262,                      /* OR  */
-    NOT = 263,                     /* NOT  */
-    XOR = 264,                     /* XOR  */
-    XNOR = 265,                    /* XNOR  */
-    IMPLIES = 266,                 /* IMPLIES  */
-    IFF = 267,                     /* IFF  */
-    EQUIV = 268,                   /* EQUIV  */
-    EXISTS = 269,                  /* EXISTS  */
-    FORALL = 270,                  /* FORALL  */
-    IF = 271,                      /* IF  */
-    IFF_KEYWORD = 272,             /* IFF_KEYWORD  */
-    ASSIGN = 273,                  /* ASSIGN  */
-    LPAREN = 274,                  /* LPAREN  */
-    RPAREN = 275,                  /* RPAREN  */
+    YYUNDEF = 278,                 /* "invalid token"  */
+    AND = 258,                     /* AND  */
+    OR = 259,                      /* OR  */
+    NOT = 260,                     /* NOT  */
+    XOR = 261,                     /* XOR  */
+    XNOR = 262,                    /* XNOR  */
+    IMPLIES = 263,                 /* IMPLIES  */
+    IFF = 264,                     /* IFF  */
+    ASSIGN = 265,                  /* ASSIGN  */
+    EQUIV = 266,                   /* EQUIV  */
+    EXISTS = 267,                  /* EXISTS  */
+    FORALL = 268,                  /* FORALL  */
+    IF = 269,                      /* IF  */
+    IFF_KEYWORD = 270,             /* IFF_KEYWORD  */
+    LPAREN = 271,                  /* LPAREN  */
+    RPAREN = 272,                  /* RPAREN  */
+    T_TRUE = 273,                  /* T_TRUE  */
+    T_FALSE = 274,                 /* T_FALSE  */
+    IDENTIFIER = 275,              /* IDENTIFIER  */
     INVALID_TOKEN = 276,           /* INVALID_TOKEN  */
     EOF_TOKEN = 277                /* EOF_TOKEN  */
   };
@@ -82,13 +89,15 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 22 "parser.y"
+#line 34 "parser.y"
 
     int bool_val;
     char* str;
-    ASTNode* node;
+    SymbolId symbol;
+    NodeIndex node;
+    int line;
 
-#line 92 "parser.tab.h"
+#line 101 "parser.tab.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
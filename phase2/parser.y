@@ -3,15 +3,20 @@
 #include <stdlib.h>
 #include <string.h>
 
-// Forward declarations
-typedef struct ASTNode ASTNode;
-
 #include "ast.h"
 
 // Global variables
 extern FILE* token_input;
 extern int current_line;
-ASTNode* ast_root = NULL;
+AST* ast_root = NULL;     // Built by the actions below, in reduction (post-) order
+
+// AST under construction; a driver may create and size it before yyparse
+static AST* tree(void) {
+    if (!ast_root) {
+        ast_root = create_ast();
+    }
+    return ast_root;
+}
 
 // Function prototypes
 int yylex(void);
@@ -19,25 +24,35 @@ void yyerror(const char* msg);
 int parse_tokens_from_file(const char* filename);
 %}
 
+// SymbolId and NodeIndex must be known wherever parser.tab.h is included
+%code requires {
+#include "intern.h"
+#include "ast.h"
+}
+
+// IDENTIFIER carries the interned symbol ID assigned by the token source
 %union {
     int bool_val;
     char* str;
-    ASTNode* node;
+    SymbolId symbol;
+    NodeIndex node;
+    int line;
 }
 
-// Token declarations from Phase 1
-%token <bool_val> T_TRUE T_FALSE
-%token <str> IDENTIFIER
-%token AND OR NOT XOR XNOR
-%token IMPLIES IFF EQUIV
-%token EXISTS FORALL
-%token IF IFF_KEYWORD
-%token ASSIGN
-%token LPAREN RPAREN
-%token INVALID_TOKEN EOF_TOKEN
+// Token declarations from Phase 1 (codes must match phase1/tokens.h so the
+// flex scanner can feed yyparse directly)
+%token AND 258 OR 259 NOT 260 XOR 261 XNOR 262
+%token IMPLIES 263 IFF 264
+%token ASSIGN 265 EQUIV 266
+%token EXISTS 267 FORALL 268
+%token IF 269 IFF_KEYWORD 270
+%token LPAREN 271 RPAREN 272
+%token <bool_val> T_TRUE 273 T_FALSE 274
+%token <symbol> IDENTIFIER 275
+%token INVALID_TOKEN 276 EOF_TOKEN 277
 
 // Non-terminal types
-%type <node> program statement_list statement expression
+%type <node> statement expression
 %type <node> logical_expr term factor
 %type <node> assignment quantified_expr
 
@@ -58,37 +73,20 @@ int parse_tokens_from_file(const char* filename);
 
 program:
     statement_list {
-        ast_root = create_program_node(current_line);
-        if ($1) {
-            // If we have a statement list, copy its statements to the program
-            if ($1->type == AST_STATEMENT_LIST) {
-                for (int i = 0; i < $1->data.program.count; i++) {
-                    add_statement_to_program(ast_root, $1->data.program.statements[i]);
-                }
-            } else {
-                add_statement_to_program(ast_root, $1);
-            }
-        }
-        $$ = ast_root;
+        create_program_node(tree(), current_line);
     }
     | /* empty */ {
-        ast_root = create_program_node(current_line);
-        $$ = ast_root;
+        create_program_node(tree(), current_line);
     }
     ;
 
+// Statements are recorded as they are reduced; the list itself has no node
 statement_list:
     statement {
-        $$ = create_program_node(current_line);
-        if ($1) {
-            add_statement_to_program($$, $1);
-        }
+        add_statement(tree(), $1);
     }
     | statement_list statement {
-        $$ = $1;
-        if ($2) {
-            add_statement_to_program($$, $2);
-        }
+        add_statement(tree(), $2);
     }
     ;
 
@@ -97,14 +95,15 @@ statement:
         $$ = $1;
     }
     | expression {
-        $$ = create_expression_stmt_node($1, current_line);
+        $$ = create_expression_stmt_node(tree(), $1, current_line);
     }
     ;
 
+// An action reduces after reading the next token, which may start the next
+// statement, so the assignment takes the line of its '=' instead
 assignment:
-    IDENTIFIER ASSIGN expression {
-        $$ = create_assignment_node($1, $3, current_line);
-        free($1); // Free the string since we copied it
+    IDENTIFIER ASSIGN { $<line>$ = current_line; } expression {
+        $$ = create_assignment_node(tree(), $1, $4, $<line>3);
     }
     ;
 
@@ -116,25 +115,25 @@ expression:
 
 logical_expr:
     logical_expr IFF logical_expr {
-        $$ = create_binary_node(AST_IFF, $1, $3, current_line);
+        $$ = create_binary_node(tree(), AST_IFF, $1, $3, current_line);
     }
     | logical_expr EQUIV logical_expr {
-        $$ = create_binary_node(AST_EQUIV, $1, $3, current_line);
+        $$ = create_binary_node(tree(), AST_EQUIV, $1, $3, current_line);
     }
     | logical_expr IMPLIES logical_expr {
-        $$ = create_binary_node(AST_IMPLIES, $1, $3, current_line);
+        $$ = create_binary_node(tree(), AST_IMPLIES, $1, $3, current_line);
     }
     | logical_expr OR logical_expr {
-        $$ = create_binary_node(AST_OR, $1, $3, current_line);
+        $$ = create_binary_node(tree(), AST_OR, $1, $3, current_line);
     }
     | logical_expr XOR logical_expr {
-        $$ = create_binary_node(AST_XOR, $1, $3, current_line);
+        $$ = create_binary_node(tree(), AST_XOR, $1, $3, current_line);
     }
     | logical_expr XNOR logical_expr {
-        $$ = create_binary_node(AST_XNOR, $1, $3, current_line);
+        $$ = create_binary_node(tree(), AST_XNOR, $1, $3, current_line);
     }
     | logical_expr AND logical_expr {
-        $$ = create_binary_node(AST_AND, $1, $3, current_line);
+        $$ = create_binary_node(tree(), AST_AND, $1, $3, current_line);
     }
     | term {
         $$ = $1;
@@ -143,7 +142,7 @@ logical_expr:
 
 term:
     NOT factor {
-        $$ = create_unary_node(AST_NOT, $2, current_line);
+        $$ = create_unary_node(tree(), AST_NOT, $2, current_line);
     }
     | factor {
         $$ = $1;
@@ -152,14 +151,13 @@ term:
 
 factor:
     IDENTIFIER {
-        $$ = create_identifier_node($1, current_line);
-        free($1); // Free the string since we copied it
+        $$ = create_identifier_node(tree(), $1, current_line);
     }
     | T_TRUE {
-        $$ = create_boolean_node(1, current_line);
+        $$ = create_boolean_node(tree(), 1, current_line);
     }
     | T_FALSE {
-        $$ = create_boolean_node(0, current_line);
+        $$ = create_boolean_node(tree(), 0, current_line);
     }
     | LPAREN logical_expr RPAREN {
         $$ = $2;
@@ -171,12 +169,10 @@ factor:
 
 quantified_expr:
     EXISTS IDENTIFIER logical_expr {
-        $$ = create_quantifier_node(AST_EXISTS, $2, $3, current_line);
-        free($2);
+        $$ = create_quantifier_node(tree(), AST_EXISTS, $2, $3, current_line);
     }
     | FORALL IDENTIFIER logical_expr {
-        $$ = create_quantifier_node(AST_FORALL, $2, $3, current_line);
-        free($2);
+        $$ = create_quantifier_node(tree(), AST_FORALL, $2, $3, current_line);
     }
     ;
 
@@ -2,8 +2,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "ast.h"
 #include "parser.tab.h"  // This will contain the token definitions
+#include "token_parser.h"
 
 // Global variables
 FILE* token_input = NULL;
@@ -13,6 +18,16 @@ static char current_lexeme[100];
 static int current_value;
 static int end_of_tokens = 0;
 
+// Mapped binary token stream (tokens.bin); stream_symbols maps the file's
+// symbol IDs to this process's interned IDs
+static void* stream_map = NULL;
+static size_t stream_size = 0;
+static const TokenRecord* stream_records = NULL;
+static uint32_t stream_count = 0;
+static uint32_t stream_next = 0;
+static SymbolId* stream_symbols = NULL;
+static uint32_t stream_symbol_count = 0;
+
 // Convert token string to token value
 int string_to_token(const char* token_str) {
     if (strcmp(token_str, "IDENTIFIER") == 0) return IDENTIFIER;
@@ -87,8 +102,153 @@ int read_next_token_from_file() {
     return 0;
 }
 
+// Check for the binary token stream magic
+int is_token_stream_file(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        return 0;
+    }
+    
+    char magic[4];
+    int matches = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                  memcmp(magic, TOKEN_STREAM_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+    return matches;
+}
+
+// Map a binary token stream and validate its layout
+int open_token_stream(const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open token file '%s'\n", filename);
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TokenStreamHeader)) {
+        fprintf(stderr, "Error: Token file '%s' is truncated\n", filename);
+        close(fd);
+        return -1;
+    }
+    
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map token file '%s'\n", filename);
+        return -1;
+    }
+    
+    const TokenStreamHeader* header = map;
+    size_t records_size = (size_t)header->token_count * sizeof(TokenRecord);
+    size_t expected = sizeof(TokenStreamHeader) + records_size + header->string_table_size;
+    
+    if (memcmp(header->magic, TOKEN_STREAM_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != TOKEN_STREAM_VERSION ||
+        expected != (size_t)st.st_size ||
+        (header->string_table_size > 0 &&
+         ((const char*)map)[st.st_size - 1] != '\0')) {
+        fprintf(stderr, "Error: '%s' is not a valid version %d token stream\n",
+                filename, TOKEN_STREAM_VERSION);
+        munmap(map, st.st_size);
+        return -1;
+    }
+    
+    stream_map = map;
+    stream_size = st.st_size;
+    stream_records = (const TokenRecord*)(header + 1);
+    stream_count = header->token_count;
+    stream_next = 0;
+    
+    // Intern the string table once; records then translate by index
+    stream_symbols = malloc((header->symbol_count ? header->symbol_count : 1) * sizeof(SymbolId));
+    if (!stream_symbols) {
+        fprintf(stderr, "Error: Out of memory reading '%s'\n", filename);
+        close_token_stream();
+        return -1;
+    }
+    
+    const char* name = (const char*)(stream_records + header->token_count);
+    const char* strings_end = name + header->string_table_size;
+    for (uint32_t i = 0; i < header->symbol_count; i++) {
+        const char* name_end = name < strings_end ? memchr(name, '\0', strings_end - name) : NULL;
+        if (!name_end) {
+            fprintf(stderr, "Error: String table of '%s' holds fewer than %u names\n",
+                    filename, header->symbol_count);
+            close_token_stream();
+            return -1;
+        }
+        stream_symbols[stream_symbol_count++] = intern_name(name, name_end - name);
+        name = name_end + 1;
+    }
+    
+    // Every identifier must refer to a name in the table
+    for (uint32_t i = 0; i < stream_count; i++) {
+        if (stream_records[i].kind == IDENTIFIER &&
+            stream_records[i].symbol >= stream_symbol_count) {
+            fprintf(stderr, "Error: Token %u in '%s' has no identifier name\n", i + 1, filename);
+            close_token_stream();
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+// Unmap the binary token stream
+void close_token_stream(void) {
+    if (stream_map) {
+        munmap(stream_map, stream_size);
+    }
+    free(stream_symbols);
+    stream_map = NULL;
+    stream_size = 0;
+    stream_records = NULL;
+    stream_count = 0;
+    stream_next = 0;
+    stream_symbols = NULL;
+    stream_symbol_count = 0;
+}
+
+// Records of the mapped stream (valid until close_token_stream)
+const TokenRecord* token_stream_records(uint32_t* count) {
+    *count = stream_count;
+    return stream_records;
+}
+
+// Interned symbol of a mapped identifier record, or NO_SYMBOL
+SymbolId token_stream_symbol(const TokenRecord* record) {
+    if (record->kind != IDENTIFIER || record->symbol >= stream_symbol_count) {
+        return NO_SYMBOL;
+    }
+    return stream_symbols[record->symbol];
+}
+
+// Next token from the mapped stream; identifiers reach the grammar as
+// interned symbol IDs
+static int read_next_token_from_stream(void) {
+    if (stream_next >= stream_count) {
+        return 0;
+    }
+    
+    const TokenRecord* record = &stream_records[stream_next++];
+    current_line = record->line;
+    
+    extern YYSTYPE yylval;
+    if (record->kind == T_TRUE || record->kind == T_FALSE) {
+        yylval.bool_val = (record->kind == T_TRUE);
+    } else if (record->kind == IDENTIFIER) {
+        yylval.symbol = token_stream_symbol(record);
+    }
+    
+    return record->kind;
+}
+
 // Bison's yylex function - interface between parser and token reader
 int yylex(void) {
+    if (stream_map) {
+        return read_next_token_from_stream();
+    }
+    
     int token = read_next_token_from_file();
     
     if (token == 0) {
@@ -101,31 +261,38 @@ int yylex(void) {
     if (token == T_TRUE || token == T_FALSE) {
         yylval.bool_val = current_value;
     } else if (token == IDENTIFIER) {
-        yylval.str = strdup(current_lexeme);
+        yylval.symbol = intern_string(current_lexeme);
     }
     
     return token;
 }
 
-// Initialize token parser
+// Initialize token parser (binary tokens.bin or text tokens.txt)
 int init_token_parser(const char* token_file) {
+    current_line = 1;
+    end_of_tokens = 0;
+    
+    if (is_token_stream_file(token_file)) {
+        return open_token_stream(token_file);
+    }
+    
     token_input = fopen(token_file, "r");
     if (!token_input) {
         fprintf(stderr, "Error: Cannot open token file '%s'\n", token_file);
         return -1;
     }
     
-    current_line = 1;
-    end_of_tokens = 0;
     return 0;
 }
 
 // Cleanup token parser
-void cleanup_token_parser() {
+void cleanup_token_parser(void) {
     if (token_input) {
         fclose(token_input);
         token_input = NULL;
     }
+    
+    close_token_stream();
 }
 
 // Convert token value to string (for debugging)
@@ -161,6 +328,17 @@ int parse_tokens_from_file(const char* filename) {
         return -1;
     }
     
+    // Every node except EXPRESSION_STMT and PROGRAM consumes a token, so a
+    // binary stream's record count bounds the size of the AST
+    extern AST* ast_root;
+    uint32_t record_count = 0;
+    if (token_stream_records(&record_count) && record_count < NO_NODE / 2) {
+        if (!ast_root) {
+            ast_root = create_ast();
+        }
+        ast_reserve(ast_root, 2 * record_count + 1);
+    }
+    
     // Call bison parser
     extern int yyparse(void);
     
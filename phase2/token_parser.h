@@ -0,0 +1,23 @@
+#ifndef TOKEN_PARSER_H
+#define TOKEN_PARSER_H
+
+#include <stdio.h>
+#include "token_stream.h"
+#include "intern.h"
+
+// Token input for the bison parser: the binary tokens.bin stream from
+// Phase 1 (mapped read-only) or the older text tokens.txt listing
+
+int init_token_parser(const char* token_file);
+void cleanup_token_parser(void);
+int parse_tokens_from_file(const char* filename);
+const char* token_type_to_string(int type);
+
+// Binary token stream access
+int is_token_stream_file(const char* filename);
+int open_token_stream(const char* filename);
+void close_token_stream(void);
+const TokenRecord* token_stream_records(uint32_t* count);
+SymbolId token_stream_symbol(const TokenRecord* record);
+
+#endif // TOKEN_PARSER_H
@@ -3,17 +3,39 @@
 #include <string.h>
 #include <unistd.h>
 #include "semantic_analyzer.h"
+#include "ast_file.h"
 
 // External function declarations
-extern ASTNode* load_ast_from_file(const char* filename);
+extern AST* load_ast_from_file(const char* filename);
 
 void print_header() {
     printf("SEMANTIC ANALYSIS\n");
 }
 
+void print_binary_input_info(const char* filename) {
+    AstFileHeader header;
+    if (read_ast_file_header(filename, &header) != 0) {
+        printf(" [ERROR: Cannot read AST file]\n");
+        printf("\n\n");
+        return;
+    }
+    
+    printf(" Binary AST, version %u%s\n", header.version,
+           header.flags & AST_FILE_ANNOTATED ? " (annotated)" : "");
+    printf(" Total nodes: %u\n", header.node_count);
+    printf(" Statements: %u\n", header.statement_count);
+    printf(" Identifier names: %u\n", header.symbol_count);
+    printf("\n\n");
+}
+
 void print_input_file_info(const char* filename) {
     printf("INPUT FILE: %s\n", filename);
     
+    if (is_ast_file(filename)) {
+        print_binary_input_info(filename);
+        return;
+    }
+    
     FILE* file = fopen(filename, "r");
     if (!file) {
         printf(" [ERROR: Cannot read AST file]\n");
@@ -67,11 +89,21 @@ void print_input_file_info(const char* filename) {
     printf("\n\n");
 }
 
-void print_output_files_info() {
+void print_output_files_info(int write_text) {
     printf(" OUTPUT FILES GENERATED\n");
     
+    // Check annotated_ast.bin
+    AstFileHeader header;
+    if (read_ast_file_header("annotated_ast.bin", &header) == 0) {
+        printf("annotated_ast.bin (%u nodes)\n", header.node_count);
+    } else {
+        printf("annotated_ast.bin (not created)\n");
+    }
+    
     // Check annotated_ast.txt
-    if (access("annotated_ast.txt", F_OK) == 0) {
+    if (!write_text) {
+        // Readable report only on request
+    } else if (access("annotated_ast.txt", F_OK) == 0) {
         FILE* file = fopen("annotated_ast.txt", "r");
         if (file) {
             char line[256];
@@ -132,20 +164,36 @@ void display_analysis_results(SemanticContext* ctx) {
 }
 
 int main(int argc, char* argv[]) {
+    // --text also writes the readable annotated_ast.txt report
+    const char* input_file = NULL;
+    int write_text = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--text") == 0) {
+            write_text = 1;
+        } else if (argv[i][0] != '-' && !input_file) {
+            input_file = argv[i];
+        } else {
+            printf("Usage: %s [--text] [ast.bin]\n\n", argv[0]);
+            return 1;
+        }
+    }
+    
     print_header();
     
     // Determine input file
-    const char* input_file = "ast.txt";  // Default
-    if (argc > 1) {
-        input_file = argv[1];
+    int default_input = input_file == NULL;
+    if (default_input) {
+        input_file = "ast.bin";
+    } else {
         printf("Using input file: %s\n\n", input_file);
     }
     
     // Check if input file exists
     if (access(input_file, F_OK) != 0) {
         printf("ERROR: %s not found!\n", input_file);
-        if (argc == 1) {
-            printf("   Please run Phase 2 first to generate ast.txt\n");
+        if (default_input) {
+            printf("   Please run Phase 2 first to generate ast.bin\n");
         } else {
             printf("   Please check the file path and try again\n");
         }
@@ -157,7 +205,7 @@ int main(int argc, char* argv[]) {
     print_input_file_info(input_file);
     
     // Load AST from file
-    ASTNode* ast = load_ast_from_file(input_file);
+    AST* ast = load_ast_from_file(input_file);
     if (!ast) {
         printf(" PHASE 3 Failed: Could not load AST from file\n\n");
         return 1;
@@ -167,7 +215,7 @@ int main(int argc, char* argv[]) {
     SemanticContext* ctx = create_semantic_context();
     if (!ctx) {
         printf(" PHASE 3 Failed: Could not create semantic context\n\n");
-        free_ast_node(ast);
+        free_asts();
         return 1;
     }
     
@@ -185,10 +233,22 @@ int main(int argc, char* argv[]) {
     
     // Generate output files
     printf(" GENERATING OUTPUT FILES\n");
-    printf(" Creating annotated_ast.txt...\n");
-    generate_annotated_ast(ctx, ast, "annotated_ast.txt");
+    printf(" Creating annotated_ast.bin...\n");
+    if (write_ast_file(ast, "annotated_ast.bin", 1) != 0) {
+        printf(" PHASE 3 Failed: Cannot write annotated_ast.bin\n\n");
+        free_semantic_context(ctx);
+        free_asts();
+        free_interned_symbols();
+        return 1;
+    }
     printf(" Annotated AST generated\n");
     printf("\n");
+    if (write_text) {
+        printf(" Creating annotated_ast.txt...\n");
+        generate_annotated_ast(ctx, ast, "annotated_ast.txt");
+        printf(" Annotated AST report generated\n");
+        printf("\n");
+    }
     printf(" Creating symbol_table.txt...\n");
     print_symbol_table_to_file(ctx->symbol_table, "symbol_table.txt");
     printf(" Symbol table exported\n");
@@ -199,11 +259,12 @@ int main(int argc, char* argv[]) {
     printf("\n\n");
     
     // Display output files info
-    print_output_files_info();
+    print_output_files_info(write_text);
     
     // Cleanup
     free_semantic_context(ctx);
-    free_ast_node(ast);
+    free_asts();
+    free_interned_symbols();
     
     return analysis_result == 0 ? 0 : 1;
 }
\ No newline at end of file
@@ -7,10 +7,21 @@
 // Create semantic context
 SemanticContext* create_semantic_context(void) {
     SemanticContext* ctx = malloc(sizeof(SemanticContext));
-    ctx->symbol_table = create_symbol_table(101);  // Prime number for better hashing
+    ctx->symbol_table = create_symbol_table(64);  // Grows with the program
     ctx->errors = NULL;
     ctx->error_count = 0;
     ctx->warning_count = 0;
+    ctx->fold_marks = NULL;
+    ctx->fold_values = NULL;
+    ctx->fold_order = NULL;
+    ctx->fold_stack = NULL;
+    ctx->fold_capacity = 0;
+    ctx->fold_stamp = 0;
+    ctx->bound = NULL;
+    ctx->bound_count = 0;
+    ctx->bound_capacity = 0;
+    ctx->constant_statements = 0;
+    ctx->input_free_statements = 0;
     return ctx;
 }
 
@@ -19,6 +30,11 @@ void free_semantic_context(SemanticContext* ctx) {
     if (!ctx) return;
     
     free_symbol_table(ctx->symbol_table);
+    free(ctx->fold_marks);
+    free(ctx->fold_values);
+    free(ctx->fold_order);
+    free(ctx->fold_stack);
+    free(ctx->bound);
     
     // Free error list
     SemanticError* error = ctx->errors;
@@ -60,159 +76,419 @@ const char* semantic_error_type_to_string(SemanticErrorType type) {
     }
 }
 
+// Constant folding. A statement's expression is folded at once under two
+// environments: every earlier constant assignment known, as a compiled
+// program sees them, and the inputs unknown, as a rule function, batch
+// kernel or the VM sees them when the caller supplies the inputs. An
+// operator is known when the known operands decide it, so "A AND FALSE"
+// folds whatever A is. Variables a quantifier in the statement binds are
+// unknown throughout it, since their identifier nodes may be shared with
+// uses outside the quantifier.
+#define FOLD_KNOWN      0x01    // Value known with all constants
+#define FOLD_VALUE      0x02
+#define FOLD_FREE       0x04    // Value known with the inputs unknown
+#define FOLD_FREE_VALUE 0x08
+#define FOLD_LISTED     0x10    // In fold_order (traversal only)
+
+static void* fold_alloc(void* memory, size_t size) {
+    memory = realloc(memory, size ? size : 1);
+    if (!memory) {
+        fprintf(stderr, "Out of memory for constant folding\n");
+        exit(1);
+    }
+    return memory;
+}
+
+static void reserve_fold_scratch(SemanticContext* ctx, uint32_t nodes) {
+    if (nodes <= ctx->fold_capacity) return;
+    ctx->fold_marks = fold_alloc(ctx->fold_marks, nodes * sizeof(uint32_t));
+    memset(ctx->fold_marks + ctx->fold_capacity, 0,
+           (nodes - ctx->fold_capacity) * sizeof(uint32_t));
+    ctx->fold_values = fold_alloc(ctx->fold_values, nodes * sizeof(uint8_t));
+    ctx->fold_order = fold_alloc(ctx->fold_order, nodes * sizeof(NodeIndex));
+    ctx->fold_stack = fold_alloc(ctx->fold_stack, (2 * (size_t)nodes + 1) * sizeof(NodeIndex));
+    ctx->fold_capacity = nodes;
+}
+
+static void add_bound_variable(SemanticContext* ctx, SymbolId id) {
+    if (ctx->bound_count == ctx->bound_capacity) {
+        ctx->bound_capacity = ctx->bound_capacity ? ctx->bound_capacity * 2 : 8;
+        ctx->bound = fold_alloc(ctx->bound, ctx->bound_capacity * sizeof(SymbolId));
+    }
+    ctx->bound[ctx->bound_count++] = id;
+}
+
+// Fold one operator over operands that may be unknown; returns whether
+// the result is known and stores it in value
+static int fold_operator(ASTNodeType type, int left_known, int left, int right_known,
+                         int right, int* value) {
+    switch (type) {
+        case AST_NOT:
+            *value = !left;
+            return left_known;
+        case AST_EXISTS:
+        case AST_FORALL:
+            // A known body does not depend on the bound variable
+            *value = left;
+            return left_known;
+        case AST_AND:
+            *value = !((left_known && !left) || (right_known && !right));
+            return !*value || (left_known && right_known);
+        case AST_OR:
+            *value = (left_known && left) || (right_known && right);
+            return *value || (left_known && right_known);
+        case AST_IMPLIES:
+            *value = (left_known && !left) || (right_known && right);
+            return *value || (left_known && right_known);
+        case AST_XOR:
+            *value = left != right;
+            return left_known && right_known;
+        case AST_XNOR:
+        case AST_IFF:
+        case AST_EQUIV:
+            *value = left == right;
+            return left_known && right_known;
+        default:
+            return 0;
+    }
+}
+
+// FOLD_* bits of a node whose operands are already folded
+static uint8_t fold_node(SemanticContext* ctx, const AST* ast, NodeIndex node) {
+    ASTNodeType type = (ASTNodeType)ast->kinds[node];
+    
+    if (type == AST_BOOLEAN_LITERAL) {
+        return ast->operands[node] ? FOLD_KNOWN | FOLD_VALUE | FOLD_FREE | FOLD_FREE_VALUE
+                                   : FOLD_KNOWN | FOLD_FREE;
+    }
+    if (type == AST_IDENTIFIER) {
+        SymbolId id = ast->operands[node];
+        for (uint32_t i = 0; i < ctx->bound_count; i++) {
+            if (ctx->bound[i] == id) return 0;
+        }
+        SymbolEntry* entry = lookup_symbol(ctx->symbol_table, id);
+        if (!entry || !entry->is_constant) return 0;
+        int value = entry->value.bool_value != 0;
+        uint8_t bits = FOLD_KNOWN | (value ? FOLD_VALUE : 0);
+        if (entry->input_free) {
+            bits |= FOLD_FREE | (value ? FOLD_FREE_VALUE : 0);
+        }
+        return bits;
+    }
+    
+    uint8_t left = ast->left[node] != NO_NODE ? ctx->fold_values[ast->left[node]] : 0;
+    uint8_t right = ast->right[node] != NO_NODE ? ctx->fold_values[ast->right[node]] : 0;
+    uint8_t bits = 0;
+    int value;
+    if (fold_operator(type, left & FOLD_KNOWN, (left & FOLD_VALUE) != 0,
+                      right & FOLD_KNOWN, (right & FOLD_VALUE) != 0, &value)) {
+        bits |= FOLD_KNOWN | (value ? FOLD_VALUE : 0);
+    }
+    if (fold_operator(type, left & FOLD_FREE, (left & FOLD_FREE_VALUE) != 0,
+                      right & FOLD_FREE, (right & FOLD_FREE_VALUE) != 0, &value)) {
+        bits |= FOLD_FREE | (value ? FOLD_FREE_VALUE : 0);
+    }
+    return bits;
+}
+
+// Fold the expression at root with the symbols' current values. Its
+// operands may be shared nodes of earlier statements, so the nodes it
+// reaches are listed children first by a walk rather than taken from the
+// statement's node range.
+static uint8_t fold_expression(SemanticContext* ctx, const AST* ast, NodeIndex root) {
+    reserve_fold_scratch(ctx, ast->count);
+    uint32_t stamp = ++ctx->fold_stamp;
+    uint32_t count = 0, top = 0;
+    ctx->bound_count = 0;
+    
+    // A node is marked when its operands are pushed, and listed when it is
+    // next on top; a node pushed twice is listed once
+    ctx->fold_stack[top++] = root;
+    while (top > 0) {
+        NodeIndex node = ctx->fold_stack[top - 1];
+        if (ctx->fold_marks[node] != stamp) {
+            ctx->fold_marks[node] = stamp;
+            ctx->fold_values[node] = 0;
+            ASTNodeType type = (ASTNodeType)ast->kinds[node];
+            if (type == AST_EXISTS || type == AST_FORALL) {
+                add_bound_variable(ctx, ast->operands[node]);
+            }
+            NodeIndex right = ast->right[node], left = ast->left[node];
+            if (right != NO_NODE && ctx->fold_marks[right] != stamp) ctx->fold_stack[top++] = right;
+            if (left != NO_NODE && ctx->fold_marks[left] != stamp) ctx->fold_stack[top++] = left;
+            continue;
+        }
+        top--;
+        if (ctx->fold_values[node] & FOLD_LISTED) continue;
+        ctx->fold_values[node] = FOLD_LISTED;
+        ctx->fold_order[count++] = node;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        NodeIndex node = ctx->fold_order[i];
+        ctx->fold_values[node] = fold_node(ctx, ast, node);
+    }
+    return ctx->fold_values[root];
+}
+
+// Record a statement's folded value on its node, which no other statement
+// shares, and report it when its expression folded to a constant
+static void set_statement_constant(SemanticContext* ctx, AST* ast, NodeIndex node,
+                                   int known, int value, int input_free) {
+    set_node_attributes(ast, node, SYM_BOOLEAN, known, value);
+    if (input_free) {
+        ast->attributes[node] |= AST_ATTR_INPUT_FREE;
+    }
+    
+    NodeIndex expression = ast->left[node];
+    if (!known || expression == NO_NODE || ast->kinds[expression] == AST_BOOLEAN_LITERAL) return;
+    ctx->constant_statements++;
+    ctx->input_free_statements += input_free != 0;
+    printf("   Statement folded to %s%s\n", value ? "TRUE" : "FALSE",
+           input_free ? "" : " (with the inputs' declared values)");
+}
+
 // Analyze identifier node
-void analyze_identifier(SemanticContext* ctx, ASTNode* node) {
-    if (!node || !node->data.identifier) return;
+void analyze_identifier(SemanticContext* ctx, AST* ast, NodeIndex node) {
+    SymbolId id = ast->operands[node];
+    if (id == NO_SYMBOL) return;
     
-    const char* name = node->data.identifier;
-    SymbolEntry* entry = lookup_symbol(ctx->symbol_table, name);
+    int line = ast->lines[node];
+    SymbolEntry* entry = lookup_symbol(ctx->symbol_table, id);
     
     if (!entry) {
         // First time seeing this identifier - could be undefined reference
-        entry = insert_symbol(ctx->symbol_table, name, SYM_IDENTIFIER, node->line_number);
-        printf("Found new identifier: %s at line %d\n", name, node->line_number);
+        entry = insert_symbol(ctx->symbol_table, id, SYM_IDENTIFIER, line);
+        printf("Found new identifier: %s at line %d\n", symbol_name(id), line);
     }
     
     // Mark as used
-    mark_symbol_used(ctx->symbol_table, name, node->line_number);
-    node->semantic_type = SYM_BOOLEAN;  // Assume boolean for logical expressions
+    mark_symbol_used(ctx->symbol_table, id, line);
+    set_node_attributes(ast, node, SYM_BOOLEAN, 0, 0);  // Assume boolean for logical expressions
     
-    printf("Analyzing identifier '%s' - marked as used\n", name);
+    printf("Analyzing identifier '%s' - marked as used\n", symbol_name(id));
 }
 
-// Analyze assignment node
-void analyze_assignment(SemanticContext* ctx __attribute__((unused)), ASTNode* node) {
-    if (!node) return;
+// Analyze assignment node (its value has already been analyzed, and is
+// folded before the variable changes, so "A = A OR B" sees the previous A)
+void analyze_assignment(SemanticContext* ctx, AST* ast, NodeIndex node) {
+    SymbolId id = ast->operands[node];
+    if (id == NO_SYMBOL) return;
+    
+    NodeIndex value = ast->left[node];
+    int line = ast->lines[node];
+    
+    printf("Analyzing assignment to '%s' at line %d\n", symbol_name(id), line);
+    
+    uint8_t folded = value != NO_NODE ? fold_expression(ctx, ast, value) : 0;
+    int is_constant = (folded & FOLD_KNOWN) != 0;
+    int bool_value = (folded & FOLD_VALUE) != 0;
     
-    printf("Analyzing assignment at line %d\n", node->line_number);
+    SymbolEntry* entry = insert_symbol(ctx->symbol_table, id, SYM_BOOLEAN, line);
+    entry->type = SYM_BOOLEAN;
+    set_symbol_value(ctx->symbol_table, id, bool_value, line);
     
-    // For our simplified AST structure, we'll simulate the assignment analysis
-    // In a complete implementation, we would traverse the assignment's children
-    // to find the variable name and value expression
+    // A variable first assigned a literal is an input outside program
+    // mode, so later statements only know it from its declared value
+    int input = entry->assignments++ == 0 && value != NO_NODE &&
+                ast->kinds[value] == AST_BOOLEAN_LITERAL;
+    entry->is_constant = is_constant;
+    entry->input_free = !input && (folded & FOLD_FREE) != 0;
     
-    node->semantic_type = SYM_BOOLEAN;
+    set_statement_constant(ctx, ast, node, is_constant, bool_value, entry->input_free);
     
-    // This is a placeholder - in practice we would extract the actual
-    // variable name and value from the AST structure
     printf("Assignment validated - boolean type inferred\n");
 }
 
+// Fold an operator node from its operands' attributes alone. The node may
+// be shared between statements, so only literals count as known here;
+// analyze_assignment propagates variables' values per statement.
+static void fold_operator_node(AST* ast, NodeIndex node) {
+    NodeIndex left = ast->left[node], right = ast->right[node];
+    int left_known = left != NO_NODE && node_is_constant(ast, left);
+    int right_known = right != NO_NODE && node_is_constant(ast, right);
+    int value;
+    int known = fold_operator((ASTNodeType)ast->kinds[node],
+                              left_known, left_known && node_constant_value(ast, left),
+                              right_known, right_known && node_constant_value(ast, right),
+                              &value);
+    set_node_attributes(ast, node, SYM_BOOLEAN, known, known && value);
+}
+
 // Analyze binary operation
-void analyze_binary_operation(SemanticContext* ctx __attribute__((unused)), ASTNode* node) {
-    if (!node) return;
-    
+void analyze_binary_operation(SemanticContext* ctx, AST* ast, NodeIndex node) {
+    (void)ctx;
     printf("Analyzing binary operation (%s) at line %d\n", 
-           node->node_type_str, node->line_number);
-    
-    // For logical operations, result is boolean
-    if (node->type == 6 || node->type == 7 || node->type == 9 || 
-        node->type == 10 || node->type == 11 || node->type == 12) {  
-        // AND, OR, XOR, IMPLIES, IFF, EQUIV
-        node->semantic_type = SYM_BOOLEAN;
-        node->is_constant = 0;  // Result depends on operands
-        
-        printf("Binary operation result type: BOOLEAN\n");
-    }
+           ast_node_type_to_string((ASTNodeType)ast->kinds[node]), ast->lines[node]);
+    
+    // For logical operations, result is boolean, constant when literals
+    // decide it
+    fold_operator_node(ast, node);
+    
+    printf("Binary operation result type: BOOLEAN\n");
 }
 
 // Analyze unary operation
-void analyze_unary_operation(SemanticContext* ctx __attribute__((unused)), ASTNode* node) {
-    if (!node) return;
-    
+void analyze_unary_operation(SemanticContext* ctx, AST* ast, NodeIndex node) {
+    (void)ctx;
     printf("Analyzing unary operation (%s) at line %d\n", 
-           node->node_type_str, node->line_number);
+           ast_node_type_to_string((ASTNodeType)ast->kinds[node]), ast->lines[node]);
+    
+    fold_operator_node(ast, node);
+    printf("   Unary NOT operation result type: BOOLEAN\n");
+}
+
+// Analyze a quantifier. The binding is scoped to its body: it does not
+// define the variable, and resolve_bound_uses decides afterwards whether
+// the variable is also used outside every quantifier binding it.
+void analyze_quantifier(SemanticContext* ctx, AST* ast, NodeIndex node) {
+    (void)ctx;
+    SymbolId id = ast->operands[node];
+    if (id == NO_SYMBOL) return;
+    
+    printf("Analyzing %s quantifier over '%s' at line %d\n", 
+           ast_node_type_to_string((ASTNodeType)ast->kinds[node]), symbol_name(id), ast->lines[node]);
+    
+    fold_operator_node(ast, node);
+}
+
+// Bound variables resolved per pass of resolve_bound_uses, one bit each
+#define BOUND_BATCH 64
+
+// Clear the use of every variable a quantifier binds that never occurs
+// free, outside all quantifiers binding it. Identifier nodes are shared
+// between statements, so a statement's node range does not show which
+// uses are bound; instead one forward pass over all nodes, operands
+// before their users, gives each node the set of bound variables that
+// occur free below it, and a variable occurs free if a statement's set
+// holds it.
+static void resolve_bound_uses(SemanticContext* ctx, const AST* ast) {
+    uint32_t symbols = interned_symbol_count() + 1;
+    uint32_t* bit_of = fold_alloc(NULL, symbols * sizeof(uint32_t));
+    for (uint32_t i = 0; i < symbols; i++) bit_of[i] = UINT32_MAX;
+    
+    ctx->bound_count = 0;
+    for (NodeIndex node = 0; node < ast->count; node++) {
+        SymbolId id = ast->operands[node];
+        if ((ast->kinds[node] == AST_EXISTS || ast->kinds[node] == AST_FORALL) &&
+            id < symbols && bit_of[id] == UINT32_MAX) {
+            bit_of[id] = ctx->bound_count;
+            add_bound_variable(ctx, id);
+        }
+    }
     
-    if (node->type == 8) {  // NOT
-        node->semantic_type = SYM_BOOLEAN;
-        printf("   Unary NOT operation result type: BOOLEAN\n");
+    uint64_t* free_below = ctx->bound_count ? fold_alloc(NULL, ast->count * sizeof(uint64_t)) : NULL;
+    for (uint32_t batch = 0; batch < ctx->bound_count; batch += BOUND_BATCH) {
+        for (NodeIndex node = 0; node < ast->count; node++) {
+            NodeIndex left = ast->left[node], right = ast->right[node];
+            SymbolId id = ast->operands[node];
+            uint32_t bit = id < symbols ? bit_of[id] - batch : UINT32_MAX;
+            uint64_t mask = bit < BOUND_BATCH ? 1ULL << bit : 0;
+            switch ((ASTNodeType)ast->kinds[node]) {
+                case AST_IDENTIFIER:
+                    free_below[node] = mask;
+                    break;
+                case AST_EXISTS:
+                case AST_FORALL:
+                    free_below[node] = free_below[left] & ~mask;
+                    break;
+                default:
+                    free_below[node] = (left != NO_NODE ? free_below[left] : 0) |
+                                       (right != NO_NODE ? free_below[right] : 0);
+                    break;
+            }
+        }
+        
+        uint64_t used = 0;
+        for (uint32_t i = 0; i < ast->statement_count; i++) {
+            used |= free_below[ast->statements[i]];
+        }
+        for (uint32_t i = batch; i < ctx->bound_count && i < batch + BOUND_BATCH; i++) {
+            SymbolEntry* entry = lookup_symbol(ctx->symbol_table, ctx->bound[i]);
+            if (entry && !(used & (1ULL << (i - batch)))) {
+                printf("   '%s' is only used where a quantifier binds it\n", entry->name);
+                entry->is_used = 0;
+                entry->line_used = 0;
+            }
+        }
     }
+    free(free_below);
+    free(bit_of);
 }
 
-// Analyze expression
-void analyze_expression(SemanticContext* ctx, ASTNode* node) {
-    if (!node) return;
+// Analyze one node whose operands have already been analyzed
+void analyze_node(SemanticContext* ctx, AST* ast, NodeIndex node) {
+    ASTNodeType type = (ASTNodeType)ast->kinds[node];
     
-    switch (node->type) {
-        case 4:  // IDENTIFIER
-            analyze_identifier(ctx, node);
+    switch (type) {
+        case AST_IDENTIFIER:
+            analyze_identifier(ctx, ast, node);
+            break;
+        case AST_BOOLEAN_LITERAL:
+            set_node_attributes(ast, node, SYM_BOOLEAN, 1, ast->operands[node]);
+            printf("   Boolean literal: %s\n", ast->operands[node] ? "TRUE" : "FALSE");
+            break;
+        case AST_AND:
+        case AST_OR:
+        case AST_XOR:
+        case AST_XNOR:
+        case AST_IMPLIES:
+        case AST_IFF:
+        case AST_EQUIV:
+            analyze_binary_operation(ctx, ast, node);
             break;
-        case 5:  // BOOLEAN
-            node->semantic_type = SYM_BOOLEAN;
-            node->is_constant = 1;
-            printf("   Boolean literal: %s\n", node->data.bool_literal ? "TRUE" : "FALSE");
+        case AST_NOT:
+            analyze_unary_operation(ctx, ast, node);
             break;
-        case 6:  // AND
-        case 7:  // OR
-        case 9:  // XOR
-        case 10: // IMPLIES
-        case 11: // IFF
-        case 12: // EQUIV
-            analyze_binary_operation(ctx, node);
+        case AST_EXISTS:
+        case AST_FORALL:
+            analyze_quantifier(ctx, ast, node);
             break;
-        case 8:  // NOT
-            analyze_unary_operation(ctx, node);
+        case AST_ASSIGNMENT:
+            analyze_assignment(ctx, ast, node);
+            break;
+        case AST_EXPRESSION_STMT:
+            printf("   Analyzing expression statement at line %d\n", ast->lines[node]);
+            if (ast->left[node] != NO_NODE) {
+                uint8_t folded = fold_expression(ctx, ast, ast->left[node]);
+                set_statement_constant(ctx, ast, node, (folded & FOLD_KNOWN) != 0,
+                                       (folded & FOLD_VALUE) != 0, (folded & FOLD_FREE) != 0);
+            }
             break;
         default:
-            printf("   Unknown expression type: %d\n", node->type);
+            printf("   Unknown node type: %d\n", type);
             break;
     }
 }
 
-// Main node analysis function
-void analyze_node(SemanticContext* ctx, ASTNode* node) {
-    if (!node) return;
+// Analyze one statement: scan its node range in post-order
+void analyze_statement(SemanticContext* ctx, AST* ast, uint32_t statement) {
+    NodeIndex first = statement_first_node(ast, statement);
+    NodeIndex last = ast->statements[statement];
     
-    switch (node->type) {
-        case 1:  // PROGRAM
-            printf("   Analyzing program with %d statements\n", node->data.program.count);
-            for (int i = 0; i < node->data.program.count; i++) {
-                printf("   --- Statement %d ---\n", i + 1);
-                analyze_node(ctx, node->data.program.statements[i]);
-            }
-            break;
-            
-        case 2:  // ASSIGNMENT
-            analyze_assignment(ctx, node);
-            break;
-            
-        case 3:  // EXPRESSION_STMT
-            printf("   Analyzing expression statement at line %d\n", node->line_number);
-            // Expression statements would typically have child nodes to analyze
-            break;
-            
-        default:
-            analyze_expression(ctx, node);
-            break;
+    for (NodeIndex node = first; node <= last; node++) {
+        analyze_node(ctx, ast, node);
     }
 }
 
 // Perform comprehensive semantic analysis
-int perform_semantic_analysis(SemanticContext* ctx, ASTNode* ast) {
-    if (!ctx || !ast) return -1;
+int perform_semantic_analysis(SemanticContext* ctx, AST* ast) {
+    if (!ctx || !ast || ast->root == NO_NODE) return -1;
     
     printf("SEMANTIC ANALYSIS\n");
     
     // Phase 1: Traverse AST and build symbol table
     printf("Phase 1: Building symbol table...\n");
-    analyze_node(ctx, ast);
-    
-    // Phase 2: Add symbols based on our test case (B = TRUE, C = FALSE, B OR C)
-    printf("Phase 2: Processing known symbols...\n");
-    
-    // Add symbol B (assigned TRUE)
-    insert_symbol(ctx->symbol_table, "B", SYM_BOOLEAN, 1);
-    set_symbol_value(ctx->symbol_table, "B", 1, 1);  // B = TRUE
-    mark_symbol_used(ctx->symbol_table, "B", 3);     // Used in B OR C
-    printf("Symbol 'B': BOOLEAN, defined=TRUE, used in expression\n");
-    
-    // Add symbol C (assigned FALSE)  
-    insert_symbol(ctx->symbol_table, "C", SYM_BOOLEAN, 2);
-    set_symbol_value(ctx->symbol_table, "C", 0, 2);  // C = FALSE
-    mark_symbol_used(ctx->symbol_table, "C", 3);     // Used in B OR C
-    printf("Symbol 'C': BOOLEAN, defined=FALSE, used in expression\n");
+    printf("   Analyzing program with %u statements (%u nodes)\n", ast->statement_count, ast->count);
+    for (uint32_t i = 0; i < ast->statement_count; i++) {
+        printf("   --- Statement %u ---\n", i + 1);
+        analyze_statement(ctx, ast, i);
+    }
+    resolve_bound_uses(ctx, ast);
+    set_node_attributes(ast, ast->root, SYM_BOOLEAN, 0, 0);
     
-    // Phase 3: Semantic validation
-    printf("Phase 3: Semantic validation...\n");
+    // Phase 2: Semantic validation
+    printf("Phase 2: Semantic validation...\n");
     
     // Check for undefined symbols (used but not defined)
     int undefined_count = check_undefined_symbols(ctx->symbol_table);
@@ -235,11 +511,12 @@ int perform_semantic_analysis(SemanticContext* ctx, ASTNode* ast) {
     
     // Type consistency checking
     printf("Type consistency verified\n");
-    printf("Expression 'B OR C' is well-formed\n");
 
-    // Phase 4: Final validation
-    printf("Phase 4: Final validation...\n");
+    // Phase 3: Final validation
+    printf("Phase 3: Final validation...\n");
     printf("Symbol table constructed with %d symbols\n", ctx->symbol_table->count);
+    printf("Constant folding: %d of %u statements folded, %d without the inputs\n",
+           ctx->constant_statements, ast->statement_count, ctx->input_free_statements);
     printf("Type checking completed\n");
     printf("Semantic validation finished\n");
     
@@ -323,8 +600,16 @@ void print_semantic_errors_to_file(SemanticContext* ctx, const char* filename) {
     fclose(file);
 }
 
+// Folded value of a constant statement, and whether it holds with the
+// inputs supplied at run time
+static void print_constant_annotation(FILE* file, const AST* ast, NodeIndex stmt) {
+    if (!node_is_constant(ast, stmt)) return;
+    fprintf(file, "Constant_Value: %s\n", node_constant_value(ast, stmt) ? "TRUE" : "FALSE");
+    fprintf(file, "Input_Independent: %s\n", node_is_input_free(ast, stmt) ? "YES" : "NO");
+}
+
 // Generate semantically annotated AST
-void generate_annotated_ast(SemanticContext* ctx, ASTNode* ast, const char* filename) {
+void generate_annotated_ast(SemanticContext* ctx, const AST* ast, const char* filename) {
     FILE* file = fopen(filename, "w");
     if (!file) {
         fprintf(stderr, "Error: Cannot create annotated AST file %s\n", filename);
@@ -345,61 +630,68 @@ void generate_annotated_ast(SemanticContext* ctx, ASTNode* ast, const char* file
     fprintf(file, "Node_Type: PROGRAM\n");
     fprintf(file, "Semantic_Type: PROGRAM_BLOCK\n");
     fprintf(file, "Line: 1\n");
-    fprintf(file, "Statements: %d\n", ast ? ast->data.program.count : 0);
+    fprintf(file, "Statements: %u\n", ast ? ast->statement_count : 0);
     fprintf(file, "Analysis_Status: VALIDATED\n");
     fprintf(file, "\n");
 
-    if (ast && ast->type == 1) {  // PROGRAM
-        for (int i = 0; i < ast->data.program.count; i++) {
-            ASTNode* stmt = ast->data.program.statements[i];
-            fprintf(file, "Statement_%d:\n", i + 1);
-            fprintf(file, "Node_Type: %s\n", stmt->node_type_str);
-            fprintf(file, "Line: %d\n", stmt->line_number);
-            fprintf(file, "Semantic_Type: %s\n", symbol_type_to_string(stmt->semantic_type));
+    if (ast) {
+        for (uint32_t i = 0; i < ast->statement_count; i++) {
+            NodeIndex stmt = ast->statements[i];
+            ASTNodeType type = (ASTNodeType)ast->kinds[stmt];
+            fprintf(file, "Statement_%u:\n", i + 1);
+            fprintf(file, "Node_Type: %s\n", type == AST_EXPRESSION_STMT ? 
+                    "EXPRESSION_STMT" : ast_node_type_to_string(type));
+            fprintf(file, "Line: %d\n", ast->lines[stmt]);
+            fprintf(file, "Semantic_Type: %s\n", symbol_type_to_string(node_semantic_type(ast, stmt)));
             
-            if (stmt->type == 2) {  // ASSIGNMENT
+            if (type == AST_ASSIGNMENT) {
                 fprintf(file, "Operation: VARIABLE_ASSIGNMENT\n");
+                fprintf(file, "Variable: %s\n", symbol_name(ast->operands[stmt]));
                 fprintf(file, "Type_Check: BOOLEAN_ASSIGNMENT\n");
                 fprintf(file, "Symbol_Table_Entry: CREATED\n");
                 fprintf(file, "Validation: PASSED\n");
-            } else if (stmt->type == 3) {  // EXPRESSION_STMT  
+                print_constant_annotation(file, ast, stmt);
+            } else if (type == AST_EXPRESSION_STMT && ast->left[stmt] != NO_NODE) {
                 fprintf(file, "Operation: EXPRESSION_EVALUATION\n");
                 fprintf(file, "Result_Type: BOOLEAN\n");
-                fprintf(file, "Expression: BINARY_LOGICAL_OR\n");
-                fprintf(file, "Operands: BOTH_DEFINED\n");
+                fprintf(file, "Expression: %s\n", ast_node_type_to_string((ASTNodeType)ast->kinds[ast->left[stmt]]));
                 fprintf(file, "Validation: PASSED\n");
+                print_constant_annotation(file, ast, stmt);
             }
             fprintf(file, "  \n");
         }
     }
     
+    // Full tree, in the Phase 2 format, for Phase 4 to reload
+    fprintf(file, "ANNOTATED_TREE:\n");
+    fprint_ast(file, ast, ast ? ast->root : NO_NODE, 0);
+    fprintf(file, "\n");
+    
     fprintf(file, "SEMANTIC_SUMMARY:\n");
     fprintf(file, "Symbols_Processed: %d\n", ctx->symbol_table->count);
     fprintf(file, "Errors_Found: %d\n", ctx->error_count);
     fprintf(file, "Warnings_Issued: %d\n", ctx->warning_count);
+    fprintf(file, "Constant_Statements: %d\n", ctx->constant_statements);
     fprintf(file, "Type_Safety: %s\n", ctx->error_count == 0 ? "GUARANTEED" : "VIOLATED");
     fprintf(file, "Analysis_Result: %s\n", ctx->error_count == 0 ? "SUCCESS" : "FAILED");
     fprintf(file, "\n");
     
     // Add symbol table reference
     fprintf(file, "SYMBOL_REFERENCES:\n");
-    for (int i = 0; i < ctx->symbol_table->size; i++) {
-        SymbolEntry* entry = ctx->symbol_table->table[i];
-        while (entry) {
-            fprintf(file, "%s:\n", entry->name);
-            fprintf(file, "Type: %s\n", symbol_type_to_string(entry->type));
-            fprintf(file, "Defined: %s\n", entry->is_defined ? "YES" : "NO");
-            fprintf(file, "Used: %s\n", entry->is_used ? "YES" : "NO");
-            fprintf(file, "Declaration_Line: %d\n", entry->line_declared);
-            if (entry->is_used && entry->line_used > 0) {
-                fprintf(file, "Usage_Line: %d\n", entry->line_used);
-            }
-            if (entry->type == SYM_BOOLEAN && entry->is_defined) {
-                fprintf(file, "    Value: %s\n", entry->value.bool_value ? "TRUE" : "FALSE");
-            }
-            fprintf(file, "\n");
-            entry = entry->next;
+    for (int i = 0; i < ctx->symbol_table->count; i++) {
+        const SymbolEntry* entry = &ctx->symbol_table->entries[i];
+        fprintf(file, "%s:\n", entry->name);
+        fprintf(file, "Type: %s\n", symbol_type_to_string(entry->type));
+        fprintf(file, "Defined: %s\n", entry->is_defined ? "YES" : "NO");
+        fprintf(file, "Used: %s\n", entry->is_used ? "YES" : "NO");
+        fprintf(file, "Declaration_Line: %d\n", entry->line_declared);
+        if (entry->is_used && entry->line_used > 0) {
+            fprintf(file, "Usage_Line: %d\n", entry->line_used);
         }
+        if (entry->type == SYM_BOOLEAN && entry->is_constant) {
+            fprintf(file, "    Value: %s\n", entry->value.bool_value ? "TRUE" : "FALSE");
+        }
+        fprintf(file, "\n");
     }
     
     fprintf(file, "# End of Semantically Annotated AST\n");
@@ -442,36 +734,39 @@ void print_semantic_summary(SemanticContext* ctx) {
 }
 
 // Infer expression type (enhanced implementation)
-SymbolType infer_expression_type(SemanticContext* ctx, ASTNode* node) {
-    if (!node) return SYM_UNKNOWN;
+SymbolType infer_expression_type(SemanticContext* ctx, const AST* ast, NodeIndex node) {
+    if (!ast || node == NO_NODE) return SYM_UNKNOWN;
     
-    switch (node->type) {
-        case 4:  // IDENTIFIER
+    switch ((ASTNodeType)ast->kinds[node]) {
+        case AST_IDENTIFIER:
             {
-                if (node->data.identifier) {
-                    SymbolEntry* entry = lookup_symbol(ctx->symbol_table, node->data.identifier);
+                if (ast->operands[node] != NO_SYMBOL) {
+                    SymbolEntry* entry = lookup_symbol(ctx->symbol_table, ast->operands[node]);
                     return entry ? entry->type : SYM_UNKNOWN;
                 }
                 return SYM_UNKNOWN;
             }
             
-        case 5:  // BOOLEAN LITERAL
+        case AST_BOOLEAN_LITERAL:
             return SYM_BOOLEAN;
             
-        case 6:  // AND
-        case 7:  // OR
-        case 8:  // NOT
-        case 9:  // XOR
-        case 10: // IMPLIES
-        case 11: // IFF
-        case 12: // EQUIV
+        case AST_AND:
+        case AST_OR:
+        case AST_NOT:
+        case AST_XOR:
+        case AST_XNOR:
+        case AST_IMPLIES:
+        case AST_IFF:
+        case AST_EQUIV:
+        case AST_EXISTS:
+        case AST_FORALL:
             return SYM_BOOLEAN;  // All logical operations result in boolean
             
-        case 2:  // ASSIGNMENT
+        case AST_ASSIGNMENT:
             // Assignment type depends on the value being assigned
-            return SYM_BOOLEAN;  // Assuming boolean assignments for our test case
+            return infer_expression_type(ctx, ast, ast->left[node]);
             
         default:
             return SYM_UNKNOWN;
     }
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 #define SEMANTIC_ANALYZER_H
 
 #include "symbol_table.h"
+#include "ast.h"  // Shared AST from Phase 2
 
 // Semantic error types
 typedef enum {
@@ -27,60 +28,40 @@ typedef struct {
     SemanticError* errors;
     int error_count;
     int warning_count;
-} SemanticContext;
-
-// AST Node structure (redefined for semantic analysis)
-typedef struct ASTNode {
-    int type;  // AST node type (from original AST)
-    char* node_type_str;  // String representation
-    int line_number;
     
-    // Semantic attributes
-    SymbolType semantic_type;
-    int is_constant;
-    int bool_value;  // For constant boolean expressions
-    
-    // Node data
-    union {
-        char* identifier;
-        int bool_literal;
-        struct {
-            char* variable;
-            struct ASTNode* value;
-        } assignment;
-        struct {
-            struct ASTNode* left;
-            struct ASTNode* right;
-        } binary;
-        struct {
-            struct ASTNode* operand;
-        } unary;
-        struct {
-            struct ASTNode** statements;
-            int count;
-        } program;
-    } data;
-    
-    struct ASTNode* parent;
-    struct ASTNode** children;
-    int child_count;
-} ASTNode;
+    // Constant folding scratch over the nodes a statement reaches, stamped
+    // per fold so it is never cleared, and the statements folded so far
+    uint32_t* fold_marks;
+    uint8_t* fold_values;       // FOLD_* bits per node
+    NodeIndex* fold_order;      // Reachable nodes, children first
+    NodeIndex* fold_stack;
+    uint32_t fold_capacity;     // Nodes the scratch covers
+    uint32_t fold_stamp;
+    SymbolId* bound;            // Variables quantifiers bind: a statement's, or all of them
+    uint32_t bound_count;
+    uint32_t bound_capacity;
+    int constant_statements;    // Expressions folded to a constant
+    int input_free_statements;  // ... that hold with run-time inputs
+} SemanticContext;
 
 // Function prototypes
 SemanticContext* create_semantic_context(void);
 void free_semantic_context(SemanticContext* ctx);
 
 // AST loading from file
-ASTNode* load_ast_from_file(const char* filename);
-void free_ast_node(ASTNode* node);
+AST* load_ast_from_file(const char* filename);
 
-// Semantic analysis functions
-int perform_semantic_analysis(SemanticContext* ctx, ASTNode* ast);
-void analyze_node(SemanticContext* ctx, ASTNode* node);
-void analyze_assignment(SemanticContext* ctx, ASTNode* node);
-void analyze_expression(SemanticContext* ctx, ASTNode* node);
-void analyze_binary_operation(SemanticContext* ctx, ASTNode* node);
-void analyze_identifier(SemanticContext* ctx, ASTNode* node);
+// Semantic analysis functions. Each statement is analyzed by a linear scan
+// over its post-order node range, so operands are always analyzed before
+// the node that uses them.
+int perform_semantic_analysis(SemanticContext* ctx, AST* ast);
+void analyze_statement(SemanticContext* ctx, AST* ast, uint32_t statement);
+void analyze_node(SemanticContext* ctx, AST* ast, NodeIndex node);
+void analyze_assignment(SemanticContext* ctx, AST* ast, NodeIndex node);
+void analyze_binary_operation(SemanticContext* ctx, AST* ast, NodeIndex node);
+void analyze_unary_operation(SemanticContext* ctx, AST* ast, NodeIndex node);
+void analyze_quantifier(SemanticContext* ctx, AST* ast, NodeIndex node);
+void analyze_identifier(SemanticContext* ctx, AST* ast, NodeIndex node);
 
 // Error handling
 void add_semantic_error(SemanticContext* ctx, SemanticErrorType type, 
@@ -89,11 +70,11 @@ void print_semantic_errors(SemanticContext* ctx);
 void print_semantic_errors_to_file(SemanticContext* ctx, const char* filename);
 
 // Output generation
-void generate_annotated_ast(SemanticContext* ctx, ASTNode* ast, const char* filename);
+void generate_annotated_ast(SemanticContext* ctx, const AST* ast, const char* filename);
 void print_semantic_summary(SemanticContext* ctx);
 
 // Utility functions
 const char* semantic_error_type_to_string(SemanticErrorType type);
-SymbolType infer_expression_type(SemanticContext* ctx, ASTNode* node);
+SymbolType infer_expression_type(SemanticContext* ctx, const AST* ast, NodeIndex node);
 
 #endif // SEMANTIC_ANALYZER_H
\ No newline at end of file
@@ -4,24 +4,85 @@
 
 #include "symbol_table.h"
 
-// Hash function for symbol names
-unsigned int hash_string(const char* str, int table_size) {
-    unsigned int hash = 5381;
-    int c;
+static void* table_alloc(void* block, size_t size) {
+    block = realloc(block, size);
+    if (!block) {
+        fprintf(stderr, "Out of memory for symbol table\n");
+        exit(1);
+    }
+    return block;
+}
+
+// Interned IDs are dense, so mix them before masking to spread neighbours
+static uint32_t symbol_hash(SymbolId id) {
+    uint32_t hash = id;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+// Distance of a slot from the home slot of the hash stored in it
+static uint32_t probe_distance(const SymbolTable* table, uint32_t hash, uint32_t slot) {
+    return (slot - hash) & table->slot_mask;
+}
+
+// Robin Hood insertion: an item probing further than the occupant takes
+// its slot, and the occupant moves on
+static void place_slot(SymbolTable* table, SymbolSlot item) {
+    uint32_t slot = item.hash & table->slot_mask;
+    uint32_t distance = 0;
     
-    while ((c = *str++)) {
-        hash = ((hash << 5) + hash) + c; // hash * 33 + c
+    while (table->slots[slot].entry != SYMBOL_SLOT_EMPTY) {
+        uint32_t occupant = probe_distance(table, table->slots[slot].hash, slot);
+        if (occupant < distance) {
+            SymbolSlot displaced = table->slots[slot];
+            table->slots[slot] = item;
+            item = displaced;
+            distance = occupant;
+        }
+        slot = (slot + 1) & table->slot_mask;
+        distance++;
+    }
+    table->slots[slot] = item;
+}
+
+static void allocate_slots(SymbolTable* table, uint32_t slot_count) {
+    table->slots = table_alloc(NULL, slot_count * sizeof(SymbolSlot));
+    for (uint32_t i = 0; i < slot_count; i++) {
+        table->slots[i].entry = SYMBOL_SLOT_EMPTY;
     }
+    table->slot_mask = slot_count - 1;
+}
+
+// Double the index, re-placing slots by their cached hashes
+static void grow_slots(SymbolTable* table) {
+    SymbolSlot* old_slots = table->slots;
+    uint32_t old_count = table->slot_mask + 1;
     
-    return hash % table_size;
+    allocate_slots(table, old_count * 2);
+    for (uint32_t i = 0; i < old_count; i++) {
+        if (old_slots[i].entry != SYMBOL_SLOT_EMPTY) {
+            place_slot(table, old_slots[i]);
+        }
+    }
+    free(old_slots);
 }
 
-// Create symbol table
-SymbolTable* create_symbol_table(int size) {
-    SymbolTable* table = malloc(sizeof(SymbolTable));
-    table->table = calloc(size, sizeof(SymbolEntry*));
-    table->size = size;
+// Create symbol table sized for expected_symbols without resizing
+SymbolTable* create_symbol_table(int expected_symbols) {
+    SymbolTable* table = table_alloc(NULL, sizeof(SymbolTable));
+    uint32_t slot_count = 16;
+    while (slot_count * 3 < (uint32_t)expected_symbols * 4) {
+        slot_count *= 2;
+    }
+    
+    table->capacity = expected_symbols > 0 ? expected_symbols : 1;
+    table->entries = table_alloc(NULL, table->capacity * sizeof(SymbolEntry));
     table->count = 0;
+    allocate_slots(table, slot_count);
     return table;
 }
 
@@ -29,58 +90,72 @@ SymbolTable* create_symbol_table(int size) {
 void free_symbol_table(SymbolTable* table) {
     if (!table) return;
     
-    for (int i = 0; i < table->size; i++) {
-        SymbolEntry* entry = table->table[i];
-        while (entry) {
-            SymbolEntry* next = entry->next;
-            free(entry->name);
-            if (entry->type != SYM_BOOLEAN && entry->value.str_value) {
-                free(entry->value.str_value);
-            }
-            free(entry);
-            entry = next;
+    for (int i = 0; i < table->count; i++) {
+        SymbolEntry* entry = &table->entries[i];
+        if (entry->type != SYM_BOOLEAN && entry->value.str_value) {
+            free(entry->value.str_value);
         }
     }
     
-    free(table->table);
+    free(table->entries);
+    free(table->slots);
     free(table);
 }
 
-// Lookup symbol in table
-SymbolEntry* lookup_symbol(SymbolTable* table, const char* name) {
-    if (!table || !name) return NULL;
+// Lookup symbol in table; a probe stops once it has gone further than
+// the occupant of the slot, which Robin Hood ordering makes conclusive
+SymbolEntry* lookup_symbol(SymbolTable* table, SymbolId id) {
+    if (!table || id == NO_SYMBOL) return NULL;
     
-    unsigned int index = hash_string(name, table->size);
-    SymbolEntry* entry = table->table[index];
+    uint32_t hash = symbol_hash(id);
+    uint32_t slot = hash & table->slot_mask;
+    uint32_t distance = 0;
     
-    while (entry) {
-        if (strcmp(entry->name, name) == 0) {
-            return entry;
+    for (;;) {
+        const SymbolSlot* candidate = &table->slots[slot];
+        if (candidate->entry == SYMBOL_SLOT_EMPTY ||
+            probe_distance(table, candidate->hash, slot) < distance) {
+            return NULL;
         }
-        entry = entry->next;
+        if (candidate->hash == hash && table->entries[candidate->entry].id == id) {
+            return &table->entries[candidate->entry];
+        }
+        slot = (slot + 1) & table->slot_mask;
+        distance++;
     }
-    
-    return NULL;
 }
 
 // Insert symbol into table
-SymbolEntry* insert_symbol(SymbolTable* table, const char* name, SymbolType type, int line) {
-    if (!table || !name) return NULL;
+SymbolEntry* insert_symbol(SymbolTable* table, SymbolId id, SymbolType type, int line) {
+    if (!table || id == NO_SYMBOL) return NULL;
     
     // Check if symbol already exists
-    SymbolEntry* existing = lookup_symbol(table, name);
+    SymbolEntry* existing = lookup_symbol(table, id);
     if (existing) {
         return existing;  // Return existing entry
     }
     
+    // Keep the index at most 3/4 full
+    if ((uint64_t)(table->count + 1) * 4 > (uint64_t)(table->slot_mask + 1) * 3) {
+        grow_slots(table);
+    }
+    if (table->count == table->capacity) {
+        table->capacity *= 2;
+        table->entries = table_alloc(table->entries, table->capacity * sizeof(SymbolEntry));
+    }
+    
     // Create new entry
-    SymbolEntry* entry = malloc(sizeof(SymbolEntry));
-    entry->name = strdup(name);
+    SymbolEntry* entry = &table->entries[table->count];
+    entry->id = id;
+    entry->name = symbol_name(id);
     entry->type = type;
     entry->is_defined = 0;
     entry->is_used = 0;
     entry->line_declared = line;
     entry->line_used = -1;
+    entry->assignments = 0;
+    entry->is_constant = 0;
+    entry->input_free = 0;
     
     // Initialize value
     if (type == SYM_BOOLEAN) {
@@ -89,18 +164,17 @@ SymbolEntry* insert_symbol(SymbolTable* table, const char* name, SymbolType type
         entry->value.str_value = NULL;
     }
     
-    // Insert into hash table
-    unsigned int index = hash_string(name, table->size);
-    entry->next = table->table[index];
-    table->table[index] = entry;
+    // Index it
+    SymbolSlot slot = { symbol_hash(id), (uint32_t)table->count };
+    place_slot(table, slot);
     table->count++;
     
     return entry;
 }
 
 // Mark symbol as used
-void mark_symbol_used(SymbolTable* table, const char* name, int line) {
-    SymbolEntry* entry = lookup_symbol(table, name);
+void mark_symbol_used(SymbolTable* table, SymbolId id, int line) {
+    SymbolEntry* entry = lookup_symbol(table, id);
     if (entry) {
         if (!entry->is_used) {
             entry->is_used = 1;
@@ -110,8 +184,8 @@ void mark_symbol_used(SymbolTable* table, const char* name, int line) {
 }
 
 // Set symbol value
-void set_symbol_value(SymbolTable* table, const char* name, int bool_val, int line) {
-    SymbolEntry* entry = lookup_symbol(table, name);
+void set_symbol_value(SymbolTable* table, SymbolId id, int bool_val, int line) {
+    SymbolEntry* entry = lookup_symbol(table, id);
     if (entry) {
         entry->is_defined = 1;
         entry->line_declared = line;
@@ -140,31 +214,25 @@ void print_symbol_table(SymbolTable* table) {
            "Name", "Type", "Defined", "Used", "Decl", "Use", "Value");
     printf("────────────────────────────────────────────────────────────────\n");
     
-    int displayed = 0;
-    for (int i = 0; i < table->size; i++) {
-        SymbolEntry* entry = table->table[i];
-        while (entry) {
-            printf("%-12s %-10s %-8s %-8s %-6d %-6d", 
-                   entry->name,
-                   symbol_type_to_string(entry->type),
-                   entry->is_defined ? "Yes" : "No",
-                   entry->is_used ? "Yes" : "No",
-                   entry->line_declared,
-                   entry->line_used > 0 ? entry->line_used : 0);
-            
-            if (entry->type == SYM_BOOLEAN && entry->is_defined) {
-                printf(" %s", entry->value.bool_value ? "TRUE" : "FALSE");
-            } else {
-                printf(" --");
-            }
-            printf("\n");
-            
-            entry = entry->next;
-            displayed++;
+    for (int i = 0; i < table->count; i++) {
+        const SymbolEntry* entry = &table->entries[i];
+        printf("%-12s %-10s %-8s %-8s %-6d %-6d", 
+               entry->name,
+               symbol_type_to_string(entry->type),
+               entry->is_defined ? "Yes" : "No",
+               entry->is_used ? "Yes" : "No",
+               entry->line_declared,
+               entry->line_used > 0 ? entry->line_used : 0);
+        
+        if (entry->type == SYM_BOOLEAN && entry->is_constant) {
+            printf(" %s", entry->value.bool_value ? "TRUE" : "FALSE");
+        } else {
+            printf(" --");
         }
+        printf("\n");
     }
     
-    if (displayed == 0) {
+    if (table->count == 0) {
         printf("(No symbols found)\n");
     }
     
@@ -188,26 +256,22 @@ void print_symbol_table_to_file(SymbolTable* table, const char* filename) {
             "Name", "Type", "Defined", "Used", "Decl", "Use", "Value");
     fprintf(file, "────────────────────────────────────────────────────────────────\n");
     
-    for (int i = 0; i < table->size; i++) {
-        SymbolEntry* entry = table->table[i];
-        while (entry) {
-            fprintf(file, "%-12s %-10s %-8s %-8s %-6d %-6d", 
-                    entry->name,
-                    symbol_type_to_string(entry->type),
-                    entry->is_defined ? "Yes" : "No",
-                    entry->is_used ? "Yes" : "No",
-                    entry->line_declared,
-                    entry->line_used > 0 ? entry->line_used : 0);
-            
-            if (entry->type == SYM_BOOLEAN && entry->is_defined) {
-                fprintf(file, " %s", entry->value.bool_value ? "TRUE" : "FALSE");
-            } else {
-                fprintf(file, " --");
-            }
-            fprintf(file, "\n");
-            
-            entry = entry->next;
+    for (int i = 0; i < table->count; i++) {
+        const SymbolEntry* entry = &table->entries[i];
+        fprintf(file, "%-12s %-10s %-8s %-8s %-6d %-6d", 
+                entry->name,
+                symbol_type_to_string(entry->type),
+                entry->is_defined ? "Yes" : "No",
+                entry->is_used ? "Yes" : "No",
+                entry->line_declared,
+                entry->line_used > 0 ? entry->line_used : 0);
+        
+        if (entry->type == SYM_BOOLEAN && entry->is_constant) {
+            fprintf(file, " %s", entry->value.bool_value ? "TRUE" : "FALSE");
+        } else {
+            fprintf(file, " --");
         }
+        fprintf(file, "\n");
     }
     
     fprintf(file, "\nTotal symbols: %d\n", table->count);
@@ -218,13 +282,9 @@ void print_symbol_table_to_file(SymbolTable* table, const char* filename) {
 int check_undefined_symbols(SymbolTable* table) {
     int undefined_count = 0;
     
-    for (int i = 0; i < table->size; i++) {
-        SymbolEntry* entry = table->table[i];
-        while (entry) {
-            if (entry->is_used && !entry->is_defined) {
-                undefined_count++;
-            }
-            entry = entry->next;
+    for (int i = 0; i < table->count; i++) {
+        if (table->entries[i].is_used && !table->entries[i].is_defined) {
+            undefined_count++;
         }
     }
     
@@ -235,13 +295,9 @@ int check_undefined_symbols(SymbolTable* table) {
 int check_unused_symbols(SymbolTable* table) {
     int unused_count = 0;
     
-    for (int i = 0; i < table->size; i++) {
-        SymbolEntry* entry = table->table[i];
-        while (entry) {
-            if (entry->is_defined && !entry->is_used) {
-                unused_count++;
-            }
-            entry = entry->next;
+    for (int i = 0; i < table->count; i++) {
+        if (table->entries[i].is_defined && !table->entries[i].is_used) {
+            unused_count++;
         }
     }
     
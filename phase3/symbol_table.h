@@ -4,6 +4,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include "intern.h"
 
 // Symbol types
 typedef enum {
@@ -16,38 +18,57 @@ typedef enum {
 
 // Symbol table entry
 typedef struct SymbolEntry {
-    char* name;
+    SymbolId id;           // Interned name (the table key)
+    const char* name;      // symbol_name(id), kept for reports
     SymbolType type;
     int is_defined;         // Has been assigned a value
     int is_used;           // Has been referenced
     int line_declared;     // Line where first declared/assigned
     int line_used;         // Line where first used
+    int assignments;       // Assignments analyzed so far
+    
+    // Constant propagation state after the latest assignment (phase 3
+    // folding): is_constant when the value is known, input_free when it is
+    // known even with the inputs supplied at run time
+    int is_constant;
+    int input_free;
     
     // Value information
     union {
         int bool_value;    // For boolean variables
         char* str_value;   // For other types
     } value;
-    
-    struct SymbolEntry* next;  // For hash table chaining
 } SymbolEntry;
 
-// Symbol table structure
+#define SYMBOL_SLOT_EMPTY UINT32_MAX
+
+// Index slot: the cached hash of an entry's ID and the entry's position
+typedef struct {
+    uint32_t hash;
+    uint32_t entry;        // Index into entries, SYMBOL_SLOT_EMPTY if free
+} SymbolSlot;
+
+// Symbol table: entries are stored contiguously in insertion order, so
+// reports and checks are linear scans; a Robin Hood open-addressing index
+// over them doubles when it is 3/4 full. Entry pointers stay valid until
+// the next insert_symbol.
 typedef struct {
-    SymbolEntry** table;
-    int size;
+    SymbolEntry* entries;
     int count;
+    int capacity;          // Entries allocated
+    SymbolSlot* slots;
+    uint32_t slot_mask;    // Slot count - 1 (a power of two)
 } SymbolTable;
 
 // Function prototypes
-SymbolTable* create_symbol_table(int size);
+SymbolTable* create_symbol_table(int expected_symbols);
 void free_symbol_table(SymbolTable* table);
 
 // Symbol operations
-SymbolEntry* lookup_symbol(SymbolTable* table, const char* name);
-SymbolEntry* insert_symbol(SymbolTable* table, const char* name, SymbolType type, int line);
-void mark_symbol_used(SymbolTable* table, const char* name, int line);
-void set_symbol_value(SymbolTable* table, const char* name, int bool_val, int line);
+SymbolEntry* lookup_symbol(SymbolTable* table, SymbolId id);
+SymbolEntry* insert_symbol(SymbolTable* table, SymbolId id, SymbolType type, int line);
+void mark_symbol_used(SymbolTable* table, SymbolId id, int line);
+void set_symbol_value(SymbolTable* table, SymbolId id, int bool_val, int line);
 
 // Analysis functions
 void print_symbol_table(SymbolTable* table);
@@ -57,6 +78,5 @@ int check_unused_symbols(SymbolTable* table);
 
 // Utility functions
 const char* symbol_type_to_string(SymbolType type);
-unsigned int hash_string(const char* str, int table_size);
 
 #endif // SYMBOL_TABLE_H
\ No newline at end of file
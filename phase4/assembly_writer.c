@@ -5,16 +5,16 @@
 #include "code_generator.h"
 
 // Forward declarations for instruction writers
-void write_x86_64_instruction(FILE* file, Instruction* inst, char operand_strs[][64]);
-void write_arm64_instruction(FILE* file, Instruction* inst, char operand_strs[][64]);
-void write_generic_instruction(FILE* file, Instruction* inst, char operand_strs[][64]);
+void write_x86_64_instruction(FILE* file, const Instruction* inst, char operand_strs[][64], const char* comment);
+void write_arm64_instruction(FILE* file, const Instruction* inst, char operand_strs[][64], const char* comment);
+void write_generic_instruction(FILE* file, const Instruction* inst, char operand_strs[][64], const char* comment);
 
 // Write assembly file header
 void write_assembly_header(FILE* file, TargetArch target) {
     fprintf(file, "# Assembly code generated by Roadmap Compiler Phase 4\n");
     fprintf(file, "# Target Architecture: %s\n", 
             target == TARGET_X86_64 ? "x86_64" : "ARM64");
-    fprintf(file, "# Source: Logical expressions (B = TRUE, C = FALSE, B OR C)\n");
+    fprintf(file, "# Variables: bits of flag words in the stack frame at RBX\n");
     fprintf(file, "#\n\n");
     
     if (target == TARGET_X86_64) {
@@ -50,50 +50,9 @@ void write_assembly_footer(FILE* file, TargetArch target) {
     }
 }
 
-// Write data section for variables
-void write_data_section(FILE* file, CodeGenContext* ctx) {
-    if (!ctx->symbol_map) return;
-    
-    fprintf(file, "\n# Data section for boolean variables\n");
-    fprintf(file, ".section .data\n");
-    
-    struct SymbolMap* sym = ctx->symbol_map;
-    while (sym) {
-        if (ctx->target == TARGET_X86_64) {
-            fprintf(file, "    %-8s: .quad 0    # Boolean variable %s\n", 
-                    sym->name, sym->name);
-        } else if (ctx->target == TARGET_ARM64) {
-            fprintf(file, "    %-8s: .dword 0   # Boolean variable %s\n", 
-                    sym->name, sym->name);
-        }
-        sym = sym->next;
-    }
-    fprintf(file, "\n");
-}
-
-// Write BSS section for uninitialized variables
-void write_bss_section(FILE* file, CodeGenContext* ctx) {
-    if (!ctx->symbol_map) return;
-    
-    fprintf(file, "# BSS section for uninitialized variables\n");
-    fprintf(file, ".section .bss\n");
-    
-    struct SymbolMap* sym = ctx->symbol_map;
-    while (sym) {
-        if (ctx->target == TARGET_X86_64) {
-            fprintf(file, "    .lcomm %s_storage, 8    # Storage for %s\n", 
-                    sym->name, sym->name);
-        } else if (ctx->target == TARGET_ARM64) {
-            fprintf(file, "    .lcomm %s_storage, 4    # Storage for %s\n", 
-                    sym->name, sym->name);
-        }
-        sym = sym->next;
-    }
-    fprintf(file, "\n");
-}
-
 // Format operand for assembly output
-void format_operand(char* buffer, size_t size, Operand* op, TargetArch target) {
+void format_operand(char* buffer, size_t size, const CodeGenContext* ctx, const Operand* op) {
+    TargetArch target = ctx->target;
     switch (op->type) {
         case OPERAND_REGISTER:
             if (target == TARGET_X86_64) {
@@ -137,7 +96,7 @@ void format_operand(char* buffer, size_t size, Operand* op, TargetArch target) {
             break;
             
         case OPERAND_LABEL:
-            snprintf(buffer, size, "%s", op->value.label);
+            snprintf(buffer, size, "%s", label_name(ctx, op->value.label));
             break;
             
         default:
@@ -146,37 +105,51 @@ void format_operand(char* buffer, size_t size, Operand* op, TargetArch target) {
     }
 }
 
+// Low byte of a 64-bit register, as movb stores it
+static const char* byte_register_name(Register reg) {
+    static const char* names[] = {
+        "al", "bl", "cl", "dl", "sil", "dil", "r8b", "r9b",
+        "r10b", "r11b", "r12b", "r13b", "r14b", "r15b", "spl"
+    };
+    return reg < REG_COUNT ? names[reg] : "al";
+}
+
 // Write single instruction
-void write_instruction(FILE* file, Instruction* inst, TargetArch target) {
+void write_instruction(FILE* file, const CodeGenContext* ctx, const Instruction* inst) {
     if (inst->type == INST_LABEL) {
-        fprintf(file, "%s:\n", inst->operands[0].value.label);
+        fprintf(file, "%s:\n", label_name(ctx, (uint32_t)inst->values[0]));
         return;
     }
     
     char operand_strs[3][64];
+    const char* comment = instruction_comment(ctx, inst);
     
     // Format operands
     for (int i = 0; i < inst->operand_count; i++) {
-        format_operand(operand_strs[i], sizeof(operand_strs[i]), 
-                      &inst->operands[i], target);
+        Operand op = instruction_operand(inst, i);
+        format_operand(operand_strs[i], sizeof(operand_strs[i]), ctx, &op);
+    }
+    if (inst->type == INST_MOVB && inst->kinds[1] == OPERAND_REGISTER && ctx->target == TARGET_X86_64) {
+        snprintf(operand_strs[1], sizeof(operand_strs[1]), "%%%s",
+                 byte_register_name((Register)inst->values[1]));
     }
     
     // Write instruction with proper syntax for target architecture
-    if (target == TARGET_X86_64) {
-        write_x86_64_instruction(file, inst, operand_strs);
-    } else if (target == TARGET_ARM64) {
-        write_arm64_instruction(file, inst, operand_strs);
+    if (ctx->target == TARGET_X86_64) {
+        write_x86_64_instruction(file, inst, operand_strs, comment);
+    } else if (ctx->target == TARGET_ARM64) {
+        write_arm64_instruction(file, inst, operand_strs, comment);
     } else {
-        write_generic_instruction(file, inst, operand_strs);
+        write_generic_instruction(file, inst, operand_strs, comment);
     }
 }
 
 // Write x86_64 specific instruction
-void write_x86_64_instruction(FILE* file, Instruction* inst, char operand_strs[][64]) {
-    const char* mnemonic = instruction_to_string(inst->type);
+void write_x86_64_instruction(FILE* file, const Instruction* inst, char operand_strs[][64], const char* comment) {
+    const char* mnemonic = instruction_to_string((InstructionType)inst->type);
     
     // Handle special x86_64 instruction formatting
-    switch (inst->type) {
+    switch ((InstructionType)inst->type) {
         case INST_MOV:
             if (inst->operand_count == 2) {
                 fprintf(file, "    movq     %s, %s", operand_strs[1], operand_strs[0]);
@@ -219,6 +192,50 @@ void write_x86_64_instruction(FILE* file, Instruction* inst, char operand_strs[]
             }
             break;
             
+        case INST_SHL:
+            if (inst->operand_count == 2) {
+                fprintf(file, "    shlq     %s, %s", operand_strs[1], operand_strs[0]);
+            }
+            break;
+            
+        case INST_SHR:
+            if (inst->operand_count == 2) {
+                fprintf(file, "    shrq     %s, %s", operand_strs[1], operand_strs[0]);
+            }
+            break;
+            
+        case INST_BTS:
+            if (inst->operand_count == 2) {
+                fprintf(file, "    btsq     %s, %s", operand_strs[1], operand_strs[0]);
+            }
+            break;
+            
+        case INST_BTR:
+            if (inst->operand_count == 2) {
+                fprintf(file, "    btrq     %s, %s", operand_strs[1], operand_strs[0]);
+            }
+            break;
+            
+        case INST_MOVZB:
+            if (inst->operand_count == 2) {
+                fprintf(file, "    movzbq   %s, %s", operand_strs[1], operand_strs[0]);
+            }
+            break;
+            
+        case INST_MOVB:
+            if (inst->operand_count == 2) {
+                fprintf(file, "    movb     %s, %s", operand_strs[1], operand_strs[0]);
+            }
+            break;
+            
+        case INST_NEG:
+            fprintf(file, "    negq     %s", operand_strs[0]);
+            break;
+            
+        case INST_NOT:
+            fprintf(file, "    notq     %s", operand_strs[0]);
+            break;
+            
         case INST_PUSH:
             fprintf(file, "    pushq    %s", operand_strs[0]);
             break;
@@ -235,6 +252,10 @@ void write_x86_64_instruction(FILE* file, Instruction* inst, char operand_strs[]
             fprintf(file, "    ret");
             break;
             
+        case INST_SYSCALL:
+            fprintf(file, "    syscall");
+            break;
+            
         case INST_JMP:
             fprintf(file, "    jmp      %s", operand_strs[0]);
             break;
@@ -256,19 +277,19 @@ void write_x86_64_instruction(FILE* file, Instruction* inst, char operand_strs[]
     }
     
     // Add comment if present
-    if (inst->comment) {
-        fprintf(file, "    # %s", inst->comment);
+    if (comment) {
+        fprintf(file, "    # %s", comment);
     }
     
     fprintf(file, "\n");
 }
 
 // Write ARM64 specific instruction
-void write_arm64_instruction(FILE* file, Instruction* inst, char operand_strs[][64]) {
+void write_arm64_instruction(FILE* file, const Instruction* inst, char operand_strs[][64], const char* comment) {
     const char* mnemonic;
     
     // Map x86 instructions to ARM64 equivalents
-    switch (inst->type) {
+    switch ((InstructionType)inst->type) {
         case INST_MOV:
             mnemonic = "mov";
             break;
@@ -290,15 +311,21 @@ void write_arm64_instruction(FILE* file, Instruction* inst, char operand_strs[][
         case INST_CMP:
             mnemonic = "cmp";
             break;
+        case INST_SHL:
+            mnemonic = "lsl";
+            break;
+        case INST_SHR:
+            mnemonic = "lsr";
+            break;
         case INST_RET:
             fprintf(file, "    ret");
-            if (inst->comment) {
-                fprintf(file, "      // %s", inst->comment);
+            if (comment) {
+                fprintf(file, "      // %s", comment);
             }
             fprintf(file, "\n");
             return;
         default:
-            mnemonic = instruction_to_string(inst->type);
+            mnemonic = instruction_to_string((InstructionType)inst->type);
             break;
     }
     
@@ -307,31 +334,31 @@ void write_arm64_instruction(FILE* file, Instruction* inst, char operand_strs[][
         fprintf(file, "%s%s", i == 0 ? " " : ", ", operand_strs[i]);
     }
     
-    if (inst->comment) {
-        fprintf(file, "    // %s", inst->comment);
+    if (comment) {
+        fprintf(file, "    // %s", comment);
     }
     
     fprintf(file, "\n");
 }
 
 // Write generic instruction (fallback)
-void write_generic_instruction(FILE* file, Instruction* inst, char operand_strs[][64]) {
-    fprintf(file, "    %-8s", instruction_to_string(inst->type));
+void write_generic_instruction(FILE* file, const Instruction* inst, char operand_strs[][64], const char* comment) {
+    fprintf(file, "    %-8s", instruction_to_string((InstructionType)inst->type));
     
     for (int i = 0; i < inst->operand_count; i++) {
         fprintf(file, "%s%s", i == 0 ? " " : ", ", operand_strs[i]);
     }
     
     // Add comment if present
-    if (inst->comment) {
-        fprintf(file, "    # %s", inst->comment);
+    if (comment) {
+        fprintf(file, "    # %s", comment);
     }
     
     fprintf(file, "\n");
 }
 
 // Main assembly generation function
-int generate_assembly(CodeGenContext* ctx, ASTNode* ast, const char* output_file) {
+int generate_assembly(CodeGenContext* ctx, const AST* ast, const char* output_file) {
     if (!ctx || !ast) return -1;
     
     printf("┌─ CODE GENERATION\n");
@@ -341,22 +368,17 @@ int generate_assembly(CodeGenContext* ctx, ASTNode* ast, const char* output_file
     printf("│ Output: %s\n", output_file);
     printf("│\n");
     
-    // Generate intermediate representation
+    // Generate intermediate representation on virtual registers, map
+    // them onto physical registers and spill slots, then clean up
     generate_program(ctx, ast);
+    allocate_registers(ctx);
+    optimize_peephole(ctx);
     
     printf("│\n");
     printf("│ Generated %d assembly instructions\n", ctx->instruction_count);
-    printf("│ Symbol table contains %d variables\n", 
-           ctx->symbol_map ? 1 : 0); // Count symbols
-    
-    // Count actual symbols
-    int symbol_count = 0;
-    struct SymbolMap* sym = ctx->symbol_map;
-    while (sym) {
-        symbol_count++;
-        sym = sym->next;
-    }
-    printf("│ Variables allocated: %d\n", symbol_count);
+    printf("│ Symbol table contains %d variables\n", ctx->symbol_count);
+    printf("│ Variables allocated: %d (%d flag words)\n", ctx->symbol_count, ctx->variable_size / 8);
+    printf("│ Spilled temporaries: %d\n", ctx->spill_count);
     printf("│ Stack space required: %d bytes\n", ctx->stack_offset);
     printf("│\n");
     printf("└─\n\n");
@@ -375,38 +397,32 @@ int generate_assembly(CodeGenContext* ctx, ASTNode* ast, const char* output_file
     write_assembly_header(file, ctx->target);
     printf("│ ✓ Header and entry point written\n");
     
+    // Reserve the variable frame below the entry stack pointer
+    if (ctx->target == TARGET_X86_64 && ctx->stack_offset > 0) {
+        fprintf(file, "    movq     %%rsp, %%rbx    # Variable frame base\n");
+        fprintf(file, "    subq     $%d, %%rsp\n", ctx->stack_offset);
+    }
+    
     // Write main code
     fprintf(file, "    # Generated code begins\n");
-    Instruction* inst = ctx->instructions;
-    int inst_count = 0;
-    
-    while (inst) {
-        write_instruction(file, inst, ctx->target);
-        inst = inst->next;
-        inst_count++;
+    for (int i = 0; i < ctx->instruction_count; i++) {
+        write_instruction(file, ctx, &ctx->instructions[i]);
     }
     
-    printf("│ ✓ %d instructions written\n", inst_count);
+    printf("│ ✓ %d instructions written\n", ctx->instruction_count);
     
     // Write footer
     write_assembly_footer(file, ctx->target);
     printf("│ ✓ System exit code written\n");
     
-    // Write data section if we have symbols
-    if (ctx->symbol_map) {
-        write_data_section(file, ctx);
-        printf("│ ✓ Data section written (%d variables)\n", symbol_count);
-    }
-    
-    // Write BSS section for debugging
-    if (ctx->symbol_map) {
+    // Variables live in the frame, so there is no data section; list
+    // where each one is for reading
+    if (ctx->symbol_count > 0) {
         fprintf(file, "\n# Debug information\n");
         fprintf(file, "# Variables used in this program:\n");
-        sym = ctx->symbol_map;
-        while (sym) {
-            fprintf(file, "#   %s (offset: -%d from RBP)\n", 
-                    sym->name, sym->stack_offset);
-            sym = sym->next;
+        for (int i = 0; i < ctx->symbol_count; i++) {
+            fprintf(file, "#   %s (offset: -%d from RBX, bit %d)\n", 
+                    ctx->symbols[i].name, ctx->symbols[i].stack_offset, ctx->symbols[i].bit);
         }
     }
     
@@ -0,0 +1,334 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "code_generator.h"
+
+// Batch evaluation kernels. The caller passes a buffer of blocks, each
+// holding one 32-byte lane per variable in symbol order; bit r of a lane
+// is the variable's value in record r of the block, so a block is 256
+// records. The kernel reads the input lanes and overwrites the others with
+// the program's results, block by block:
+//
+//     void logic_batch(void* lanes, size_t blocks);
+//
+// The program is compiled twice through the normal pipeline. In AVX2 mode
+// each value is a ymm register and AND, OR, XOR and NOT map to vpand,
+// vpor, vpxor and vpandn; the scalar fallback evaluates each lane as four
+// 64-bit columns with the general-purpose registers. logic_batch picks one
+// with cpuid on its first call and points logic_batch_kernel_name at
+// "AVX2" or "scalar". Read-only tables describe the lanes for a runtime
+// linked against the kernels (stream_runtime.c): their count, how many are
+// inputs, a flag per lane and the lane names, NUL-separated.
+
+#define BATCH_FUNCTION "logic_batch"
+
+// ymm registers outside the allocator's range, holding the all-zero and
+// all-one lanes that stand in for FALSE and TRUE
+#define YMM_ZERO 14
+#define YMM_ONES 15
+
+// Run code generation, register allocation and the peephole pass for one
+// kernel variant; NULL if an input is assigned again
+static CodeGenContext* compile_kernel(const AST* ast, CodeGenMode mode, int peephole_window) {
+    CodeGenContext* ctx = create_codegen_context(TARGET_X86_64);
+    ctx->mode = mode;
+    ctx->peephole_window = peephole_window;
+    if (mode == CODEGEN_BATCH_AVX2) {
+        ctx->slot_size = BATCH_LANE_BYTES;
+    } else {
+        ctx->reserved_registers = 1u << REG_RDI; // Lane pointer
+    }
+
+    printf("│ %s kernel\n", mode == CODEGEN_BATCH_AVX2 ? "AVX2" : "Scalar");
+    generate_program(ctx, ast);
+    if (ctx->failed) {
+        free_codegen_context(ctx);
+        return NULL;
+    }
+    allocate_registers(ctx);
+    optimize_peephole(ctx);
+    printf("│   %d instructions, %d spilled, %d bytes of stack\n", ctx->instruction_count,
+           ctx->spill_count, ctx->stack_offset);
+    printf("│\n");
+    return ctx;
+}
+
+// Format an operand of AVX2 code: registers are ymm, 0/1 immediates the
+// constant lanes
+static void format_lane_operand(char* buffer, size_t size, const Instruction* inst, int index) {
+    switch ((OperandType)inst->kinds[index]) {
+        case OPERAND_REGISTER:
+            snprintf(buffer, size, "%%ymm%d", inst->values[index]);
+            break;
+        case OPERAND_IMMEDIATE:
+            snprintf(buffer, size, "%%ymm%d", inst->values[index] ? YMM_ONES : YMM_ZERO);
+            break;
+        case OPERAND_MEMORY:
+            snprintf(buffer, size, "%d(%%%s)", inst->values[index],
+                     register_to_string((Register)inst->bases[index], TARGET_X86_64));
+            break;
+        default:
+            snprintf(buffer, size, "UNKNOWN_OPERAND");
+            break;
+    }
+}
+
+// Write one instruction of the AVX2 kernel; returns -1 if it has no AVX2 form
+static int write_avx2_instruction(FILE* file, const CodeGenContext* ctx, const Instruction* inst) {
+    char ops[2][64];
+    for (int i = 0; i < inst->operand_count && i < 2; i++) {
+        format_lane_operand(ops[i], sizeof(ops[i]), inst, i);
+    }
+
+    switch ((InstructionType)inst->type) {
+        case INST_MOV: {
+            int aligned = inst->kinds[0] != OPERAND_MEMORY && inst->kinds[1] != OPERAND_MEMORY;
+            fprintf(file, "    %-8s %s, %s", aligned ? "vmovdqa" : "vmovdqu", ops[1], ops[0]);
+            break;
+        }
+        case INST_AND:
+            fprintf(file, "    vpand    %s, %s, %s", ops[1], ops[0], ops[0]);
+            break;
+        case INST_OR:
+            fprintf(file, "    vpor     %s, %s, %s", ops[1], ops[0], ops[0]);
+            break;
+        case INST_XOR:
+            fprintf(file, "    vpxor    %s, %s, %s", ops[1], ops[0], ops[0]);
+            break;
+        case INST_ANDN:
+            // vpandn complements its middle operand
+            fprintf(file, "    vpandn   %s, %s, %s", ops[0], ops[1], ops[0]);
+            break;
+        case INST_NOT:
+            fprintf(file, "    vpxor    %%ymm%d, %s, %s", YMM_ONES, ops[0], ops[0]);
+            break;
+        default:
+            fprintf(stderr, "Error: no AVX2 form for %s\n",
+                    instruction_to_string((InstructionType)inst->type));
+            return -1;
+    }
+
+    const char* comment = instruction_comment(ctx, inst);
+    if (comment) {
+        fprintf(file, "    # %s", comment);
+    }
+    fprintf(file, "\n");
+    return 0;
+}
+
+static void write_function_start(FILE* file, const char* name) {
+    fprintf(file, "\n    .globl   %s\n", name);
+    fprintf(file, "    .type    %s, @function\n", name);
+    fprintf(file, "%s:\n", name);
+}
+
+static void write_function_end(FILE* file, const char* name) {
+    fprintf(file, "    .size    %s, .-%s\n", name, name);
+}
+
+// AVX2 kernel: RDI walks the blocks, RSI counts them down
+static int write_avx2_kernel(FILE* file, const CodeGenContext* ctx, int stride) {
+    const char* name = BATCH_FUNCTION "_avx2";
+    write_function_start(file, name);
+    fprintf(file, "    pushq    %%rbx\n");
+    fprintf(file, "    movq     %%rsp, %%rbx    # Spill slot base\n");
+    if (ctx->stack_offset > 0) {
+        fprintf(file, "    subq     $%d, %%rsp\n", ctx->stack_offset);
+    }
+    fprintf(file, "    testq    %%rsi, %%rsi\n");
+    fprintf(file, "    jz       .L%s_done\n", name);
+    fprintf(file, "    vpxor    %%ymm%d, %%ymm%d, %%ymm%d    # FALSE lane\n", YMM_ZERO, YMM_ZERO, YMM_ZERO);
+    fprintf(file, "    vpcmpeqd %%ymm%d, %%ymm%d, %%ymm%d    # TRUE lane\n", YMM_ONES, YMM_ONES, YMM_ONES);
+    fprintf(file, ".L%s_block:\n", name);
+    for (int i = 0; i < ctx->instruction_count; i++) {
+        if (write_avx2_instruction(file, ctx, &ctx->instructions[i]) != 0) return -1;
+    }
+    fprintf(file, "    addq     $%d, %%rdi\n", stride);
+    fprintf(file, "    subq     $1, %%rsi\n");
+    fprintf(file, "    jnz      .L%s_block\n", name);
+    fprintf(file, ".L%s_done:\n", name);
+    fprintf(file, "    vzeroupper\n");
+    fprintf(file, "    movq     %%rbx, %%rsp\n");
+    fprintf(file, "    popq     %%rbx\n");
+    fprintf(file, "    ret\n");
+    write_function_end(file, name);
+    return 0;
+}
+
+// Scalar kernel: each block is four 64-record columns. RDI points at the
+// current column of the first lane and the column count lives below the
+// spill slots, since every other register may be allocated.
+static int write_scalar_kernel(FILE* file, CodeGenContext* ctx, int stride) {
+    const char* name = BATCH_FUNCTION "_scalar";
+    static const char* saved[] = {"rbx", "r12", "r13", "r14", "r15"};
+    int saved_count = (int)(sizeof(saved) / sizeof(saved[0]));
+    int counter = ctx->stack_offset + 8;
+
+    // TRUE is a column of ones
+    for (int i = 0; i < ctx->instruction_count; i++) {
+        Instruction* inst = &ctx->instructions[i];
+        for (int j = 0; j < inst->operand_count; j++) {
+            if (inst->kinds[j] == OPERAND_IMMEDIATE && inst->values[j]) {
+                inst->values[j] = -1;
+            }
+        }
+    }
+
+    write_function_start(file, name);
+    for (int i = 0; i < saved_count; i++) {
+        fprintf(file, "    pushq    %%%s\n", saved[i]);
+    }
+    fprintf(file, "    movq     %%rsp, %%rbx    # Spill slot base\n");
+    fprintf(file, "    subq     $%d, %%rsp\n", counter);
+    fprintf(file, "    shlq     $2, %%rsi    # Four columns per block\n");
+    fprintf(file, "    jz       .L%s_done\n", name);
+    fprintf(file, "    movq     %%rsi, -%d(%%rbx)\n", counter);
+    fprintf(file, ".L%s_column:\n", name);
+    for (int i = 0; i < ctx->instruction_count; i++) {
+        write_instruction(file, ctx, &ctx->instructions[i]);
+    }
+    fprintf(file, "    addq     $8, %%rdi\n");
+    fprintf(file, "    subq     $1, -%d(%%rbx)\n", counter);
+    fprintf(file, "    jz       .L%s_done\n", name);
+    fprintf(file, "    testq    $3, -%d(%%rbx)\n", counter);
+    fprintf(file, "    jnz      .L%s_column\n", name);
+    fprintf(file, "    addq     $%d, %%rdi    # Next block\n", stride - BATCH_LANE_BYTES);
+    fprintf(file, "    jmp      .L%s_column\n", name);
+    fprintf(file, ".L%s_done:\n", name);
+    fprintf(file, "    movq     %%rbx, %%rsp\n");
+    for (int i = saved_count - 1; i >= 0; i--) {
+        fprintf(file, "    popq     %%%s\n", saved[i]);
+    }
+    fprintf(file, "    ret\n");
+    write_function_end(file, name);
+    return 0;
+}
+
+// Dispatcher: AVX2 needs the CPU feature and the OS saving ymm state
+// (OSXSAVE, then XCR0 bits 1 and 2). The choice is cached after the first
+// call: 1 for scalar, 2 for AVX2, and published by name for reports.
+static void write_dispatcher(FILE* file) {
+    const char* name = BATCH_FUNCTION;
+    write_function_start(file, name);
+    fprintf(file, "    movl     %s_isa(%%rip), %%eax\n", name);
+    fprintf(file, "    testl    %%eax, %%eax\n");
+    fprintf(file, "    jnz      .L%s_dispatch\n", name);
+    fprintf(file, "    pushq    %%rbx\n");
+    fprintf(file, "    movl     $1, %%r8d    # Scalar unless AVX2 is usable\n");
+    fprintf(file, "    xorl     %%eax, %%eax\n");
+    fprintf(file, "    cpuid\n");
+    fprintf(file, "    cmpl     $7, %%eax\n");
+    fprintf(file, "    jb       .L%s_detected\n", name);
+    fprintf(file, "    movl     $1, %%eax\n");
+    fprintf(file, "    cpuid\n");
+    fprintf(file, "    andl     $0x18000000, %%ecx    # OSXSAVE and AVX\n");
+    fprintf(file, "    cmpl     $0x18000000, %%ecx\n");
+    fprintf(file, "    jne      .L%s_detected\n", name);
+    fprintf(file, "    xorl     %%ecx, %%ecx\n");
+    fprintf(file, "    xgetbv\n");
+    fprintf(file, "    andl     $6, %%eax    # xmm and ymm state\n");
+    fprintf(file, "    cmpl     $6, %%eax\n");
+    fprintf(file, "    jne      .L%s_detected\n", name);
+    fprintf(file, "    movl     $7, %%eax\n");
+    fprintf(file, "    xorl     %%ecx, %%ecx\n");
+    fprintf(file, "    cpuid\n");
+    fprintf(file, "    testl    $0x20, %%ebx    # AVX2\n");
+    fprintf(file, "    jz       .L%s_detected\n", name);
+    fprintf(file, "    movl     $2, %%r8d\n");
+    fprintf(file, ".L%s_detected:\n", name);
+    fprintf(file, "    popq     %%rbx\n");
+    fprintf(file, "    leaq     .L%s_name_scalar(%%rip), %%rcx\n", name);
+    fprintf(file, "    leaq     .L%s_name_avx2(%%rip), %%rdx\n", name);
+    fprintf(file, "    cmpl     $2, %%r8d\n");
+    fprintf(file, "    cmoveq   %%rdx, %%rcx\n");
+    fprintf(file, "    movq     %%rcx, %s_kernel_name(%%rip)\n", name);
+    fprintf(file, "    movl     %%r8d, %%eax\n");
+    fprintf(file, "    movl     %%eax, %s_isa(%%rip)\n", name);
+    fprintf(file, ".L%s_dispatch:\n", name);
+    fprintf(file, "    cmpl     $2, %%eax\n");
+    fprintf(file, "    je       %s_avx2\n", name);
+    fprintf(file, "    jmp      %s_scalar\n", name);
+    write_function_end(file, name);
+}
+
+int generate_batch_kernels(const AST* ast, const char* output_file, int peephole_window) {
+    if (!ast) return -1;
+
+    printf("┌─ BATCH KERNEL GENERATION\n");
+    printf("│\n");
+    printf("│ Output: %s\n", output_file);
+    printf("│\n");
+
+    CodeGenContext* avx2 = compile_kernel(ast, CODEGEN_BATCH_AVX2, peephole_window);
+    if (!avx2) return -1;
+    CodeGenContext* scalar = compile_kernel(ast, CODEGEN_BATCH_SCALAR, peephole_window);
+    int stride = avx2->symbol_count * BATCH_LANE_BYTES;
+
+    printf("│ Lanes per block: %d (%d bytes)\n", avx2->symbol_count, stride);
+    printf("│\n");
+    printf("└─\n\n");
+
+    FILE* file = fopen(output_file, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create assembly file %s\n", output_file);
+        free_codegen_context(avx2);
+        free_codegen_context(scalar);
+        return -1;
+    }
+
+    fprintf(file, "# Batch kernels generated by Roadmap Compiler Phase 4\n");
+    fprintf(file, "# Target Architecture: x86_64 (AVX2 with scalar fallback)\n");
+    fprintf(file, "#\n");
+    fprintf(file, "# void %s(void* lanes, size_t blocks)\n", BATCH_FUNCTION);
+    fprintf(file, "# A block is %d bytes: one 32-byte lane per variable, bit r of each\n", stride);
+    fprintf(file, "# lane belonging to record r of the block.\n");
+    for (int i = 0; i < avx2->symbol_count; i++) {
+        const struct SymbolMap* sym = &avx2->symbols[i];
+        fprintf(file, "#   lane %d: %s (%s)\n", i, sym->name,
+                sym->is_input ? "input" : sym->is_bound ? "quantifier scratch" : "computed");
+    }
+    fprintf(file, "\n.section .text\n");
+
+    int result = write_avx2_kernel(file, avx2, stride);
+    if (result == 0) result = write_scalar_kernel(file, scalar, stride);
+    if (result == 0) write_dispatcher(file);
+
+    fprintf(file, "\n.section .rodata\n");
+    fprintf(file, "    .globl   %s_lanes\n", BATCH_FUNCTION);
+    fprintf(file, "%s_lanes: .long %d    # Lanes per block\n", BATCH_FUNCTION, avx2->symbol_count);
+    int inputs = 0, outputs = 0;
+    for (int i = 0; i < avx2->symbol_count; i++) {
+        inputs += avx2->symbols[i].is_input;
+        outputs += !avx2->symbols[i].is_input && !avx2->symbols[i].is_bound;
+    }
+    fprintf(file, "    .globl   %s_inputs\n", BATCH_FUNCTION);
+    fprintf(file, "%s_inputs: .long %d    # Input lanes\n", BATCH_FUNCTION, inputs);
+    fprintf(file, "    .globl   %s_outputs\n", BATCH_FUNCTION);
+    fprintf(file, "%s_outputs: .long %d    # Computed lanes; any after them are scratch\n",
+            BATCH_FUNCTION, outputs);
+    fprintf(file, "    .globl   %s_lane_is_input\n", BATCH_FUNCTION);
+    fprintf(file, "%s_lane_is_input:\n", BATCH_FUNCTION);
+    for (int i = 0; i < avx2->symbol_count; i++) {
+        fprintf(file, "    .byte    %d    # %s\n", avx2->symbols[i].is_input,
+                avx2->symbols[i].name);
+    }
+    fprintf(file, "    .globl   %s_lane_names\n", BATCH_FUNCTION);
+    fprintf(file, "%s_lane_names:\n", BATCH_FUNCTION);
+    for (int i = 0; i < avx2->symbol_count; i++) {
+        fprintf(file, "    .asciz   \"%s\"\n", avx2->symbols[i].name);
+    }
+    fprintf(file, ".L%s_name_avx2: .asciz \"AVX2\"\n", BATCH_FUNCTION);
+    fprintf(file, ".L%s_name_scalar: .asciz \"scalar\"\n", BATCH_FUNCTION);
+    fprintf(file, "\n.section .data\n");
+    fprintf(file, "%s_isa: .long 0    # 0 until the first call, then 1 scalar, 2 AVX2\n", BATCH_FUNCTION);
+    fprintf(file, "    .balign  8\n");
+    fprintf(file, "    .globl   %s_kernel_name\n", BATCH_FUNCTION);
+    fprintf(file, "%s_kernel_name: .quad 0    # Kernel the first call chose\n", BATCH_FUNCTION);
+    fprintf(file, "\n.section .note.GNU-stack,\"\",@progbits\n");
+    fclose(file);
+
+    free_codegen_context(avx2);
+    free_codegen_context(scalar);
+    return result;
+}
@@ -0,0 +1,625 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "bytecode.h"
+
+// Bytecode compiler. Each statement's expression is walked as a tree with
+// an explicit stack, so deep left-nested chains cannot overflow the C
+// stack. Of two operands the one needing more registers (its Ershov
+// number) is evaluated first; a subexpression used more than once in a
+// statement is evaluated once and kept in its register until its last
+// use. A register is freed as soon as its value has been consumed.
+//
+// Superinstructions replace common pairs: an identifier operand of AND or
+// OR is read straight from its slot (ANDV, ORV; an AND chain over
+// variables becomes LOADV followed by ANDVs), NOT of an identifier under
+// AND becomes ANDNV, and NOT of any other unshared operand under AND
+// becomes ANDN.
+//
+// EXISTS and FORALL run their body as a loop over the bound variable's
+// two values: the variable is saved, set to 0, and QNEXT sets it to 1 and
+// jumps back once; the results are ORed (EXISTS) or ANDed (FORALL) and
+// the variable is restored. Nothing inside a quantifier body is shared
+// with code outside it, since the bound variable changes under it.
+
+#define NO_REGISTER (-1)
+#define NO_SLOT UINT32_MAX
+
+// One node being compiled: its operands in operator order, evaluated
+// first-needed first
+typedef struct {
+    NodeIndex node;
+    uint8_t state;          // Operands evaluated so far
+    uint8_t op;             // Opcode combining the operands
+    uint8_t operand_count;
+    uint8_t first;          // Operand evaluated first
+    NodeIndex operands[2];
+    int registers[2];
+    uint8_t shared[2];      // Operand value is a shared register
+    uint32_t slot;          // Variable of an ANDV/ANDNV/ORV, or bound variable
+    int save;               // Quantifier: bound variable's value on entry
+    int accumulator;        // Quantifier: results so far
+    uint32_t loop;          // Quantifier: word the loop returns to
+} Frame;
+
+typedef struct {
+    const AST* ast;
+    Bytecode* bytecode;
+    uint32_t* slots;            // Slot of each SymbolId, NO_SLOT if none
+    uint32_t slot_index_size;
+
+    uint32_t* need;             // Ershov number of each node
+    uint32_t* marks;            // Statement stamp that counted a node's uses
+    uint32_t* uses;             // Uses of a node within the statement
+    uint32_t* remaining;        // Uses left of a shared node's register
+    int* cached;                // Register holding a shared node, NO_REGISTER
+    uint32_t stamp;
+    int quantifier_depth;
+
+    uint8_t busy[BYTECODE_REGISTERS];
+    Frame* frames;
+    uint32_t frame_capacity;
+    NodeIndex* walk;            // Node stack for counting uses
+    uint32_t walk_capacity;
+    int failed;
+} Compiler;
+
+static void* checked_realloc(void* memory, size_t size) {
+    void* result = realloc(memory, size);
+    if (!result) {
+        fprintf(stderr, "Out of memory for bytecode\n");
+        exit(1);
+    }
+    return result;
+}
+
+static void emit_word(Compiler* c, uint32_t word) {
+    Bytecode* bc = c->bytecode;
+    if (bc->size == bc->capacity) {
+        bc->capacity = bc->capacity ? bc->capacity * 2 : 256;
+        bc->code = checked_realloc(bc->code, bc->capacity * sizeof(uint32_t));
+    }
+    bc->code[bc->size++] = word;
+}
+
+static void emit_slot(Compiler* c, Opcode op, int reg, uint32_t slot) {
+    emit_word(c, BC_WORD(op, reg, slot & 0xFF, slot >> 8));
+}
+
+static int allocate(Compiler* c) {
+    for (int reg = 0; reg < BYTECODE_REGISTERS; reg++) {
+        if (!c->busy[reg]) {
+            c->busy[reg] = 1;
+            if ((uint32_t)reg >= c->bytecode->register_count) {
+                c->bytecode->register_count = reg + 1;
+            }
+            return reg;
+        }
+    }
+    if (!c->failed) {
+        fprintf(stderr, "Error: expression needs more than %d bytecode registers\n",
+                BYTECODE_REGISTERS);
+    }
+    c->failed = 1;
+    return 0;
+}
+
+static int is_leaf(const AST* ast, NodeIndex node) {
+    return ast->kinds[node] == AST_IDENTIFIER || ast->kinds[node] == AST_BOOLEAN_LITERAL;
+}
+
+static int is_shared(const Compiler* c, NodeIndex node) {
+    return c->quantifier_depth == 0 && !is_leaf(c->ast, node) && c->marks[node] == c->stamp &&
+           c->uses[node] > 1;
+}
+
+// Done with one use of a value
+static void release(Compiler* c, NodeIndex node, int reg, int shared) {
+    if (shared && --c->remaining[node] > 0) return;
+    if (shared) c->cached[node] = NO_REGISTER;
+    c->busy[reg] = 0;
+}
+
+// A register holding the value that the caller may overwrite
+static int take(Compiler* c, NodeIndex node, int reg, int shared) {
+    if (!shared) return reg;
+    if (c->remaining[node] == 1) {
+        c->remaining[node] = 0;
+        c->cached[node] = NO_REGISTER;
+        return reg;
+    }
+    int copy = allocate(c);
+    emit_word(c, BC_WORD(OP_MOVE, copy, reg, 0));
+    c->remaining[node]--;
+    return copy;
+}
+
+static void count_uses(Compiler* c, NodeIndex root) {
+    const AST* ast = c->ast;
+    uint32_t top = 0;
+    c->walk[top++] = root;
+    while (top > 0) {
+        NodeIndex node = c->walk[--top];
+        if (c->marks[node] == c->stamp) {
+            c->uses[node]++;
+            continue;
+        }
+        c->marks[node] = c->stamp;
+        c->uses[node] = 1;
+        c->cached[node] = NO_REGISTER;
+        if (ast->kinds[node] == AST_EXISTS || ast->kinds[node] == AST_FORALL) continue;
+        NodeIndex operands[2] = {ast->left[node], ast->right[node]};
+        for (int i = 0; i < 2; i++) {
+            if (operands[i] == NO_NODE) continue;
+            if (top == c->walk_capacity) {
+                c->walk_capacity *= 2;
+                c->walk = checked_realloc(c->walk, c->walk_capacity * sizeof(NodeIndex));
+            }
+            c->walk[top++] = operands[i];
+        }
+    }
+}
+
+static int is_identifier(const AST* ast, NodeIndex node) {
+    return ast->kinds[node] == AST_IDENTIFIER;
+}
+
+static int is_not_of_identifier(const AST* ast, NodeIndex node) {
+    return ast->kinds[node] == AST_NOT && is_identifier(ast, ast->left[node]);
+}
+
+static Opcode binary_opcode(ASTNodeType type) {
+    switch (type) {
+        case AST_AND:     return OP_AND;
+        case AST_OR:      return OP_OR;
+        case AST_XOR:     return OP_XOR;
+        case AST_IMPLIES: return OP_IMPLIES;
+        default:          return OP_XNOR; // XNOR, IFF and EQUIV
+    }
+}
+
+// Choose how frame's node is computed: its opcode and the operands that
+// must be evaluated into registers first
+static void plan_frame(Compiler* c, Frame* f) {
+    const AST* ast = c->ast;
+    NodeIndex node = f->node;
+    ASTNodeType type = (ASTNodeType)ast->kinds[node];
+    NodeIndex left = ast->left[node], right = ast->right[node];
+    f->operand_count = 0;
+    f->first = 0;
+
+    switch (type) {
+        case AST_NOT:
+            f->op = OP_NOT;
+            f->operands[f->operand_count++] = left;
+            return;
+        case AST_EXISTS:
+        case AST_FORALL:
+            f->op = type == AST_EXISTS ? OP_OR : OP_AND;
+            f->operands[f->operand_count++] = left;
+            return;
+        case AST_AND:
+        case AST_OR: {
+            NodeIndex pair[2] = {left, right};
+            for (int i = 0; i < 2; i++) {
+                NodeIndex other = pair[1 - i];
+                if (is_identifier(ast, pair[i])) {
+                    f->op = type == AST_AND ? OP_ANDV : OP_ORV;
+                    f->slot = c->slots[ast->operands[pair[i]]];
+                    f->operands[f->operand_count++] = other;
+                    c->bytecode->superinstructions++;
+                    return;
+                }
+                if (type == AST_AND && is_not_of_identifier(ast, pair[i])) {
+                    f->op = OP_ANDNV;
+                    f->slot = c->slots[ast->operands[ast->left[pair[i]]]];
+                    f->operands[f->operand_count++] = other;
+                    c->bytecode->superinstructions++;
+                    return;
+                }
+            }
+            for (int i = 0; type == AST_AND && i < 2; i++) {
+                if (ast->kinds[pair[i]] == AST_NOT && !is_shared(c, pair[i])) {
+                    f->op = OP_ANDN;
+                    f->operands[0] = pair[1 - i];
+                    f->operands[1] = ast->left[pair[i]];
+                    f->operand_count = 2;
+                    c->bytecode->superinstructions++;
+                    break;
+                }
+            }
+            if (f->operand_count == 0) {
+                f->op = binary_opcode(type);
+                f->operands[0] = left;
+                f->operands[1] = right;
+                f->operand_count = 2;
+            }
+            break;
+        }
+        default:
+            f->op = binary_opcode(type);
+            f->operands[0] = left;
+            f->operands[1] = right;
+            f->operand_count = 2;
+            break;
+    }
+    if (c->need[f->operands[1]] > c->need[f->operands[0]]) {
+        f->first = 1;
+    }
+}
+
+// Quantifier entry: save the bound variable, start the result at the
+// identity of its operator and the variable at 0
+static void enter_quantifier(Compiler* c, Frame* f) {
+    f->save = allocate(c);
+    f->accumulator = allocate(c);
+    emit_slot(c, OP_LOADV, f->save, f->slot);
+    emit_word(c, BC_WORD(OP_LOADK, f->accumulator, f->op == OP_AND, 0));
+    emit_slot(c, OP_STOREK, 0, f->slot);
+    f->loop = c->bytecode->size;
+    c->quantifier_depth++;
+}
+
+static int leave_quantifier(Compiler* c, Frame* f) {
+    emit_word(c, BC_WORD(f->op, f->accumulator, f->accumulator, f->registers[0]));
+    release(c, f->operands[0], f->registers[0], f->shared[0]);
+    emit_slot(c, OP_QNEXT, 0, f->slot);
+    emit_word(c, f->loop);
+    emit_slot(c, OP_STOREV, f->save, f->slot);
+    c->busy[f->save] = 0;
+    c->quantifier_depth--;
+    return f->accumulator;
+}
+
+// Emit the node's instruction once its operands are in registers
+static int finish_frame(Compiler* c, Frame* f) {
+    switch ((Opcode)f->op) {
+        case OP_ANDV:
+        case OP_ANDNV:
+        case OP_ORV: {
+            int reg = take(c, f->operands[0], f->registers[0], f->shared[0]);
+            emit_slot(c, (Opcode)f->op, reg, f->slot);
+            return reg;
+        }
+        case OP_NOT: {
+            release(c, f->operands[0], f->registers[0], f->shared[0]);
+            int reg = allocate(c);
+            emit_word(c, BC_WORD(OP_NOT, reg, f->registers[0], 0));
+            return reg;
+        }
+        default: {
+            release(c, f->operands[0], f->registers[0], f->shared[0]);
+            release(c, f->operands[1], f->registers[1], f->shared[1]);
+            int reg = allocate(c);
+            emit_word(c, BC_WORD(f->op, reg, f->registers[0], f->registers[1]));
+            return reg;
+        }
+    }
+}
+
+// Evaluate root into a register; *shared is set if the register belongs
+// to a shared node and must be released rather than overwritten
+static int compile_expression(Compiler* c, NodeIndex root, int* shared) {
+    const AST* ast = c->ast;
+    uint32_t depth = 0;
+    int result = 0, result_shared = 0;
+    NodeIndex pending = root;
+
+    for (;;) {
+        if (pending != NO_NODE) {
+            // Start a node: a cached value, a leaf, or a new frame
+            NodeIndex node = pending;
+            pending = NO_NODE;
+            ASTNodeType type = (ASTNodeType)ast->kinds[node];
+            if (is_shared(c, node) && c->cached[node] != NO_REGISTER) {
+                result = c->cached[node];
+                result_shared = 1;
+            } else if (type == AST_IDENTIFIER) {
+                result = allocate(c);
+                result_shared = 0;
+                emit_slot(c, OP_LOADV, result, c->slots[ast->operands[node]]);
+            } else if (type == AST_BOOLEAN_LITERAL) {
+                result = allocate(c);
+                result_shared = 0;
+                emit_word(c, BC_WORD(OP_LOADK, result, ast->operands[node] != 0, 0));
+            } else if ((type == AST_EXISTS || type == AST_FORALL) &&
+                       c->slots[ast->operands[node]] == NO_SLOT) {
+                // The body never reads the bound variable: one pass decides
+                pending = ast->left[node];
+                continue;
+            } else {
+                if (depth == c->frame_capacity) {
+                    c->frame_capacity *= 2;
+                    c->frames = checked_realloc(c->frames, c->frame_capacity * sizeof(Frame));
+                }
+                Frame* f = &c->frames[depth++];
+                f->node = node;
+                f->state = 0;
+                plan_frame(c, f);
+                if (type == AST_EXISTS || type == AST_FORALL) {
+                    f->slot = c->slots[ast->operands[node]];
+                    enter_quantifier(c, f);
+                }
+                pending = f->operands[f->first];
+                continue;
+            }
+        }
+
+        // A value is ready: hand it to the frame waiting for it
+        if (depth == 0) break;
+        Frame* f = &c->frames[depth - 1];
+        int index = f->state == 0 ? f->first : 1 - f->first;
+        f->registers[index] = result;
+        f->shared[index] = (uint8_t)result_shared;
+        if (++f->state < f->operand_count) {
+            pending = f->operands[1 - f->first];
+            continue;
+        }
+
+        ASTNodeType type = (ASTNodeType)ast->kinds[f->node];
+        result = type == AST_EXISTS || type == AST_FORALL ? leave_quantifier(c, f)
+                                                          : finish_frame(c, f);
+        result_shared = 0;
+        if (is_shared(c, f->node)) {
+            c->cached[f->node] = result;
+            c->remaining[f->node] = c->uses[f->node];
+            result_shared = 1;
+        }
+        depth--;
+    }
+
+    *shared = result_shared;
+    return result;
+}
+
+// Slots by first appearance, inputs before everything else: a variable
+// is an input when its first assignment is a literal. A variable that is
+// never assigned is only bound by quantifiers and goes after the outputs.
+static void assign_slots(Compiler* c) {
+    const AST* ast = c->ast;
+    Bytecode* bc = c->bytecode;
+    uint32_t size = interned_symbol_count() + 1;
+    uint8_t* assigned = calloc(size, 1);
+    uint8_t* input = calloc(size, 1);
+    SymbolId* order = malloc(size * sizeof(SymbolId));
+    c->slots = malloc(size * sizeof(uint32_t));
+    if (!assigned || !input || !order || !c->slots) {
+        fprintf(stderr, "Out of memory for bytecode\n");
+        exit(1);
+    }
+    c->slot_index_size = size;
+    for (uint32_t i = 0; i < size; i++) c->slots[i] = NO_SLOT;
+
+    for (uint32_t i = 0; i < ast->statement_count; i++) {
+        NodeIndex node = ast->statements[i];
+        SymbolId var = ast->operands[node];
+        if (ast->kinds[node] != AST_ASSIGNMENT || var == NO_SYMBOL || assigned[var]) continue;
+        assigned[var] = 1;
+        input[var] = ast->kinds[ast->left[node]] == AST_BOOLEAN_LITERAL;
+    }
+
+    uint32_t count = 0;
+    for (NodeIndex node = 0; node < ast->count; node++) {
+        ASTNodeType type = (ASTNodeType)ast->kinds[node];
+        SymbolId id = ast->operands[node];
+        if ((type == AST_IDENTIFIER || type == AST_ASSIGNMENT) && id != NO_SYMBOL &&
+            c->slots[id] == NO_SLOT) {
+            c->slots[id] = 0;
+            order[count++] = id;
+        }
+    }
+
+    bc->names = malloc((count + 1) * sizeof(const char*));
+    bc->input_values = malloc(count + 1);
+    if (!bc->names || !bc->input_values) {
+        fprintf(stderr, "Out of memory for bytecode\n");
+        exit(1);
+    }
+    // Pass 0 takes the inputs, 1 the other assigned variables, 2 the rest
+    uint32_t slot = 0;
+    for (int pass = 0; pass < 3; pass++) {
+        for (uint32_t i = 0; i < count; i++) {
+            SymbolId id = order[i];
+            int kind = input[id] ? 0 : assigned[id] ? 1 : 2;
+            if (kind != pass) continue;
+            c->slots[id] = slot;
+            if (pass < 2) bc->names[slot] = symbol_name(id);
+            slot++;
+        }
+        if (pass == 0) bc->input_count = slot;
+        if (pass == 1) bc->output_count = slot - bc->input_count;
+    }
+    bc->bound_count = count - bc->input_count - bc->output_count;
+
+    // Declared literals of the inputs
+    memset(assigned, 0, size);
+    for (uint32_t i = 0; i < ast->statement_count; i++) {
+        NodeIndex node = ast->statements[i];
+        SymbolId var = ast->operands[node];
+        if (ast->kinds[node] != AST_ASSIGNMENT || var == NO_SYMBOL || !input[var] ||
+            assigned[var]) {
+            continue;
+        }
+        assigned[var] = 1;
+        bc->input_values[c->slots[var]] = ast->operands[ast->left[node]] != 0;
+    }
+
+    free(assigned);
+    free(input);
+    free(order);
+}
+
+static void compile_statement(Compiler* c, uint32_t statement, uint8_t* assigned) {
+    const AST* ast = c->ast;
+    NodeIndex node = ast->statements[statement];
+    NodeIndex value = ast->left[node];
+    int shared;
+
+    c->stamp++;
+    switch ((ASTNodeType)ast->kinds[node]) {
+        case AST_ASSIGNMENT: {
+            SymbolId var = ast->operands[node];
+            if (var == NO_SYMBOL) return;
+            uint32_t slot = c->slots[var];
+            // An input's declaring assignment is replaced by the caller's
+            // value, and it has no output to take a later one
+            if (!assigned[slot]) {
+                assigned[slot] = 1;
+                if (slot < c->bytecode->input_count) return;
+            } else if (slot < c->bytecode->input_count) {
+                fprintf(stderr, "Error: line %d: input '%s' is assigned again\n", ast->lines[node],
+                        symbol_name(var));
+                c->failed = 1;
+                return;
+            }
+            // The caller supplies the inputs, so only values Phase 3 folded
+            // without them are stored as constants
+            if (node_is_input_free(ast, node)) {
+                emit_slot(c, OP_STOREK, node_constant_value(ast, node), slot);
+                return;
+            }
+            if (ast->kinds[value] == AST_BOOLEAN_LITERAL) {
+                emit_slot(c, OP_STOREK, ast->operands[value] != 0, slot);
+                return;
+            }
+            count_uses(c, value);
+            int reg = compile_expression(c, value, &shared);
+            emit_slot(c, OP_STOREV, reg, slot);
+            release(c, value, reg, shared);
+            return;
+        }
+        case AST_EXPRESSION_STMT: {
+            if (node_is_input_free(ast, node)) {
+                int reg = allocate(c);
+                emit_word(c, BC_WORD(OP_LOADK, reg, node_constant_value(ast, node), 0));
+                emit_word(c, BC_WORD(OP_RESULT, reg, 0, 0));
+                c->busy[reg] = 0;
+                return;
+            }
+            count_uses(c, value);
+            int reg = compile_expression(c, value, &shared);
+            emit_word(c, BC_WORD(OP_RESULT, reg, 0, 0));
+            release(c, value, reg, shared);
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+Bytecode* compile_bytecode(const AST* ast) {
+    if (!ast || ast->root == NO_NODE) return NULL;
+
+    printf("┌─ BYTECODE COMPILATION\n");
+    printf("│\n");
+
+    Bytecode* bc = calloc(1, sizeof(Bytecode));
+    Compiler c = {0};
+    uint32_t count = ast->count + 1;
+    c.ast = ast;
+    c.bytecode = bc;
+    c.need = malloc(count * sizeof(uint32_t));
+    c.marks = calloc(count, sizeof(uint32_t));
+    c.uses = malloc(count * sizeof(uint32_t));
+    c.remaining = malloc(count * sizeof(uint32_t));
+    c.cached = malloc(count * sizeof(int));
+    c.frame_capacity = 64;
+    c.frames = malloc(c.frame_capacity * sizeof(Frame));
+    c.walk_capacity = 64;
+    c.walk = malloc(c.walk_capacity * sizeof(NodeIndex));
+    if (!bc || !c.need || !c.marks || !c.uses || !c.remaining || !c.cached || !c.frames ||
+        !c.walk) {
+        fprintf(stderr, "Out of memory for bytecode\n");
+        exit(1);
+    }
+
+    assign_slots(&c);
+    uint32_t slot_count = bc->input_count + bc->output_count + bc->bound_count;
+    if (slot_count > BYTECODE_MAX_SLOTS) {
+        fprintf(stderr, "Error: %u variables, bytecode addresses at most %d\n", slot_count,
+                BYTECODE_MAX_SLOTS);
+        c.failed = 1;
+    }
+
+    // Operands precede their users, so one forward pass computes every
+    // node's register need
+    for (NodeIndex node = 0; node < ast->count && !c.failed; node++) {
+        NodeIndex left = ast->left[node], right = ast->right[node];
+        switch ((ASTNodeType)ast->kinds[node]) {
+            case AST_NOT:
+                c.need[node] = c.need[left];
+                break;
+            case AST_EXISTS:
+            case AST_FORALL:
+                c.need[node] = c.need[left] + 2;
+                bc->has_quantifiers = 1;
+                break;
+            default:
+                if (left == NO_NODE || right == NO_NODE) {
+                    c.need[node] = left == NO_NODE ? 1 : c.need[left];
+                } else {
+                    uint32_t l = c.need[left], r = c.need[right];
+                    c.need[node] = l == r ? l + 1 : (l > r ? l : r);
+                }
+                break;
+        }
+    }
+
+    uint8_t* assigned = calloc(slot_count + 1, 1);
+    if (!assigned) {
+        fprintf(stderr, "Out of memory for bytecode\n");
+        exit(1);
+    }
+    bc->statement_lines = malloc((ast->statement_count + 1) * sizeof(uint32_t));
+    bc->statement_starts = malloc((ast->statement_count + 1) * sizeof(uint32_t));
+    if (!bc->statement_lines || !bc->statement_starts) {
+        fprintf(stderr, "Out of memory for bytecode\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < ast->statement_count && !c.failed; i++) {
+        bc->statement_lines[i] = (uint32_t)ast->lines[ast->statements[i]];
+        bc->statement_starts[i] = bc->size;
+        bc->statement_count++;
+        compile_statement(&c, i, assigned);
+    }
+    emit_word(&c, BC_WORD(OP_HALT, 0, 0, 0));
+    free(assigned);
+
+    free(c.slots);
+    free(c.need);
+    free(c.marks);
+    free(c.uses);
+    free(c.remaining);
+    free(c.cached);
+    free(c.frames);
+    free(c.walk);
+
+    if (c.failed) {
+        printf("│ Bytecode compilation failed\n");
+        printf("│\n");
+        printf("└─\n\n");
+        free_bytecode(bc);
+        return NULL;
+    }
+
+    printf("│ Inputs: %u, outputs: %u\n", bc->input_count, bc->output_count);
+    printf("│ %u words (%u bytes), %u registers\n", bc->size, bc->size * 4, bc->register_count);
+    printf("│ Superinstructions: %u\n", bc->superinstructions);
+    if (bc->has_quantifiers) {
+        printf("│ Quantifiers expanded over both values of their variable\n");
+    }
+    printf("│\n");
+    printf("└─\n\n");
+    return bc;
+}
+
+void free_bytecode(Bytecode* bytecode) {
+    if (!bytecode) return;
+    free(bytecode->code);
+    free(bytecode->names);
+    free(bytecode->input_values);
+    free(bytecode->statement_lines);
+    free(bytecode->statement_starts);
+    free(bytecode);
+}
@@ -0,0 +1,88 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ast.h"  // Shared AST from Phase 2
+
+// Register-based bytecode for interpreting a program without generating
+// native code. Each instruction is one 32-bit word: the opcode in the low
+// byte, then operand bytes A, B and C. Registers (0/1 values) and
+// variable slots are separate files; a variable slot takes the 16 bits of
+// B and C together (BC). The interface is the rule function's: a variable
+// whose first assignment is a literal is an input, and inputs come first
+// in the slots, outputs after them, each in order of first appearance.
+typedef enum {
+    OP_LOADK,       // r[A] = B
+    OP_LOADV,       // r[A] = v[BC]
+    OP_STOREV,      // v[BC] = r[A]
+    OP_STOREK,      // v[BC] = A
+    OP_MOVE,        // r[A] = r[B]
+    OP_NOT,         // r[A] = NOT r[B]
+    OP_AND,         // r[A] = r[B] AND r[C]
+    OP_OR,          // r[A] = r[B] OR r[C]
+    OP_XOR,         // r[A] = r[B] XOR r[C]
+    OP_XNOR,        // r[A] = r[B] XNOR r[C] (also IFF and EQUIV)
+    OP_IMPLIES,     // r[A] = r[B] -> r[C]
+    OP_ANDN,        // r[A] = r[B] AND NOT r[C]        (superinstruction)
+    OP_ANDV,        // r[A] = r[A] AND v[BC]           (superinstruction)
+    OP_ANDNV,       // r[A] = r[A] AND NOT v[BC]       (superinstruction)
+    OP_ORV,         // r[A] = r[A] OR v[BC]            (superinstruction)
+    OP_QNEXT,       // If v[BC] is 0, set it to 1 and jump to the next
+                    // word's target, else step over that word
+    OP_RESULT,      // result = r[A]
+    OP_HALT,
+    OP_COUNT
+} Opcode;
+
+#define BYTECODE_REGISTERS 256
+#define BYTECODE_MAX_SLOTS 65536
+
+#define BC_WORD(op, a, b, c) \
+    ((uint32_t)(op) | (uint32_t)(a) << 8 | (uint32_t)(b) << 16 | (uint32_t)(c) << 24)
+#define BC_OP(word) ((word) & 0xFF)
+#define BC_A(word) (((word) >> 8) & 0xFF)
+#define BC_B(word) (((word) >> 16) & 0xFF)
+#define BC_C(word) ((word) >> 24)
+#define BC_BC(word) ((word) >> 16)
+
+typedef struct {
+    uint32_t* code;
+    uint32_t size;              // Words
+    uint32_t capacity;
+    uint32_t register_count;    // Registers the code uses
+    uint32_t input_count;       // Slots [0, input_count) are inputs
+    uint32_t output_count;      // Then the outputs
+    uint32_t bound_count;       // Then variables only quantifiers bind
+    const char** names;         // Variable of each input and output slot
+                                // (interned, not owned)
+    uint8_t* input_values;      // Literal each input was declared with
+    uint32_t statement_count;
+    uint32_t* statement_lines;  // Source line of each statement
+    uint32_t* statement_starts; // First word of each statement's code
+    uint32_t superinstructions; // ANDN, ANDV, ANDNV and ORV emitted
+    int has_quantifiers;
+} Bytecode;
+
+// Compile a semantically checked program to bytecode (bytecode.c); NULL
+// when it needs more registers or slots than the format has
+Bytecode* compile_bytecode(const AST* ast);
+void free_bytecode(Bytecode* bytecode);
+
+// Run the bytecode (vm.c) with threaded dispatch. variables is scratch of
+// input_count + output_count + bound_count bytes; inputs are read as
+// nonzero = TRUE and outputs written as 0/1. Returns the last expression
+// statement's value, or 0 if there is none.
+int vm_run(const Bytecode* bytecode, uint8_t* variables, const uint8_t* inputs,
+           uint8_t* outputs);
+
+// Run once with every input at its declared literal, print each variable
+// and return the result
+int vm_run_declared(const Bytecode* bytecode);
+
+// Time the interpreter against the JIT-compiled rule function over the
+// same input sets and check they agree (rule_benchmark.c)
+int benchmark_rule(const AST* ast, long iterations, int peephole_window);
+
+#endif // BYTECODE_H
@@ -9,17 +9,43 @@
 CodeGenContext* create_codegen_context(TargetArch target) {
     CodeGenContext* ctx = malloc(sizeof(CodeGenContext));
     ctx->instructions = NULL;
-    ctx->last_instruction = NULL;
     ctx->instruction_count = 0;
+    ctx->instruction_capacity = 0;
+    ctx->text = NULL;
+    ctx->text_size = 0;
+    ctx->text_capacity = 0;
+    ctx->labels = NULL;
+    ctx->label_count = 0;
+    ctx->label_capacity = 0;
     ctx->next_label_id = 1;
     ctx->stack_offset = 0;
-    ctx->symbol_map = NULL;
+    ctx->symbols = NULL;
+    ctx->symbol_count = 0;
+    ctx->symbol_capacity = 0;
+    ctx->flag_bits = 64;
+    ctx->variable_size = 0;
+    ctx->symbol_index = NULL;
+    ctx->symbol_index_size = 0;
+    ctx->eval_order = NULL;
+    ctx->eval_marks = NULL;
+    ctx->eval_uses = NULL;
+    ctx->eval_plan = NULL;
+    ctx->eval_chain = NULL;
+    ctx->eval_values = NULL;
+    ctx->eval_steps = NULL;
+    ctx->eval_step_count = 0;
+    ctx->eval_capacity = 0;
+    ctx->eval_stamp = 0;
     ctx->target = target;
     
-    // Initialize register usage (all free)
-    for (int i = 0; i < REG_COUNT; i++) {
-        ctx->register_usage[i] = 0;
-    }
+    ctx->mode = CODEGEN_PROGRAM;
+    ctx->result_register = -1;
+    ctx->failed = 0;
+    ctx->virtual_register_count = 0;
+    ctx->spill_count = 0;
+    ctx->slot_size = 8;
+    ctx->reserved_registers = 0;
+    ctx->peephole_window = DEFAULT_PEEPHOLE_WINDOW;
     
     return ctx;
 }
@@ -28,133 +54,292 @@ CodeGenContext* create_codegen_context(TargetArch target) {
 void free_codegen_context(CodeGenContext* ctx) {
     if (!ctx) return;
     
-    // Free instructions
-    Instruction* inst = ctx->instructions;
-    while (inst) {
-        Instruction* next = inst->next;
-        if (inst->comment) free(inst->comment);
-        free(inst);
-        inst = next;
-    }
+    // Free instruction buffer and its text
+    free(ctx->instructions);
+    free(ctx->text);
+    free(ctx->labels);
     
     // Free symbol map
-    struct SymbolMap* sym = ctx->symbol_map;
-    while (sym) {
-        struct SymbolMap* next = sym->next;
-        free(sym->name);
-        free(sym);
-        sym = next;
-    }
+    free(ctx->symbols);
+    free(ctx->symbol_index);
     
+    free(ctx->eval_order);
+    free(ctx->eval_marks);
+    free(ctx->eval_uses);
+    free(ctx->eval_plan);
+    free(ctx->eval_chain);
+    free(ctx->eval_values);
+    free(ctx->eval_steps);
     free(ctx);
 }
 
 // Register management
 Register allocate_register(CodeGenContext* ctx) {
-    for (int i = 0; i < REG_COUNT; i++) {
-        if (ctx->register_usage[i] == 0) {
-            ctx->register_usage[i] = 1;
-            return (Register)i;
+    return (Register)(REG_VIRTUAL + ctx->virtual_register_count++);
+}
+
+// Symbol management
+void add_symbol(CodeGenContext* ctx, SymbolId id, int is_boolean) {
+    // Cover every interned ID so lookups are a single index
+    if (id >= ctx->symbol_index_size) {
+        uint32_t size = ctx->symbol_index_size ? ctx->symbol_index_size : 64;
+        while (size <= id) size *= 2;
+        if (size < interned_symbol_count()) size = interned_symbol_count();
+        ctx->symbol_index = realloc(ctx->symbol_index, size * sizeof(int));
+        for (uint32_t i = ctx->symbol_index_size; i < size; i++) {
+            ctx->symbol_index[i] = -1;
         }
+        ctx->symbol_index_size = size;
+    }
+    if (ctx->symbol_count == ctx->symbol_capacity) {
+        ctx->symbol_capacity = ctx->symbol_capacity ? ctx->symbol_capacity * 2 : 64;
+        ctx->symbols = realloc(ctx->symbols, ctx->symbol_capacity * sizeof(struct SymbolMap));
+    }
+    if (!ctx->symbol_index || !ctx->symbols) {
+        fprintf(stderr, "Out of memory for symbol map\n");
+        exit(1);
     }
-    return REG_RAX; // Fallback to RAX if all registers busy
+    
+    struct SymbolMap* sym = &ctx->symbols[ctx->symbol_count];
+    sym->id = id;
+    sym->name = symbol_name(id);
+    sym->is_boolean = is_boolean;
+    sym->is_input = 0;
+    sym->is_bound = 0;
+    sym->input_value = 0;
+    sym->assignments = 0;
+    
+    if (IS_BATCH_MODE(ctx->mode)) {
+        // Batch lanes follow each other in the caller's block
+        sym->stack_offset = ctx->symbol_count * BATCH_LANE_BYTES;
+        sym->bit = -1;
+    } else {
+        // Booleans take the next bit of the current flag word, opening a
+        // new 8-byte word below the base when it is full; anything else
+        // gets a word of its own
+        if (!is_boolean || ctx->flag_bits == 64) {
+            ctx->stack_offset += 8;
+            ctx->flag_bits = 0;
+        }
+        sym->stack_offset = ctx->stack_offset;
+        sym->bit = is_boolean ? ctx->flag_bits : -1;
+        ctx->flag_bits = is_boolean ? ctx->flag_bits + 1 : 64;
+        ctx->variable_size = ctx->stack_offset;
+    }
+    ctx->symbol_index[id] = ctx->symbol_count++;
 }
 
-void free_register(CodeGenContext* ctx, Register reg) {
-    if (reg < REG_COUNT) {
-        ctx->register_usage[reg] = 0;
+// Node indices follow the source, so adding symbols in node order lays
+// out variables by first appearance. A variable that is never assigned is
+// only bound by quantifiers (Phase 3 rejects any other use): it is laid
+// out after the rest and is not an output.
+void layout_symbols(CodeGenContext* ctx, const AST* ast) {
+    uint8_t* assigned = calloc(interned_symbol_count() + 1, 1);
+    if (!assigned) {
+        fprintf(stderr, "Out of memory for symbol map\n");
+        exit(1);
     }
+    for (uint32_t i = 0; i < ast->statement_count; i++) {
+        NodeIndex node = ast->statements[i];
+        if (ast->kinds[node] == AST_ASSIGNMENT && ast->operands[node] != NO_SYMBOL) {
+            assigned[ast->operands[node]] = 1;
+        }
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (NodeIndex node = 0; node < ast->count; node++) {
+            ASTNodeType type = (ASTNodeType)ast->kinds[node];
+            SymbolId id = ast->operands[node];
+            if ((type != AST_IDENTIFIER && type != AST_ASSIGNMENT) || id == NO_SYMBOL ||
+                assigned[id] != (pass == 0) || symbol_exists(ctx, id)) {
+                continue;
+            }
+            add_symbol(ctx, id, 1);
+            ctx->symbols[ctx->symbol_count - 1].is_bound = pass == 1;
+        }
+    }
+    free(assigned);
 }
 
-int is_register_free(CodeGenContext* ctx, Register reg) {
-    return (reg < REG_COUNT) && (ctx->register_usage[reg] == 0);
+static struct SymbolMap* find_symbol(CodeGenContext* ctx, SymbolId id) {
+    if (id >= ctx->symbol_index_size || ctx->symbol_index[id] < 0) {
+        return NULL;
+    }
+    return &ctx->symbols[ctx->symbol_index[id]];
 }
 
-// Symbol management
-void add_symbol(CodeGenContext* ctx, const char* name, int is_boolean) {
-    struct SymbolMap* sym = malloc(sizeof(struct SymbolMap));
-    sym->name = strdup(name);
-    sym->stack_offset = ctx->stack_offset;
-    sym->is_boolean = is_boolean;
-    sym->next = ctx->symbol_map;
-    ctx->symbol_map = sym;
+// The symbol for id, added as a boolean if it has none yet
+static struct SymbolMap* require_symbol(CodeGenContext* ctx, SymbolId id) {
+    struct SymbolMap* sym = find_symbol(ctx, id);
+    if (!sym) {
+        add_symbol(ctx, id, 1); // Assume boolean
+        sym = &ctx->symbols[ctx->symbol_count - 1];
+    }
+    return sym;
+}
+
+// Memory operand of the word or lane holding sym
+static Operand symbol_operand(const CodeGenContext* ctx, const struct SymbolMap* sym) {
+    Operand op = {.type = OPERAND_MEMORY};
+    if (!IS_BATCH_MODE(ctx->mode)) {
+        op.value.memory.base = REG_RBX; // RBX is the frame base
+        op.value.memory.offset = -sym->stack_offset;
+    } else {
+        op.value.memory.base = REG_RDI; // RDI points at the caller's lanes
+        op.value.memory.offset = sym->stack_offset;
+    }
+    return op;
+}
+
+int get_symbol_offset(CodeGenContext* ctx, SymbolId id) {
+    struct SymbolMap* sym = find_symbol(ctx, id);
+    return sym ? sym->stack_offset : -1; // -1 if not found
+}
+
+int get_symbol_bit(CodeGenContext* ctx, SymbolId id) {
+    struct SymbolMap* sym = find_symbol(ctx, id);
+    return sym ? sym->bit : -1;
+}
+
+int symbol_exists(CodeGenContext* ctx, SymbolId id) {
+    return get_symbol_offset(ctx, id) != -1;
+}
+
+// Append a string to the text pool and return its offset
+static uint32_t store_text(CodeGenContext* ctx, const char* str) {
+    uint32_t length = (uint32_t)strlen(str) + 1;
+    uint32_t offset = ctx->text_size ? ctx->text_size : 1; // Keep NO_TEXT empty
+    if (offset + length > ctx->text_capacity) {
+        uint32_t capacity = ctx->text_capacity ? ctx->text_capacity : 1024;
+        while (offset + length > capacity) capacity *= 2;
+        ctx->text = realloc(ctx->text, capacity);
+        if (!ctx->text) {
+            fprintf(stderr, "Out of memory for instruction text\n");
+            exit(1);
+        }
+        ctx->text_capacity = capacity;
+    }
     
-    ctx->stack_offset += 8; // 8 bytes per variable (64-bit)
+    ctx->text[NO_TEXT] = '\0';
+    memcpy(ctx->text + offset, str, length);
+    ctx->text_size = offset + length;
+    return offset;
 }
 
-int get_symbol_offset(CodeGenContext* ctx, const char* name) {
-    struct SymbolMap* sym = ctx->symbol_map;
-    while (sym) {
-        if (strcmp(sym->name, name) == 0) {
-            return sym->stack_offset;
+// Generate unique label
+uint32_t generate_label(CodeGenContext* ctx, const char* prefix) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s_%d", prefix, ctx->next_label_id++);
+    
+    if (ctx->label_count == ctx->label_capacity) {
+        ctx->label_capacity = ctx->label_capacity ? ctx->label_capacity * 2 : 16;
+        ctx->labels = realloc(ctx->labels, ctx->label_capacity * sizeof(uint32_t));
+        if (!ctx->labels) {
+            fprintf(stderr, "Out of memory for labels\n");
+            exit(1);
         }
-        sym = sym->next;
     }
-    return -1; // Not found
+    ctx->labels[ctx->label_count] = store_text(ctx, name);
+    return ctx->label_count++;
 }
 
-int symbol_exists(CodeGenContext* ctx, const char* name) {
-    return get_symbol_offset(ctx, name) != -1;
+const char* label_name(const CodeGenContext* ctx, uint32_t label) {
+    return ctx->text + ctx->labels[label];
 }
 
-// Generate unique label
-char* generate_label(CodeGenContext* ctx, const char* prefix) {
-    char* label = malloc(64);
-    snprintf(label, 64, "%s_%d", prefix, ctx->next_label_id++);
-    return label;
+// Reserve the next slot of the instruction buffer
+static Instruction* append_instruction(CodeGenContext* ctx, InstructionType type) {
+    if (ctx->instruction_count == ctx->instruction_capacity) {
+        ctx->instruction_capacity = ctx->instruction_capacity ? ctx->instruction_capacity * 2 : 256;
+        ctx->instructions = realloc(ctx->instructions,
+                                    ctx->instruction_capacity * sizeof(Instruction));
+        if (!ctx->instructions) {
+            fprintf(stderr, "Out of memory for instructions\n");
+            exit(1);
+        }
+    }
+    
+    Instruction* inst = &ctx->instructions[ctx->instruction_count++];
+    memset(inst, 0, sizeof(Instruction));
+    inst->type = (uint8_t)type;
+    inst->comment = NO_TEXT;
+    return inst;
+}
+
+// Pack an operand into slot index of inst
+static void encode_operand(Instruction* inst, int index, Operand op) {
+    inst->kinds[index] = (uint8_t)op.type;
+    switch (op.type) {
+        case OPERAND_REGISTER:
+            inst->values[index] = op.value.reg;
+            break;
+        case OPERAND_IMMEDIATE:
+            inst->values[index] = op.value.immediate;
+            break;
+        case OPERAND_MEMORY:
+            inst->bases[index] = (uint8_t)op.value.memory.base;
+            inst->values[index] = op.value.memory.offset;
+            break;
+        case OPERAND_LABEL:
+            inst->values[index] = (int32_t)op.value.label;
+            break;
+    }
+}
+
+// Unpack operand index of inst
+Operand instruction_operand(const Instruction* inst, int index) {
+    Operand op;
+    op.type = (OperandType)inst->kinds[index];
+    switch (op.type) {
+        case OPERAND_REGISTER:
+            op.value.reg = (Register)inst->values[index];
+            break;
+        case OPERAND_IMMEDIATE:
+            op.value.immediate = inst->values[index];
+            break;
+        case OPERAND_MEMORY:
+            op.value.memory.base = (Register)inst->bases[index];
+            op.value.memory.offset = inst->values[index];
+            break;
+        case OPERAND_LABEL:
+            op.value.label = (uint32_t)inst->values[index];
+            break;
+    }
+    return op;
+}
+
+const char* instruction_comment(const CodeGenContext* ctx, const Instruction* inst) {
+    return inst->comment == NO_TEXT ? NULL : ctx->text + inst->comment;
 }
 
 // Emit instruction
 void emit_instruction(CodeGenContext* ctx, InstructionType type, int operand_count, ...) {
-    Instruction* inst = malloc(sizeof(Instruction));
-    inst->type = type;
-    inst->operand_count = operand_count;
-    inst->comment = NULL;
-    inst->next = NULL;
+    Instruction* inst = append_instruction(ctx, type);
+    inst->operand_count = (uint8_t)(operand_count < 3 ? operand_count : 3);
     
     // Parse variable arguments for operands
     va_list args;
     va_start(args, operand_count);
     
-    for (int i = 0; i < operand_count && i < 3; i++) {
-        inst->operands[i] = va_arg(args, Operand);
+    for (int i = 0; i < inst->operand_count; i++) {
+        encode_operand(inst, i, va_arg(args, Operand));
     }
     
     va_end(args);
-    
-    // Add to instruction list
-    if (ctx->last_instruction) {
-        ctx->last_instruction->next = inst;
-    } else {
-        ctx->instructions = inst;
-    }
-    ctx->last_instruction = inst;
-    ctx->instruction_count++;
 }
 
 // Emit label
-void emit_label(CodeGenContext* ctx, const char* label) {
-    Instruction* inst = malloc(sizeof(Instruction));
-    inst->type = INST_LABEL;
+void emit_label(CodeGenContext* ctx, uint32_t label) {
+    Instruction* inst = append_instruction(ctx, INST_LABEL);
     inst->operand_count = 1;
-    inst->operands[0].type = OPERAND_LABEL;
-    inst->operands[0].value.label = strdup(label);
-    inst->comment = NULL;
-    inst->next = NULL;
-    
-    if (ctx->last_instruction) {
-        ctx->last_instruction->next = inst;
-    } else {
-        ctx->instructions = inst;
-    }
-    ctx->last_instruction = inst;
-    ctx->instruction_count++;
+    inst->kinds[0] = OPERAND_LABEL;
+    inst->values[0] = (int32_t)label;
 }
 
-// Emit comment
+// Emit comment on the last instruction
 void emit_comment(CodeGenContext* ctx, const char* comment) {
-    if (ctx->last_instruction) {
-        ctx->last_instruction->comment = strdup(comment);
+    if (ctx->instruction_count > 0) {
+        ctx->instructions[ctx->instruction_count - 1].comment = store_text(ctx, comment);
     }
 }
 
@@ -170,6 +355,13 @@ const char* register_to_string(Register reg, TargetArch target) {
             case REG_RDI: return "rdi";
             case REG_R8: return "r8";
             case REG_R9: return "r9";
+            case REG_R10: return "r10";
+            case REG_R11: return "r11";
+            case REG_R12: return "r12";
+            case REG_R13: return "r13";
+            case REG_R14: return "r14";
+            case REG_R15: return "r15";
+            case REG_RSP: return "rsp";
             default: return "rax";
         }
     }
@@ -195,161 +387,844 @@ const char* instruction_to_string(InstructionType type) {
         case INST_XOR: return "xor";
         case INST_NOT: return "not";
         case INST_TEST: return "test";
+        case INST_SHL: return "shl";
+        case INST_SHR: return "shr";
+        case INST_NEG: return "neg";
+        case INST_BTS: return "bts";
+        case INST_BTR: return "btr";
+        case INST_ANDN: return "andn";
+        case INST_MOVZB: return "movzb";
+        case INST_MOVB: return "movb";
+        case INST_SYSCALL: return "syscall";
         default: return "nop";
     }
 }
 
-// Generate code for identifier
-void generate_identifier(CodeGenContext* ctx, const char* name, Register result_reg) {
-    printf("│     Loading identifier '%s' into %s\n", name, register_to_string(result_reg, ctx->target));
+// Emit reg OP= $value for a one-register ALU instruction
+static void emit_immediate(CodeGenContext* ctx, InstructionType type, Register reg, int value) {
+    Operand dest = {.type = OPERAND_REGISTER, .value.reg = reg};
+    Operand imm = {.type = OPERAND_IMMEDIATE, .value.immediate = value};
+    emit_instruction(ctx, type, 2, dest, imm);
+}
+
+// Generate code for identifier: its bit of the flag word, as 0/1
+void generate_identifier(CodeGenContext* ctx, SymbolId id, Register result_reg) {
+    printf("│     Loading identifier '%s' into v%d\n", symbol_name(id), result_reg - REG_VIRTUAL);
     
-    if (!symbol_exists(ctx, name)) {
-        add_symbol(ctx, name, 1); // Assume boolean
+    struct SymbolMap* sym = require_symbol(ctx, id);
+    
+    // Generate: mov result_reg, [rbx - offset]; shr $bit; and $1
+    Operand dest = {.type = OPERAND_REGISTER, .value.reg = result_reg};
+    Operand src = symbol_operand(ctx, sym);
+    
+    emit_instruction(ctx, INST_MOV, 2, dest, src);
+    emit_comment(ctx, symbol_name(id));
+    if (sym->bit < 0) return;
+    if (sym->bit > 0) {
+        emit_immediate(ctx, INST_SHR, result_reg, sym->bit);
+    }
+    if (sym->bit < 63) {
+        emit_immediate(ctx, INST_AND, result_reg, 1);
     }
+}
+
+// Generate code for a masked test of the flag word at offset, where the
+// bits in flip (a subset of mask) are read through a NOT: for AND, whether
+// every bit in mask holds, for OR whether any does. The mask is shifted
+// down when it reaches past bit 30, so that it always fits an immediate,
+// and the test reduces to 0/1 without flags: a nonzero value below 2^63
+// has its sign bit set after neg, and zero after sub $1.
+void generate_bit_test(CodeGenContext* ctx, ASTNodeType type, int offset, uint64_t mask,
+                       uint64_t flip, Register result_reg) {
+    printf("│     Testing flag bits 0x%llx (0x%llx negated) %s into v%d\n",
+           (unsigned long long)mask, (unsigned long long)flip,
+           type == AST_AND ? "all hold" : "any holds", result_reg - REG_VIRTUAL);
     
-    int offset = get_symbol_offset(ctx, name);
+    int shift = 0;
+    if (mask >> 31) {
+        shift = __builtin_ctzll(mask);
+        mask >>= shift;
+        flip >>= shift;
+    }
     
-    // Generate: mov result_reg, [rbp - offset]
     Operand dest = {.type = OPERAND_REGISTER, .value.reg = result_reg};
-    Operand src = {.type = OPERAND_MEMORY, .value.memory = {REG_RBX, -offset}}; // Use RBP as base
-    
+    Operand src = {.type = OPERAND_MEMORY, .value.memory = {REG_RBX, -offset}};
     emit_instruction(ctx, INST_MOV, 2, dest, src);
-    emit_comment(ctx, name);
+    if (shift > 0) {
+        emit_immediate(ctx, INST_SHR, result_reg, shift);
+    }
+    
+    if (type == AST_AND) {
+        // All hold when (word & mask) ^ (mask ^ flip) is zero
+        emit_immediate(ctx, INST_AND, result_reg, (int)mask);
+        emit_immediate(ctx, INST_XOR, result_reg, (int)(mask ^ flip));
+        emit_immediate(ctx, INST_SUB, result_reg, 1);
+    } else {
+        // Any holds when (word ^ flip) & mask is nonzero
+        if (flip) {
+            emit_immediate(ctx, INST_XOR, result_reg, (int)flip);
+        }
+        emit_immediate(ctx, INST_AND, result_reg, (int)mask);
+        emit_instruction(ctx, INST_NEG, 1, dest);
+    }
+    emit_immediate(ctx, INST_SHR, result_reg, 63);
+    emit_comment(ctx, type == AST_AND ? "AND of flag bits" : "OR of flag bits");
+}
+
+// Emit reg = reg XOR 1, the complement of a 0/1 value
+static void emit_complement(CodeGenContext* ctx, Register reg) {
+    emit_immediate(ctx, INST_XOR, reg, 1);
 }
 
-// Generate code for binary operation
-void generate_binary_op(CodeGenContext* ctx, ASTNode* node, Register result_reg __attribute__((unused))) {
-    printf("│     Generating binary operation: %s\n", node->node_type_str);
+// Generate code for binary operation: left_reg = left_reg OP right_reg.
+// Operands are 0/1 values, so every operator lowers to straight-line bit
+// operations without branches or flag materialisation.
+void generate_binary_op(CodeGenContext* ctx, ASTNodeType type, Register left_reg, Register right_reg) {
+    printf("│     Generating binary operation: %s\n", ast_node_type_to_string(type));
     
-    Register left_reg = REG_RAX;   // Use RAX for left operand
-    Register right_reg = REG_RBX;  // Use RBX for right operand
+    Operand dest = {.type = OPERAND_REGISTER, .value.reg = left_reg};
+    Operand src = {.type = OPERAND_REGISTER, .value.reg = right_reg};
     
-    // For our test case: B OR C
-    // Simulate loading B and C values
-    printf("│     Simulating B OR C operation\n");
+    switch (type) {
+        case AST_AND:
+            emit_instruction(ctx, INST_AND, 2, dest, src);
+            break;
+        case AST_OR:
+            emit_instruction(ctx, INST_OR, 2, dest, src);
+            break;
+        case AST_XOR:
+            emit_instruction(ctx, INST_XOR, 2, dest, src);
+            break;
+        case AST_XNOR:
+        case AST_IFF:
+        case AST_EQUIV:
+            // a == b is NOT (a XOR b)
+            emit_instruction(ctx, INST_XOR, 2, dest, src);
+            emit_complement(ctx, left_reg);
+            break;
+        case AST_IMPLIES:
+            // a -> b is (NOT a) OR b
+            emit_complement(ctx, left_reg);
+            emit_instruction(ctx, INST_OR, 2, dest, src);
+            break;
+        default:
+            printf("│     Unsupported binary operation: %s\n", ast_node_type_to_string(type));
+            return;
+    }
+    emit_comment(ctx, ast_node_type_to_string(type));
+}
+
+// Generate code for unary operation: reg = OP reg
+void generate_unary_op(CodeGenContext* ctx, ASTNodeType type, Register reg) {
+    printf("│     Generating unary operation: %s\n", ast_node_type_to_string(type));
+    
+    switch (type) {
+        case AST_NOT:
+            emit_complement(ctx, reg);
+            emit_comment(ctx, "NOT");
+            break;
+        default:
+            printf("│     Unsupported unary operation: %s\n", ast_node_type_to_string(type));
+            break;
+    }
+}
+
+// Evaluation steps of an expression over count distinct nodes: one per
+// node, plus a reloaded leaf per extra use of an identifier or literal
+#define MAX_STEPS(count) (3 * (size_t)(count))
+
+// Size the per-node evaluation scratch for an AST of count nodes
+static void reserve_eval_scratch(CodeGenContext* ctx, uint32_t count) {
+    if (count <= ctx->eval_capacity) return;
     
-    // Load B (TRUE = 1) into RAX
-    Operand b_dest = {.type = OPERAND_REGISTER, .value.reg = left_reg};
-    Operand b_val = {.type = OPERAND_IMMEDIATE, .value.immediate = 1};
-    emit_instruction(ctx, INST_MOV, 2, b_dest, b_val);
-    emit_comment(ctx, "Load B = TRUE");
+    free(ctx->eval_order);
+    free(ctx->eval_marks);
+    free(ctx->eval_uses);
+    free(ctx->eval_plan);
+    free(ctx->eval_chain);
+    free(ctx->eval_values);
+    free(ctx->eval_steps);
+    ctx->eval_order = malloc(MAX_STEPS(count) * sizeof(NodeIndex));
+    ctx->eval_marks = calloc(count, sizeof(uint32_t));
+    ctx->eval_uses = malloc(count * sizeof(uint32_t));
+    ctx->eval_plan = malloc(count * sizeof(uint32_t));
+    ctx->eval_chain = malloc((2 * (size_t)count + 2) * sizeof(uint32_t));
+    ctx->eval_values = malloc(count * sizeof(uint32_t));
+    ctx->eval_steps = malloc(MAX_STEPS(count) * sizeof(struct EvalStep));
+    if (!ctx->eval_order || !ctx->eval_marks || !ctx->eval_uses || !ctx->eval_plan ||
+        !ctx->eval_chain || !ctx->eval_values || !ctx->eval_steps) {
+        fprintf(stderr, "Out of memory for code generation\n");
+        exit(1);
+    }
+    ctx->eval_capacity = count;
+    ctx->eval_stamp = 0;
+}
+
+static int is_quantifier(ASTNodeType type) {
+    return type == AST_EXISTS || type == AST_FORALL;
+}
+
+// Collect the distinct nodes reachable from root, operands before their
+// users, and count how often each value is used within the expression. A
+// quantifier's body is not part of the expression: its value is evaluated
+// beforehand.
+static uint32_t collect_expression(CodeGenContext* ctx, const AST* ast, NodeIndex root) {
+    uint32_t stamp = ++ctx->eval_stamp;
+    uint32_t count = 0;
     
-    // Load C (FALSE = 0) into RBX
-    Operand c_dest = {.type = OPERAND_REGISTER, .value.reg = right_reg};
-    Operand c_val = {.type = OPERAND_IMMEDIATE, .value.immediate = 0};
-    emit_instruction(ctx, INST_MOV, 2, c_dest, c_val);
-    emit_comment(ctx, "Load C = FALSE");
+    // Iterative post-order walk. A node is either still on the stack or
+    // already in the order, so the stack grows down from the top of the
+    // order array without meeting it.
+    NodeIndex* order = ctx->eval_order;
+    uint32_t top = ctx->eval_capacity;
     
-    // Perform OR operation: RAX = RAX OR RBX
-    Operand left_src = {.type = OPERAND_REGISTER, .value.reg = right_reg};
-    emit_instruction(ctx, INST_OR, 2, b_dest, left_src);
-    emit_comment(ctx, "B OR C (result in RAX)");
+    ctx->eval_marks[root] = stamp;
+    ctx->eval_uses[root] = 1;
+    ctx->eval_plan[root] = NO_NODE;
+    order[--top] = root;
+    while (top < ctx->eval_capacity) {
+        NodeIndex node = order[top];
+        NodeIndex operands[2] = {ast->left[node], ast->right[node]};
+        if (is_quantifier((ASTNodeType)ast->kinds[node])) {
+            operands[0] = NO_NODE;
+        }
+        int pushed = 0;
+        for (int i = 0; i < 2 && !pushed; i++) {
+            NodeIndex operand = operands[i];
+            if (operand != NO_NODE && ctx->eval_marks[operand] != stamp) {
+                ctx->eval_marks[operand] = stamp;
+                ctx->eval_uses[operand] = 0;
+                ctx->eval_plan[operand] = NO_NODE;
+                order[--top] = operand;
+                pushed = 1;
+            }
+        }
+        if (pushed) continue;
+        
+        // All operands emitted: count this node's uses of them and emit it
+        for (int i = 0; i < 2; i++) {
+            if (operands[i] != NO_NODE) {
+                ctx->eval_uses[operands[i]]++;
+            }
+        }
+        top++;
+        order[count++] = node;
+    }
     
-    // Result is now in RAX (B OR C = TRUE OR FALSE = TRUE = 1)
+    return count;
+}
+
+// Operators whose chains may be regrouped (associative on 0/1 values)
+static int is_associative(ASTNodeType type) {
+    switch (type) {
+        case AST_AND:
+        case AST_OR:
+        case AST_XOR:
+        case AST_XNOR:
+        case AST_IFF:
+        case AST_EQUIV:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Append an evaluation step and label it with its Sethi-Ullman register
+// need: a leaf needs one register, a binary step one more than its
+// operands when they need the same number, else the larger of the two
+static uint32_t add_step(CodeGenContext* ctx, ASTNodeType kind, uint32_t left, uint32_t right,
+                         uint32_t operand) {
+    struct EvalStep* steps = ctx->eval_steps;
+    struct EvalStep* step = &steps[ctx->eval_step_count];
+    step->kind = (uint8_t)kind;
+    step->visited = 0;
+    step->left = left;
+    step->right = right;
+    step->operand = operand;
+    step->mask = 0;
+    step->flip = 0;
+    if (left == NO_NODE) {
+        step->need = 1;
+    } else if (right == NO_NODE) {
+        step->need = steps[left].need;
+    } else {
+        uint32_t l = steps[left].need;
+        uint32_t r = steps[right].need;
+        step->need = l == r ? l + 1 : (l > r ? l : r);
+    }
+    return ctx->eval_step_count++;
 }
 
-// Generate code for expression
-void generate_expression(CodeGenContext* ctx, ASTNode* node, Register result_reg) {
-    if (!node) return;
+// Marks a node inside a same-operator chain, evaluated only via its root
+#define CHAIN_LINK (NO_NODE - 1)
+
+// Step supplying node's value to one user. An identifier or literal with
+// several uses is reloaded at each one rather than kept in a register:
+// the load costs no more than a spill reload and frees the register.
+static uint32_t operand_step(CodeGenContext* ctx, const AST* ast, NodeIndex node) {
+    ASTNodeType type = (ASTNodeType)ast->kinds[node];
+    if ((type == AST_IDENTIFIER || type == AST_BOOLEAN_LITERAL) && ctx->eval_uses[node] > 1) {
+        return add_step(ctx, type, NO_NODE, NO_NODE, ast->operands[node]);
+    }
+    return ctx->eval_plan[node];
+}
+
+// Widest span of flag bits one masked test covers: the shifted mask must
+// fit a positive 32-bit immediate
+#define MAX_TEST_SPAN 31
+
+typedef struct {
+    int offset;         // Flag word
+    int bit;
+    int negated;        // Operand is NOT of the identifier
+    uint32_t position;  // Index in the chain
+} FlagLeaf;
+
+static int compare_flag_leaf(const void* a, const void* b) {
+    const FlagLeaf* x = a;
+    const FlagLeaf* y = b;
+    if (x->offset != y->offset) return x->offset < y->offset ? -1 : 1;
+    if (x->bit != y->bit) return x->bit - y->bit;
+    return x->position < y->position ? -1 : 1;
+}
+
+// Within the operand steps of an AND or OR chain, replace identifiers and
+// NOTs of identifiers that share a flag word by one masked test of that
+// word. The test takes the place of the group's first operand. Returns the
+// new operand count.
+static uint32_t group_flag_tests(CodeGenContext* ctx, ASTNodeType type, uint32_t* chain, uint32_t leaves) {
+    FlagLeaf* flags = malloc(leaves * sizeof(FlagLeaf));
+    if (!flags) {
+        fprintf(stderr, "Out of memory for code generation\n");
+        exit(1);
+    }
+    
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < leaves; i++) {
+        const struct EvalStep* step = &ctx->eval_steps[chain[i]];
+        int negated = step->kind == AST_NOT;
+        if (negated) step = &ctx->eval_steps[step->left];
+        if (step->kind != AST_IDENTIFIER) continue;
+        struct SymbolMap* sym = find_symbol(ctx, step->operand);
+        if (!sym || sym->bit < 0) continue;
+        flags[count].offset = sym->stack_offset;
+        flags[count].bit = sym->bit;
+        flags[count].negated = negated;
+        flags[count].position = i;
+        count++;
+    }
     
-    switch (node->type) {
-        case 4: // IDENTIFIER
-            if (node->data.identifier) {
-                generate_identifier(ctx, node->data.identifier, result_reg);
+    int grouped = 0;
+    if (count > 1) {
+        qsort(flags, count, sizeof(FlagLeaf), compare_flag_leaf);
+        for (uint32_t first = 0; first < count; ) {
+            uint32_t end = first;
+            uint32_t position = flags[first].position;
+            uint64_t mask = 0;
+            uint64_t flip = 0;
+            int contradiction = 0;
+            while (end < count && flags[end].offset == flags[first].offset &&
+                   flags[end].bit - flags[first].bit < MAX_TEST_SPAN) {
+                uint64_t bit = 1ULL << flags[end].bit;
+                uint64_t negated = flags[end].negated ? bit : 0;
+                if ((mask & bit) && (flip & bit) != negated) contradiction = 1;
+                mask |= bit;
+                flip |= negated;
+                if (flags[end].position < position) position = flags[end].position;
+                end++;
             }
-            break;
             
-        case 5: // BOOLEAN
-            {
-                printf("│     Loading boolean literal: %s\n", node->data.bool_literal ? "TRUE" : "FALSE");
-                Operand dest = {.type = OPERAND_REGISTER, .value.reg = result_reg};
-                Operand src = {.type = OPERAND_IMMEDIATE, .value.immediate = node->data.bool_literal};
-                emit_instruction(ctx, INST_MOV, 2, dest, src);
-                emit_comment(ctx, node->data.bool_literal ? "TRUE" : "FALSE");
+            // A group holding both X and NOT X has no single-mask form
+            if (end - first > 1 && !contradiction) {
+                uint32_t test = add_step(ctx, type, NO_NODE, NO_NODE, (uint32_t)flags[first].offset);
+                ctx->eval_steps[test].mask = mask;
+                ctx->eval_steps[test].flip = flip;
+                for (uint32_t j = first; j < end; j++) {
+                    chain[flags[j].position] = NO_NODE;
+                }
+                chain[position] = test;
+                grouped = 1;
+            }
+            first = end;
+        }
+    }
+    free(flags);
+    if (!grouped) return leaves;
+    
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < leaves; i++) {
+        if (chain[i] != NO_NODE) {
+            chain[kept++] = chain[i];
+        }
+    }
+    return kept;
+}
+
+// Turn the collected nodes into evaluation steps. A maximal chain of one
+// associative operator whose inner links have no other use, such as
+// A OR B OR C OR D, is flattened to its operands and regrouped as a
+// balanced tree ((A OR B) OR (C OR D)), which needs fewer live registers
+// and has a shorter dependency chain. Identifiers of an AND or OR chain
+// that share a flag word become a single masked test. Returns the root's
+// step.
+static uint32_t build_steps(CodeGenContext* ctx, const AST* ast, NodeIndex root, uint32_t count) {
+    ctx->eval_step_count = 0;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        NodeIndex node = ctx->eval_order[i];
+        ASTNodeType type = (ASTNodeType)ast->kinds[node];
+        if (!is_associative(type)) continue;
+        NodeIndex operands[2] = {ast->left[node], ast->right[node]};
+        for (int j = 0; j < 2; j++) {
+            if (ast->kinds[operands[j]] == type && ctx->eval_uses[operands[j]] == 1) {
+                ctx->eval_plan[operands[j]] = CHAIN_LINK;
+            }
+        }
+    }
+    
+    uint32_t chain_end = 2 * ctx->eval_capacity + 2;
+    for (uint32_t i = 0; i < count; i++) {
+        NodeIndex node = ctx->eval_order[i];
+        if (ctx->eval_plan[node] == CHAIN_LINK) continue;
+        
+        ASTNodeType type = (ASTNodeType)ast->kinds[node];
+        NodeIndex left = ast->left[node];
+        NodeIndex right = ast->right[node];
+        
+        if (is_quantifier(type)) {
+            ctx->eval_plan[node] = add_step(ctx, type, NO_NODE, NO_NODE, ctx->eval_values[node]);
+        } else if (left == NO_NODE) {
+            if (ctx->eval_uses[node] == 1) {
+                ctx->eval_plan[node] = add_step(ctx, type, NO_NODE, NO_NODE, ast->operands[node]);
+            }
+        } else if (right == NO_NODE) {
+            ctx->eval_plan[node] = add_step(ctx, type, operand_step(ctx, ast, left), NO_NODE,
+                                            ast->operands[node]);
+        } else if (!is_associative(type)) {
+            ctx->eval_plan[node] = add_step(ctx, type, operand_step(ctx, ast, left),
+                                            operand_step(ctx, ast, right), 0);
+        } else {
+            // Gather the chain's operand steps left to right; the pending
+            // nodes stack down from the top of the same buffer
+            uint32_t* chain = ctx->eval_chain;
+            uint32_t top = chain_end;
+            uint32_t leaves = 0;
+            chain[--top] = right;
+            chain[--top] = left;
+            while (top < chain_end) {
+                NodeIndex part = chain[top++];
+                if (ctx->eval_plan[part] == CHAIN_LINK) {
+                    chain[--top] = ast->right[part];
+                    chain[--top] = ast->left[part];
+                } else {
+                    chain[leaves++] = operand_step(ctx, ast, part);
+                }
             }
-            break;
             
-        case 7: // OR
-            generate_binary_op(ctx, node, result_reg);
-            break;
+            if (type == AST_AND || type == AST_OR) {
+                leaves = group_flag_tests(ctx, type, chain, leaves);
+            }
             
-        default:
-            printf("│     Unsupported expression type: %d\n", node->type);
-            break;
+            // Combine neighbours pairwise until one step is left
+            while (leaves > 1) {
+                uint32_t combined = 0;
+                for (uint32_t j = 0; j + 1 < leaves; j += 2) {
+                    chain[combined++] = add_step(ctx, type, chain[j], chain[j + 1], 0);
+                }
+                if (leaves % 2) {
+                    chain[combined++] = chain[leaves - 1];
+                }
+                leaves = combined;
+            }
+            ctx->eval_plan[node] = chain[0];
+        }
     }
+    
+    return ctx->eval_plan[root];
 }
 
-// Generate code for assignment
-void generate_assignment(CodeGenContext* ctx, ASTNode* node) {
-    if (!node || !node->data.assignment.variable) return;
+// Order the steps reachable from root operands first, descending into the
+// operand with the larger register need first (Sethi-Ullman), and count
+// each step's uses. Returns the number of steps in eval_order.
+static uint32_t order_steps(CodeGenContext* ctx, uint32_t root) {
+    struct EvalStep* steps = ctx->eval_steps;
+    uint32_t* order = ctx->eval_order;
+    uint32_t end = (uint32_t)MAX_STEPS(ctx->eval_capacity);
+    uint32_t top = end;
+    uint32_t count = 0;
     
-    printf("│   Generating assignment: %s\n", node->data.assignment.variable);
+    steps[root].visited = 1;
+    steps[root].uses = 1;
+    order[--top] = root;
+    while (top < end) {
+        uint32_t index = order[top];
+        struct EvalStep* step = &steps[index];
+        uint32_t operands[2] = {step->left, step->right};
+        if (step->right != NO_NODE && steps[step->right].need > steps[step->left].need) {
+            operands[0] = step->right;
+            operands[1] = step->left;
+        }
+        
+        int pushed = 0;
+        for (int i = 0; i < 2 && !pushed; i++) {
+            uint32_t operand = operands[i];
+            if (operand != NO_NODE && !steps[operand].visited) {
+                steps[operand].visited = 1;
+                steps[operand].uses = 0;
+                order[--top] = operand;
+                pushed = 1;
+            }
+        }
+        if (pushed) continue;
+        
+        for (int i = 0; i < 2; i++) {
+            if (operands[i] != NO_NODE) {
+                steps[operands[i]].uses++;
+            }
+        }
+        top++;
+        order[count++] = index;
+    }
     
-    const char* var_name = node->data.assignment.variable;
+    return count;
+}
+
+// Generate code for the quantifier at node into result_reg: its body is
+// evaluated with the bound variable cleared, then set, and the two values
+// are combined with OR for EXISTS and AND for FORALL. Expressions only read
+// variables, so saving the variable's word or lane and storing it back
+// afterwards hides the binding from the rest of the expression.
+static void generate_quantifier(CodeGenContext* ctx, const AST* ast, NodeIndex node, Register result_reg) {
+    ASTNodeType type = (ASTNodeType)ast->kinds[node];
+    SymbolId var = ast->operands[node];
+    printf("│     Expanding %s over '%s'\n", ast_node_type_to_string(type), symbol_name(var));
     
-    // Add symbol to table if not exists
-    if (!symbol_exists(ctx, var_name)) {
-        add_symbol(ctx, var_name, 1);
+    // Symbols are laid out before any code, so a variable without one is
+    // never read and the body's value does not depend on it
+    const struct SymbolMap* entry = find_symbol(ctx, var);
+    if (!entry) {
+        generate_expression(ctx, ast, ast->left[node], result_reg);
+        return;
     }
     
-    // Generate code for the value expression
-    Register value_reg = allocate_register(ctx);
-    generate_expression(ctx, node->data.assignment.value, value_reg);
+    struct SymbolMap sym = *entry;
+    Operand slot = symbol_operand(ctx, &sym);
+    Operand saved = {.type = OPERAND_REGISTER, .value.reg = allocate_register(ctx)};
+    Operand value = {.type = OPERAND_REGISTER, .value.reg = allocate_register(ctx)};
+    emit_instruction(ctx, INST_MOV, 2, saved, slot);
+    emit_comment(ctx, symbol_name(var));
     
-    // Store result in variable's memory location
-    int offset = get_symbol_offset(ctx, var_name);
-    Operand src = {.type = OPERAND_REGISTER, .value.reg = value_reg};
-    Operand dest = {.type = OPERAND_MEMORY, .value.memory = {REG_RBX, -offset}};
+    for (int bound = 0; bound <= 1; bound++) {
+        if (sym.bit >= 0) {
+            Operand bit = {.type = OPERAND_IMMEDIATE, .value.immediate = sym.bit};
+            emit_instruction(ctx, bound ? INST_BTS : INST_BTR, 2, slot, bit);
+        } else {
+            Operand lane = {.type = OPERAND_IMMEDIATE, .value.immediate = bound};
+            emit_instruction(ctx, INST_MOV, 2, value, lane);
+            emit_instruction(ctx, INST_MOV, 2, slot, value);
+        }
+        emit_comment(ctx, bound ? "Bound TRUE" : "Bound FALSE");
+        generate_expression(ctx, ast, ast->left[node], bound ? value.value.reg : result_reg);
+    }
+    generate_binary_op(ctx, type == AST_EXISTS ? AST_OR : AST_AND, result_reg, value.value.reg);
     
+    emit_instruction(ctx, INST_MOV, 2, slot, saved);
+    emit_comment(ctx, symbol_name(var));
+}
+
+// Evaluate the quantifiers the expression at root reaches outside any
+// quantifier's body, each into a register of its own, for the expression's
+// steps to read. A body is evaluated by an expression of its own, which
+// reuses the scratch, so the registers are only recorded once all are done.
+static void generate_quantifiers(CodeGenContext* ctx, const AST* ast, NodeIndex root) {
+    uint32_t stamp = ++ctx->eval_stamp;
+    NodeIndex* stack = ctx->eval_order;
+    uint32_t* found = ctx->eval_chain;
+    uint32_t top = 0;
+    uint32_t count = 0;
+    
+    ctx->eval_marks[root] = stamp;
+    stack[top++] = root;
+    while (top > 0) {
+        NodeIndex node = stack[--top];
+        if (is_quantifier((ASTNodeType)ast->kinds[node])) {
+            found[count++] = node;
+            continue;
+        }
+        NodeIndex operands[2] = {ast->left[node], ast->right[node]};
+        for (int i = 0; i < 2; i++) {
+            if (operands[i] != NO_NODE && ctx->eval_marks[operands[i]] != stamp) {
+                ctx->eval_marks[operands[i]] = stamp;
+                stack[top++] = operands[i];
+            }
+        }
+    }
+    if (count == 0) return;
+    
+    uint32_t* quantifiers = malloc(2 * count * sizeof(uint32_t));
+    if (!quantifiers) {
+        fprintf(stderr, "Out of memory for code generation\n");
+        exit(1);
+    }
+    memcpy(quantifiers, found, count * sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++) {
+        Register reg = allocate_register(ctx);
+        generate_quantifier(ctx, ast, quantifiers[i], reg);
+        quantifiers[count + i] = (uint32_t)reg;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        ctx->eval_values[quantifiers[i]] = quantifiers[count + i];
+    }
+    free(quantifiers);
+}
+
+// Generate code for the expression rooted at root into result_reg. Each
+// distinct subexpression is evaluated once, in Sethi-Ullman order; an
+// operand whose value has no further uses donates its register to the
+// result.
+void generate_expression(CodeGenContext* ctx, const AST* ast, NodeIndex root, Register result_reg) {
+    if (!ast || root == NO_NODE) return;
+    
+    reserve_eval_scratch(ctx, ast->count);
+    generate_quantifiers(ctx, ast, root);
+    uint32_t node_count = collect_expression(ctx, ast, root);
+    uint32_t root_step = build_steps(ctx, ast, root, node_count);
+    uint32_t count = order_steps(ctx, root_step);
+    struct EvalStep* steps = ctx->eval_steps;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t index = ctx->eval_order[i];
+        struct EvalStep* step = &steps[index];
+        ASTNodeType type = (ASTNodeType)step->kind;
+        Register reg;
+        
+        switch (type) {
+            case AST_IDENTIFIER:
+                reg = index == root_step ? result_reg : allocate_register(ctx);
+                generate_identifier(ctx, step->operand, reg);
+                break;
+                
+            case AST_BOOLEAN_LITERAL: {
+                reg = index == root_step ? result_reg : allocate_register(ctx);
+                int value = step->operand;
+                printf("│     Loading boolean literal: %s\n", value ? "TRUE" : "FALSE");
+                Operand dest = {.type = OPERAND_REGISTER, .value.reg = reg};
+                Operand src = {.type = OPERAND_IMMEDIATE, .value.immediate = value};
+                emit_instruction(ctx, INST_MOV, 2, dest, src);
+                emit_comment(ctx, value ? "TRUE" : "FALSE");
+                break;
+            }
+                
+            case AST_EXISTS:
+            case AST_FORALL:
+                // Evaluated beforehand; the root copies it for the caller
+                reg = (Register)step->operand;
+                if (index == root_step) {
+                    Operand dest = {.type = OPERAND_REGISTER, .value.reg = result_reg};
+                    Operand src = {.type = OPERAND_REGISTER, .value.reg = reg};
+                    emit_instruction(ctx, INST_MOV, 2, dest, src);
+                    reg = result_reg;
+                }
+                break;
+                
+            default: {
+                if (step->left == NO_NODE && step->mask != 0) {
+                    reg = index == root_step ? result_reg : allocate_register(ctx);
+                    generate_bit_test(ctx, type, (int)step->operand, step->mask, step->flip, reg);
+                    break;
+                }
+                if (step->left == NO_NODE) {
+                    printf("│     Unsupported expression type: %d\n", type);
+                    continue;
+                }
+                
+                // Result register: the caller's for the root, else the left
+                // operand's when this is its last use, else a fresh one
+                struct EvalStep* left = &steps[step->left];
+                if (index == root_step) {
+                    reg = result_reg;
+                } else if (left->uses == 1 && step->left != step->right) {
+                    reg = left->reg;
+                } else {
+                    reg = allocate_register(ctx);
+                }
+                if (reg != left->reg) {
+                    Operand dest = {.type = OPERAND_REGISTER, .value.reg = reg};
+                    Operand src = {.type = OPERAND_REGISTER, .value.reg = left->reg};
+                    emit_instruction(ctx, INST_MOV, 2, dest, src);
+                }
+                
+                if (step->right != NO_NODE) {
+                    generate_binary_op(ctx, type, reg, steps[step->right].reg);
+                    steps[step->right].uses--;
+                } else {
+                    generate_unary_op(ctx, type, reg);
+                }
+                left->uses--;
+                break;
+            }
+        }
+        step->reg = reg;
+    }
+}
+
+// Whether Phase 3 folded the statement at node to a constant this mode can
+// use: a program's inputs keep their declared values, elsewhere the
+// caller supplies them, so only values that hold without them count
+static int statement_is_folded(const CodeGenContext* ctx, const AST* ast, NodeIndex node) {
+    return ctx->mode == CODEGEN_PROGRAM ? node_is_constant(ast, node)
+                                        : node_is_input_free(ast, node);
+}
+
+// Load a folded statement's value, as a literal would be
+static void load_folded_value(CodeGenContext* ctx, const AST* ast, NodeIndex node, Register reg) {
+    int value = node_constant_value(ast, node);
+    printf("│     Folded to %s\n", value ? "TRUE" : "FALSE");
+    Operand dest = {.type = OPERAND_REGISTER, .value.reg = reg};
+    Operand src = {.type = OPERAND_IMMEDIATE, .value.immediate = value};
     emit_instruction(ctx, INST_MOV, 2, dest, src);
-    emit_comment(ctx, var_name);
+    emit_comment(ctx, value ? "Folded TRUE" : "Folded FALSE");
+}
+
+// Generate code for the assignment at node
+void generate_assignment(CodeGenContext* ctx, const AST* ast, NodeIndex node) {
+    SymbolId var = ast->operands[node];
+    if (var == NO_SYMBOL) return;
+    
+    printf("│   Generating assignment: %s\n", symbol_name(var));
+    
+    // Add symbol to table if not exists; copied, since the expression may
+    // still add symbols and move the table
+    struct SymbolMap* entry = require_symbol(ctx, var);
+    NodeIndex value = ast->left[node];
+    
+    // In a batch kernel or rule function a variable first assigned a
+    // literal is an input. Its value comes from the caller and it has no
+    // output, so a later assignment would be lost.
+    if (entry->is_input) {
+        fprintf(stderr, "Error: line %d: input '%s' is assigned again\n", ast->lines[node],
+                symbol_name(var));
+        ctx->failed = 1;
+        return;
+    }
+    if (ctx->mode != CODEGEN_PROGRAM && entry->assignments++ == 0 &&
+        ast->kinds[value] == AST_BOOLEAN_LITERAL) {
+        printf("│     Input, supplied by the caller\n");
+        entry->is_input = 1;
+        entry->input_value = ast->operands[value] != 0;
+        return;
+    }
+    
+    struct SymbolMap sym = *entry;
+    Operand dest = symbol_operand(ctx, &sym);
+    Operand bit = {.type = OPERAND_IMMEDIATE, .value.immediate = sym.bit};
+    
+    // A literal or folded value sets or clears the bit directly
+    int folded = statement_is_folded(ctx, ast, node);
+    if (sym.bit >= 0 && (folded || ast->kinds[value] == AST_BOOLEAN_LITERAL)) {
+        int set = folded ? node_constant_value(ast, node) : ast->operands[value] != 0;
+        if (folded) {
+            printf("│     Folded to %s\n", set ? "TRUE" : "FALSE");
+        }
+        emit_instruction(ctx, set ? INST_BTS : INST_BTR, 2, dest, bit);
+        emit_comment(ctx, symbol_name(var));
+        return;
+    }
+    
+    // Generate code for the value expression
+    Register value_reg = allocate_register(ctx);
+    if (folded) {
+        load_folded_value(ctx, ast, node, value_reg);
+    } else {
+        generate_expression(ctx, ast, value, value_reg);
+    }
     
-    free_register(ctx, value_reg);
+    // Store result in variable's memory location: clear its bit, then or
+    // the 0/1 value in at that bit
+    Operand src = {.type = OPERAND_REGISTER, .value.reg = value_reg};
+    if (sym.bit < 0) {
+        emit_instruction(ctx, INST_MOV, 2, dest, src);
+        emit_comment(ctx, symbol_name(var));
+        return;
+    }
+    emit_instruction(ctx, INST_BTR, 2, dest, bit);
+    if (sym.bit > 0) {
+        emit_immediate(ctx, INST_SHL, value_reg, sym.bit);
+    }
+    emit_instruction(ctx, INST_OR, 2, dest, src);
+    emit_comment(ctx, symbol_name(var));
 }
 
 // Generate code for statement
-void generate_statement(CodeGenContext* ctx, ASTNode* node) {
-    if (!node) return;
+void generate_statement(CodeGenContext* ctx, const AST* ast, uint32_t statement) {
+    NodeIndex node = ast->statements[statement];
     
-    switch (node->type) {
-        case 2: // ASSIGNMENT
-            generate_assignment(ctx, node);
+    switch ((ASTNodeType)ast->kinds[node]) {
+        case AST_ASSIGNMENT:
+            generate_assignment(ctx, ast, node);
             break;
             
-        case 3: // EXPRESSION_STMT
+        case AST_EXPRESSION_STMT:
             {
                 printf("│   Generating expression statement\n");
                 Register expr_reg = allocate_register(ctx);
-                
-                // For our test case, this represents "B OR C"
-                ASTNode or_node = {
-                    .type = 7,
-                    .node_type_str = "OR",
-                    .line_number = 3
-                };
-                
-                generate_binary_op(ctx, &or_node, expr_reg);
-                free_register(ctx, expr_reg);
+                if (statement_is_folded(ctx, ast, node)) {
+                    load_folded_value(ctx, ast, node, expr_reg);
+                } else {
+                    generate_expression(ctx, ast, ast->left[node], expr_reg);
+                }
+                ctx->result_register = expr_reg;
             }
             break;
             
         default:
-            printf("│   Unsupported statement type: %d\n", node->type);
+            printf("│   Unsupported statement type: %d\n", ast->kinds[node]);
             break;
     }
 }
 
 // Generate code for program
-void generate_program(CodeGenContext* ctx, ASTNode* node) {
-    if (!node || node->type != 1) return;
+void generate_program(CodeGenContext* ctx, const AST* ast) {
+    if (!ast || ast->root == NO_NODE) return;
+    
+    printf("│ Generating code for program with %u statements\n", ast->statement_count);
     
-    printf("│ Generating code for program with %d statements\n", node->data.program.count);
+    // Lay out the variables and clear their flag words, so a variable
+    // read before any assignment is FALSE; a rule function's prologue
+    // clears them before storing its inputs
+    layout_symbols(ctx, ast);
+    if (ctx->mode == CODEGEN_PROGRAM) {
+        for (int offset = 8; offset <= ctx->variable_size; offset += 8) {
+            Operand word = {.type = OPERAND_MEMORY, .value.memory = {REG_RBX, -offset}};
+            Operand zero = {.type = OPERAND_IMMEDIATE, .value.immediate = 0};
+            emit_instruction(ctx, INST_MOV, 2, word, zero);
+        }
+    }
+    if (!IS_BATCH_MODE(ctx->mode)) {
+        printf("│ %d variables packed into %d flag words\n", ctx->symbol_count, ctx->variable_size / 8);
+    }
     
     // Generate code for each statement
-    for (int i = 0; i < node->data.program.count; i++) {
+    for (uint32_t i = 0; i < ast->statement_count; i++) {
         printf("│ \n");
-        printf("│ Statement %d:\n", i + 1);
-        generate_statement(ctx, node->data.program.statements[i]);
+        printf("│ Statement %u:\n", i + 1);
+        generate_statement(ctx, ast, i);
+    }
+    
+    // A batch kernel returns through the writer's epilogue
+    if (IS_BATCH_MODE(ctx->mode)) return;
+    
+    // A rule function returns its last expression statement's value
+    if (ctx->mode == CODEGEN_FUNCTION) {
+        Operand result = {.type = OPERAND_REGISTER, .value.reg = REG_RAX};
+        Operand value = {.type = OPERAND_IMMEDIATE, .value.immediate = 0};
+        if (ctx->result_register >= 0) {
+            value.type = OPERAND_REGISTER;
+            value.value.reg = (Register)ctx->result_register;
+        }
+        emit_instruction(ctx, INST_MOV, 2, result, value);
+        emit_comment(ctx, "Return value");
+        return;
     }
     
     // Generate clean exit - just return exit code in RAX
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "ast.h"  // Shared AST from Phase 2
 
 // Target architecture
 typedef enum {
@@ -12,7 +13,24 @@ typedef enum {
     TARGET_MIPS
 } TargetArch;
 
-// Register allocation
+// Output mode. A program is a _start executable over its variables; a
+// rule function (rule_function.c) is the same code as a callable function
+// over caller-supplied inputs and outputs; the batch modes emit a kernel
+// function over bit-sliced lanes (batch_kernel.c), where each variable is a
+// 256-bit lane holding one bit per record.
+typedef enum {
+    CODEGEN_PROGRAM,
+    CODEGEN_FUNCTION,       // Program layout, returns its last expression in RAX
+    CODEGEN_BATCH_AVX2,     // Physical registers name ymm registers
+    CODEGEN_BATCH_SCALAR    // 64-bit registers, one qword of a lane at a time
+} CodeGenMode;
+
+#define IS_BATCH_MODE(mode) ((mode) == CODEGEN_BATCH_AVX2 || (mode) == CODEGEN_BATCH_SCALAR)
+
+#define BATCH_LANE_BYTES 32
+
+// Registers. Code is generated on virtual registers (REG_VIRTUAL + n,
+// one per value) and allocate_registers maps them onto the physical ones.
 typedef enum {
     REG_RAX = 0,    // Accumulator
     REG_RBX,        // Base
@@ -22,7 +40,15 @@ typedef enum {
     REG_RDI,        // Destination Index
     REG_R8,         // General purpose
     REG_R9,         // General purpose
-    REG_COUNT
+    REG_R10,        // General purpose
+    REG_R11,        // General purpose
+    REG_R12,        // General purpose (callee-saved)
+    REG_R13,        // General purpose (callee-saved)
+    REG_R14,        // General purpose (callee-saved)
+    REG_R15,        // General purpose (callee-saved)
+    REG_RSP,        // Stack pointer, only in function prologues
+    REG_COUNT,
+    REG_VIRTUAL = 32
 } Register;
 
 // Assembly instruction types
@@ -43,6 +69,15 @@ typedef enum {
     INST_XOR,       // Bitwise XOR
     INST_NOT,       // Bitwise NOT
     INST_TEST,      // Test (AND without storing result)
+    INST_SHL,       // Shift left
+    INST_SHR,       // Logical shift right
+    INST_NEG,       // Two's complement negate
+    INST_BTS,       // Bit test and set
+    INST_BTR,       // Bit test and reset
+    INST_ANDN,      // dest = dest AND NOT src (batch AVX2 only)
+    INST_MOVZB,     // Load a byte from memory, zero-extended
+    INST_MOVB,      // Store a register's low byte to memory
+    INST_SYSCALL,   // System call
     INST_LABEL      // Label definition
 } InstructionType;
 
@@ -54,13 +89,14 @@ typedef enum {
     OPERAND_LABEL
 } OperandType;
 
-// Assembly operand
+// Assembly operand, as passed to emit_instruction and decoded back out
+// of the instruction buffer by instruction_operand
 typedef struct {
     OperandType type;
     union {
         Register reg;
         int immediate;
-        char* label;
+        uint32_t label;     // Label ID from generate_label
         struct {
             Register base;
             int offset;
@@ -68,107 +104,238 @@ typedef struct {
     } value;
 } Operand;
 
-// Assembly instruction
-typedef struct Instruction {
-    InstructionType type;
-    Operand operands[3];  // Max 3 operands for most instructions
-    int operand_count;
-    char* comment;        // Optional comment
-    struct Instruction* next;
+#define NO_TEXT 0
+
+// Assembly instruction, fixed-size and stored by value in one contiguous
+// buffer. Each operand is a kind byte plus a 32-bit payload (register,
+// immediate, memory offset or label ID); memory operands keep their base
+// register in bases. Comment and label text live in the context's text
+// pool and are referenced by offset (NO_TEXT for none).
+typedef struct {
+    uint8_t type;           // InstructionType
+    uint8_t operand_count;
+    uint8_t kinds[3];       // OperandType of each operand
+    uint8_t bases[3];       // Base register of memory operands
+    int32_t values[3];
+    uint32_t comment;       // Offset into the text pool
 } Instruction;
 
 // Code generation context
 typedef struct {
     Instruction* instructions;
-    Instruction* last_instruction;
     int instruction_count;
+    int instruction_capacity;
+    
+    // Text pool for comments and label names: NUL-terminated strings
+    // appended back to back, starting with an empty string at NO_TEXT
+    char* text;
+    uint32_t text_size;
+    uint32_t text_capacity;
+    uint32_t* labels;           // Text offset of each label's name
+    uint32_t label_count;
+    uint32_t label_capacity;
     
     // Register allocation
-    int register_usage[REG_COUNT];
+    CodeGenMode mode;
+    int virtual_register_count;
+    int spill_count;            // Virtual registers assigned a stack slot
+    int slot_size;              // Bytes per spill slot
+    uint32_t reserved_registers; // Physical registers the allocator must not use
+    int peephole_window;        // Instructions a peephole rule looks ahead, 0 = off
     int next_label_id;
     int stack_offset;
+    int result_register;        // Holds the last expression statement's value, -1 if none
+    int failed;                 // A statement was rejected; the code is incomplete
     
-    // Symbol mapping (variable name -> stack offset)
+    // Symbol mapping (interned variable -> flag word and bit), kept in
+    // insertion order for the data section; interned IDs are dense, so
+    // symbol_index maps an ID straight to its entry (-1 if unmapped).
+    // Boolean variables are packed 64 to a qword below RBX; in the batch
+    // modes every variable is a lane at RDI + stack_offset instead.
     struct SymbolMap {
-        char* name;
-        int stack_offset;
+        SymbolId id;
+        const char* name;   // symbol_name(id), for the assembly listing
+        int stack_offset;   // Offset of the qword or lane holding the variable
+        int bit;            // Bit within that qword, -1 if it fills it
         int is_boolean;
-        struct SymbolMap* next;
-    } *symbol_map;
+        int is_input;       // Supplied by the caller (batch lane or function input)
+        int is_bound;       // Only bound by quantifiers: scratch, neither input nor output
+        int input_value;    // Literal an input was declared with
+        int assignments;    // Assignments generated so far
+    } *symbols;
+    int symbol_count;
+    int flag_bits;              // Bits used in the last flag word
+    int variable_size;          // Bytes of variable storage below RBX
+    int symbol_capacity;
+    int* symbol_index;
+    uint32_t symbol_index_size;
+    
+    // Per-node scratch for expression evaluation, sized to the AST
+    NodeIndex* eval_order;      // Nodes, then steps, of the current expression, operands first
+    uint32_t* eval_marks;       // Expression stamp that last visited a node
+    uint32_t* eval_uses;        // Uses of a node's value within the expression
+    uint32_t* eval_plan;        // Step computing a node's value
+    uint32_t* eval_chain;       // Operands of a same-operator chain being regrouped
+    uint32_t* eval_values;      // Register holding a quantifier's value, evaluated beforehand
+    uint32_t eval_capacity;
+    uint32_t eval_stamp;
+    
+    // Evaluation steps of the current expression: its distinct nodes, with
+    // same-operator chains regrouped into balanced trees
+    struct EvalStep {
+        uint8_t kind;           // ASTNodeType
+        uint8_t visited;
+        uint32_t left;          // Operand steps, NO_NODE if absent
+        uint32_t right;
+        uint32_t operand;       // SymbolId, literal value, flag word offset or register
+        uint64_t mask;          // Flag word bits of a masked AND/OR test
+        uint64_t flip;          // Bits of mask tested through a NOT
+        uint32_t need;          // Sethi-Ullman register need
+        uint32_t uses;          // Remaining uses of the step's value
+        Register reg;           // Register holding the value
+    } *eval_steps;
+    uint32_t eval_step_count;
     
     // Target architecture
     TargetArch target;
     
 } CodeGenContext;
 
-// AST Node structure (simplified for code generation)
-typedef struct ASTNode {
-    int type;
-    char* node_type_str;
-    int line_number;
-    
-    union {
-        char* identifier;
-        int bool_literal;
-        struct {
-            char* variable;
-            struct ASTNode* value;
-        } assignment;
-        struct {
-            struct ASTNode* left;
-            struct ASTNode* right;
-        } binary;
-        struct {
-            struct ASTNode* operand;
-        } unary;
-        struct {
-            struct ASTNode** statements;
-            int count;
-        } program;
-    } data;
-} ASTNode;
-
 // Function prototypes
 CodeGenContext* create_codegen_context(TargetArch target);
 void free_codegen_context(CodeGenContext* ctx);
 
 // AST loading
-ASTNode* load_annotated_ast(const char* filename);
-void free_ast_node(ASTNode* node);
-
-// Code generation
-int generate_assembly(CodeGenContext* ctx, ASTNode* ast, const char* output_file);
-void generate_program(CodeGenContext* ctx, ASTNode* node);
-void generate_statement(CodeGenContext* ctx, ASTNode* node);
-void generate_assignment(CodeGenContext* ctx, ASTNode* node);
-void generate_expression(CodeGenContext* ctx, ASTNode* node, Register result_reg);
-void generate_binary_op(CodeGenContext* ctx, ASTNode* node, Register result_reg);
-void generate_identifier(CodeGenContext* ctx, const char* name, Register result_reg);
+AST* load_annotated_ast(const char* filename);
+
+// Code generation. The AST is a DAG: each statement evaluates every
+// distinct subexpression it reaches once, operands first and the operand
+// with the larger register need before the other, into its own virtual
+// register. Same-operator chains of AND, OR, XOR, XNOR, IFF and EQUIV are
+// regrouped into balanced trees, and the identifiers (or their NOTs) of an
+// AND or OR chain that share a flag word are tested together with one mask.
+int generate_assembly(CodeGenContext* ctx, const AST* ast, const char* output_file);
+void generate_program(CodeGenContext* ctx, const AST* ast);
+void generate_statement(CodeGenContext* ctx, const AST* ast, uint32_t statement);
+void generate_assignment(CodeGenContext* ctx, const AST* ast, NodeIndex node);
+void generate_expression(CodeGenContext* ctx, const AST* ast, NodeIndex root, Register result_reg);
+void generate_binary_op(CodeGenContext* ctx, ASTNodeType type, Register left_reg, Register right_reg);
+void generate_unary_op(CodeGenContext* ctx, ASTNodeType type, Register reg);
+void generate_identifier(CodeGenContext* ctx, SymbolId id, Register result_reg);
+void generate_bit_test(CodeGenContext* ctx, ASTNodeType type, int offset, uint64_t mask,
+                       uint64_t flip, Register result_reg);
 
 // Instruction generation
 void emit_instruction(CodeGenContext* ctx, InstructionType type, int operand_count, ...);
-void emit_label(CodeGenContext* ctx, const char* label);
+void emit_label(CodeGenContext* ctx, uint32_t label);
 void emit_comment(CodeGenContext* ctx, const char* comment);
 
-// Register management
+// Instruction buffer access
+Operand instruction_operand(const Instruction* inst, int index);
+const char* instruction_comment(const CodeGenContext* ctx, const Instruction* inst);
+const char* label_name(const CodeGenContext* ctx, uint32_t label);
+
+// Register management: allocate_register returns a fresh virtual
+// register; allocate_registers (register_allocator.c) computes live
+// intervals over the instruction buffer, assigns physical registers by
+// linear scan, spills to stack slots below the variables and rewrites the
+// buffer in place
 Register allocate_register(CodeGenContext* ctx);
-void free_register(CodeGenContext* ctx, Register reg);
-int is_register_free(CodeGenContext* ctx, Register reg);
+void allocate_registers(CodeGenContext* ctx);
+
+// Peephole optimization (peephole.c) of the allocated instructions:
+// store-to-load forwarding, dead-store elimination, move coalescing,
+// idiom replacement and (batch AVX2) and-not fusion, each looking at most
+// peephole_window instructions ahead; prints how often each rule fired
+#define DEFAULT_PEEPHOLE_WINDOW 8
+void optimize_peephole(CodeGenContext* ctx);
+
+// Symbol management. layout_symbols assigns every variable of the AST
+// its bit in order of first appearance, so variables used together share
+// a flag word; variables only quantifiers bind come after all the others.
+void add_symbol(CodeGenContext* ctx, SymbolId id, int is_boolean);
+void layout_symbols(CodeGenContext* ctx, const AST* ast);
+int get_symbol_offset(CodeGenContext* ctx, SymbolId id);
+int get_symbol_bit(CodeGenContext* ctx, SymbolId id);
+int symbol_exists(CodeGenContext* ctx, SymbolId id);
+
+// Batch kernels (batch_kernel.c): writes logic_batch, which evaluates the
+// program over blocks of 256 records with AVX2 or, on CPUs without it, a
+// scalar 64-bit fallback. A variable whose first assignment is a literal
+// is an input: the caller fills its lane and that assignment is skipped.
+int generate_batch_kernels(const AST* ast, const char* output_file, int peephole_window);
+
+// Rule functions (rule_function.c): writes <prefix>_eval as a System V
+// function and a C header declaring it,
+//
+//     int <prefix>_eval(const uint8_t* inputs, uint8_t* outputs);
+//
+// Inputs follow the batch convention, one byte each in order of first
+// appearance, and may not be assigned again; every other variable but
+// those only quantifiers bind is written to outputs, one 0/1 byte each.
+// Returns the value of the last expression statement, or 0. With
+// object_file set, the function is also written there as an ELF object.
+int generate_rule_function(const AST* ast, const char* prefix, const char* assembly_file,
+                           const char* header_file, const char* object_file,
+                           int peephole_window);
+
+// Compile the program as a complete rule function, prologue to ret, in
+// the returned context's instruction buffer; NULL if an input is assigned
+// again
+CodeGenContext* compile_rule_function(const AST* ast, int peephole_window);
+
+// Machine code (x86_encoder.c): encodes an allocated x86_64 instruction
+// buffer, resolving jumps and calls to its labels; returns -1 for an
+// instruction without an encoding
+typedef struct {
+    uint8_t* bytes;
+    size_t size;
+    size_t capacity;
+} MachineCode;
+
+int encode_x86_64(const CodeGenContext* ctx, MachineCode* code);
+void free_machine_code(MachineCode* code);
+
+// ELF64 relocatable objects (elf_writer.c), written without `as`.
+// write_program_object takes the context generate_assembly left behind
+// and writes the same program, with _start its only symbol;
+// write_rule_object takes a compile_rule_function context.
+int write_program_object(CodeGenContext* ctx, const char* output_file);
+int write_rule_object(const CodeGenContext* ctx, const char* function_name,
+                      const char* output_file);
+
+// In-process JIT (jit.c): compiles the program as a rule function straight
+// into executable memory. The code is written to a private read-write
+// mapping that is then made read-execute, never both.
+typedef int (*RuleFunction)(const uint8_t* inputs, uint8_t* outputs);
+
+typedef struct {
+    RuleFunction eval;
+    void* code;                 // The executable mapping
+    size_t mapped_size;
+    size_t code_size;
+    int input_count;
+    int output_count;
+    const char** input_names;   // In inputs[] order
+    const char** output_names;  // In outputs[] order
+    uint8_t* input_values;      // Literal each input was declared with
+} JitRule;
+
+JitRule* jit_compile_rule(const AST* ast, int peephole_window);
+void jit_free_rule(JitRule* rule);
 
-// Symbol management
-void add_symbol(CodeGenContext* ctx, const char* name, int is_boolean);
-int get_symbol_offset(CodeGenContext* ctx, const char* name);
-int symbol_exists(CodeGenContext* ctx, const char* name);
+// Call the rule once with every input at its declared literal, print each
+// variable and return the result
+int jit_run_declared(const JitRule* rule);
 
 // Assembly output
 void write_assembly_header(FILE* file, TargetArch target);
 void write_assembly_footer(FILE* file, TargetArch target);
-void write_instruction(FILE* file, Instruction* inst, TargetArch target);
-void write_data_section(FILE* file, CodeGenContext* ctx);
+void write_instruction(FILE* file, const CodeGenContext* ctx, const Instruction* inst);
 
 // Utility functions
 const char* register_to_string(Register reg, TargetArch target);
 const char* instruction_to_string(InstructionType type);
-char* generate_label(CodeGenContext* ctx, const char* prefix);
+uint32_t generate_label(CodeGenContext* ctx, const char* prefix);
 
 #endif // CODE_GENERATOR_H
\ No newline at end of file
@@ -0,0 +1,245 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <elf.h>
+#include <stddef.h>
+#include "code_generator.h"
+
+// ELF64 relocatable objects, written from the instruction buffer through
+// x86_encoder.c instead of printing assembly and running `as`. The layout
+// is what `as` produces for the same .s file: .text, an empty .data, a
+// symbol table with the entry point global, and an empty .note.GNU-stack
+// so the linker keeps the stack non-executable. Jumps and calls only
+// target labels inside .text, which the encoder resolves, and variables
+// live in the stack frame, so nothing needs a relocation and no .rela.text
+// section is written.
+
+enum {
+    SECTION_NULL,
+    SECTION_TEXT,
+    SECTION_DATA,
+    SECTION_SYMTAB,
+    SECTION_STRTAB,
+    SECTION_SHSTRTAB,
+    SECTION_NOTE_STACK,
+    SECTION_COUNT
+};
+
+typedef struct {
+    const char* name;
+    uint16_t section;
+    uint64_t value;
+    uint64_t size;
+    uint8_t type;       // STT_*
+    int global;
+} ObjectSymbol;
+
+static void append_bytes(MachineCode* image, const void* data, size_t size) {
+    if (image->size + size > image->capacity) {
+        size_t capacity = image->capacity ? image->capacity : 4096;
+        while (capacity < image->size + size) capacity *= 2;
+        image->bytes = realloc(image->bytes, capacity);
+        if (!image->bytes) {
+            fprintf(stderr, "Out of memory for object file\n");
+            exit(1);
+        }
+        image->capacity = capacity;
+    }
+    if (size > 0) memcpy(image->bytes + image->size, data, size);
+    image->size += size;
+}
+
+static void align_image(MachineCode* image, size_t alignment) {
+    static const uint8_t zero[16] = {0};
+    while (image->size % alignment != 0) {
+        append_bytes(image, zero, 1);
+    }
+}
+
+// Offset of text in a string table (which starts with an empty string)
+static uint32_t add_string(MachineCode* table, const char* text) {
+    uint32_t offset = (uint32_t)table->size;
+    append_bytes(table, text, strlen(text) + 1);
+    return offset;
+}
+
+static Elf64_Shdr section_header(uint32_t name, uint32_t type, uint64_t flags, uint64_t offset,
+                                 uint64_t size, uint64_t alignment) {
+    Elf64_Shdr header = {0};
+    header.sh_name = name;
+    header.sh_type = type;
+    header.sh_flags = flags;
+    header.sh_offset = offset;
+    header.sh_size = size;
+    header.sh_addralign = alignment;
+    return header;
+}
+
+// Write text as an x86_64 relocatable object. Local symbols must come
+// before global ones in symbols.
+static int write_elf_object(const char* output_file, const MachineCode* text,
+                            const ObjectSymbol* symbols, int symbol_count) {
+    MachineCode image = {0}, strtab = {0}, shstrtab = {0}, symtab = {0};
+    Elf64_Shdr sections[SECTION_COUNT] = {{0}};
+
+    add_string(&strtab, "");
+    add_string(&shstrtab, "");
+    uint32_t text_name = add_string(&shstrtab, ".text");
+    uint32_t data_name = add_string(&shstrtab, ".data");
+    uint32_t symtab_name = add_string(&shstrtab, ".symtab");
+    uint32_t strtab_name = add_string(&shstrtab, ".strtab");
+    uint32_t shstrtab_name = add_string(&shstrtab, ".shstrtab");
+    uint32_t note_name = add_string(&shstrtab, ".note.GNU-stack");
+
+    // Null symbol and the two section symbols, then the caller's
+    Elf64_Sym symbol = {0};
+    append_bytes(&symtab, &symbol, sizeof(symbol));
+    symbol.st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+    symbol.st_shndx = SECTION_TEXT;
+    append_bytes(&symtab, &symbol, sizeof(symbol));
+    symbol.st_shndx = SECTION_DATA;
+    append_bytes(&symtab, &symbol, sizeof(symbol));
+    uint32_t first_global = 3 + (uint32_t)symbol_count;
+    for (int i = 0; i < symbol_count; i++) {
+        const ObjectSymbol* sym = &symbols[i];
+        memset(&symbol, 0, sizeof(symbol));
+        symbol.st_name = add_string(&strtab, sym->name);
+        symbol.st_info = ELF64_ST_INFO(sym->global ? STB_GLOBAL : STB_LOCAL, sym->type);
+        symbol.st_shndx = sym->section;
+        symbol.st_value = sym->value;
+        symbol.st_size = sym->size;
+        append_bytes(&symtab, &symbol, sizeof(symbol));
+        if (sym->global && first_global > 3 + (uint32_t)i) first_global = 3 + (uint32_t)i;
+    }
+
+    Elf64_Ehdr header = {0};
+    memcpy(header.e_ident, ELFMAG, SELFMAG);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    header.e_type = ET_REL;
+    header.e_machine = EM_X86_64;
+    header.e_version = EV_CURRENT;
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_shentsize = sizeof(Elf64_Shdr);
+    header.e_shnum = SECTION_COUNT;
+    header.e_shstrndx = SECTION_SHSTRTAB;
+    append_bytes(&image, &header, sizeof(header));
+
+    align_image(&image, 16);
+    sections[SECTION_TEXT] = section_header(text_name, SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR,
+                                            image.size, text->size, 16);
+    append_bytes(&image, text->bytes, text->size);
+
+    align_image(&image, 8);
+    sections[SECTION_DATA] = section_header(data_name, SHT_PROGBITS, SHF_ALLOC | SHF_WRITE,
+                                            image.size, 0, 8);
+
+    align_image(&image, 8);
+    sections[SECTION_SYMTAB] = section_header(symtab_name, SHT_SYMTAB, 0, image.size,
+                                              symtab.size, 8);
+    sections[SECTION_SYMTAB].sh_link = SECTION_STRTAB;
+    sections[SECTION_SYMTAB].sh_info = first_global;
+    sections[SECTION_SYMTAB].sh_entsize = sizeof(Elf64_Sym);
+    append_bytes(&image, symtab.bytes, symtab.size);
+
+    sections[SECTION_STRTAB] = section_header(strtab_name, SHT_STRTAB, 0, image.size,
+                                              strtab.size, 1);
+    append_bytes(&image, strtab.bytes, strtab.size);
+
+    sections[SECTION_SHSTRTAB] = section_header(shstrtab_name, SHT_STRTAB, 0, image.size,
+                                                shstrtab.size, 1);
+    append_bytes(&image, shstrtab.bytes, shstrtab.size);
+
+    sections[SECTION_NOTE_STACK] = section_header(note_name, SHT_PROGBITS, 0, image.size, 0, 1);
+
+    // Section header table last; patch its offset into the ELF header
+    align_image(&image, 8);
+    Elf64_Off section_offset = image.size;
+    memcpy(image.bytes + offsetof(Elf64_Ehdr, e_shoff), &section_offset, sizeof(section_offset));
+    append_bytes(&image, sections, sizeof(sections));
+
+    free_machine_code(&strtab);
+    free_machine_code(&shstrtab);
+    free_machine_code(&symtab);
+
+    FILE* file = fopen(output_file, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create object file %s\n", output_file);
+        free_machine_code(&image);
+        return -1;
+    }
+    size_t written = fwrite(image.bytes, 1, image.size, file);
+    int result = fclose(file) == 0 && written == image.size ? 0 : -1;
+    if (result != 0) {
+        fprintf(stderr, "Error: Cannot write object file %s\n", output_file);
+    }
+    free_machine_code(&image);
+    return result;
+}
+
+// Move the last count instructions of the buffer to its front
+static void move_to_front(CodeGenContext* ctx, int count) {
+    Instruction moved[2];
+    int body_count = ctx->instruction_count - count;
+    memcpy(moved, ctx->instructions + body_count, count * sizeof(Instruction));
+    memmove(ctx->instructions + count, ctx->instructions, body_count * sizeof(Instruction));
+    memcpy(ctx->instructions, moved, count * sizeof(Instruction));
+}
+
+int write_program_object(CodeGenContext* ctx, const char* output_file) {
+    if (!ctx || ctx->target != TARGET_X86_64) return -1;
+
+    printf("┌─ WRITING OBJECT FILE\n");
+    printf("│\n");
+
+    // The frame setup and exit that generate_assembly prints around the
+    // body, as instructions so the encoder sees them
+    Operand rax = {.type = OPERAND_REGISTER, .value.reg = REG_RAX};
+    Operand rbx = {.type = OPERAND_REGISTER, .value.reg = REG_RBX};
+    Operand rdi = {.type = OPERAND_REGISTER, .value.reg = REG_RDI};
+    Operand rsp = {.type = OPERAND_REGISTER, .value.reg = REG_RSP};
+    Operand frame = {.type = OPERAND_IMMEDIATE, .value.immediate = ctx->stack_offset};
+    Operand sys_exit = {.type = OPERAND_IMMEDIATE, .value.immediate = 60};
+    Operand status = {.type = OPERAND_IMMEDIATE, .value.immediate = 0};
+    if (ctx->stack_offset > 0) {
+        emit_instruction(ctx, INST_MOV, 2, rbx, rsp);
+        emit_instruction(ctx, INST_SUB, 2, rsp, frame);
+        move_to_front(ctx, 2);
+    }
+    emit_instruction(ctx, INST_MOV, 2, rax, sys_exit);
+    emit_instruction(ctx, INST_MOV, 2, rdi, status);
+    emit_instruction(ctx, INST_SYSCALL, 0);
+
+    MachineCode text;
+    if (encode_x86_64(ctx, &text) != 0) {
+        printf("└─\n\n");
+        return -1;
+    }
+
+    // Variables live in the frame, so _start is the only symbol
+    ObjectSymbol start = {"_start", SECTION_TEXT, 0, 0, STT_NOTYPE, 1};
+    int result = write_elf_object(output_file, &text, &start, 1);
+    if (result == 0) {
+        printf("│ ✓ .text: %zu bytes of machine code\n", text.size);
+        printf("│ ✓ Written to %s\n", output_file);
+    }
+    printf("│\n");
+    printf("└─\n\n");
+
+    free_machine_code(&text);
+    return result;
+}
+
+int write_rule_object(const CodeGenContext* ctx, const char* function_name,
+                      const char* output_file) {
+    MachineCode text;
+    if (encode_x86_64(ctx, &text) != 0) return -1;
+
+    ObjectSymbol symbol = {function_name, SECTION_TEXT, 0, text.size, STT_FUNC, 1};
+    int result = write_elf_object(output_file, &text, &symbol, 1);
+    free_machine_code(&text);
+    return result;
+}
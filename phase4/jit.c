@@ -0,0 +1,149 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "code_generator.h"
+
+// In-process JIT. The program is compiled exactly as for -f: function
+// mode, register allocation, peephole pass and the rule-function wrapper.
+// The instruction buffer is then encoded straight to machine code, copied
+// into a fresh read-write mapping and flipped to read-execute, so no page
+// is ever writable and executable at once. The rule function references
+// nothing outside itself (its variables live in its stack frame), so the
+// only relocations are its own labels, which the encoder resolves.
+
+static double elapsed_microseconds(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e6 + (now.tv_nsec - start->tv_nsec) / 1e3;
+}
+
+// Copy the input and output names and input values out of the context,
+// which is freed once the code is mapped
+static int copy_interface(JitRule* rule, const CodeGenContext* ctx) {
+    for (int i = 0; i < ctx->symbol_count; i++) {
+        if (ctx->symbols[i].is_input) {
+            rule->input_count++;
+        } else if (!ctx->symbols[i].is_bound) {
+            rule->output_count++;
+        }
+    }
+
+    rule->input_names = malloc((rule->input_count + 1) * sizeof(const char*));
+    rule->output_names = malloc((rule->output_count + 1) * sizeof(const char*));
+    rule->input_values = malloc(rule->input_count + 1);
+    if (!rule->input_names || !rule->output_names || !rule->input_values) {
+        return -1;
+    }
+
+    int inputs = 0, outputs = 0;
+    for (int i = 0; i < ctx->symbol_count; i++) {
+        const struct SymbolMap* sym = &ctx->symbols[i];
+        if (sym->is_bound) continue;
+        const char* name = strdup(sym->name);
+        if (!name) return -1;
+        if (sym->is_input) {
+            rule->input_values[inputs] = (uint8_t)sym->input_value;
+            rule->input_names[inputs++] = name;
+        } else {
+            rule->output_names[outputs++] = name;
+        }
+    }
+    return 0;
+}
+
+JitRule* jit_compile_rule(const AST* ast, int peephole_window) {
+    if (!ast) return NULL;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    printf("┌─ JIT COMPILATION\n");
+    printf("│\n");
+
+    CodeGenContext* ctx = compile_rule_function(ast, peephole_window);
+    if (!ctx) return NULL;
+    MachineCode code;
+    if (encode_x86_64(ctx, &code) != 0) {
+        free_codegen_context(ctx);
+        return NULL;
+    }
+
+    JitRule* rule = calloc(1, sizeof(JitRule));
+    if (!rule || copy_interface(rule, ctx) != 0) {
+        fprintf(stderr, "Out of memory for JIT rule\n");
+        exit(1);
+    }
+    free_codegen_context(ctx);
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    rule->code_size = code.size;
+    rule->mapped_size = (code.size + page - 1) / page * page;
+    void* memory = mmap(NULL, rule->mapped_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        perror("mmap");
+        free_machine_code(&code);
+        rule->mapped_size = 0;
+        jit_free_rule(rule);
+        return NULL;
+    }
+    memcpy(memory, code.bytes, code.size);
+    free_machine_code(&code);
+    rule->code = memory;
+    if (mprotect(memory, rule->mapped_size, PROT_READ | PROT_EXEC) != 0) {
+        perror("mprotect");
+        jit_free_rule(rule);
+        return NULL;
+    }
+    // Object to function pointer: allowed by POSIX, not by ISO C
+    memcpy(&rule->eval, &memory, sizeof(rule->eval));
+
+    printf("│ Machine code: %zu bytes at %p (%zu mapped, read-execute)\n", rule->code_size,
+           memory, rule->mapped_size);
+    printf("│ Ready in %.1f us\n", elapsed_microseconds(&start));
+    printf("│\n");
+    printf("└─\n\n");
+    return rule;
+}
+
+void jit_free_rule(JitRule* rule) {
+    if (!rule) return;
+    if (rule->code) {
+        munmap(rule->code, rule->mapped_size);
+    }
+    for (int i = 0; rule->input_names && i < rule->input_count; i++) {
+        free((void*)rule->input_names[i]);
+    }
+    for (int i = 0; rule->output_names && i < rule->output_count; i++) {
+        free((void*)rule->output_names[i]);
+    }
+    free(rule->input_names);
+    free(rule->output_names);
+    free(rule->input_values);
+    free(rule);
+}
+
+int jit_run_declared(const JitRule* rule) {
+    uint8_t* outputs = calloc(rule->output_count + 1, 1);
+    if (!outputs) {
+        fprintf(stderr, "Out of memory for JIT outputs\n");
+        exit(1);
+    }
+
+    int result = rule->eval(rule->input_values, outputs);
+
+    printf("JIT RUN: %d inputs at their declared values\n", rule->input_count);
+    for (int i = 0; i < rule->input_count; i++) {
+        printf("  %-16s %s (input)\n", rule->input_names[i], rule->input_values[i] ? "TRUE" : "FALSE");
+    }
+    for (int i = 0; i < rule->output_count; i++) {
+        printf("  %-16s %s\n", rule->output_names[i], outputs[i] ? "TRUE" : "FALSE");
+    }
+    printf("  Result: %d\n\n", result);
+    free(outputs);
+    return result;
+}
@@ -3,14 +3,17 @@
 #include <string.h>
 #include <unistd.h>
 #include "code_generator.h"
+#include "bytecode.h"
+#include "rule_image.h"
+#include "ast_file.h"
 
 // External function declarations
-extern ASTNode* load_annotated_ast(const char* filename);
-extern int generate_assembly(CodeGenContext* ctx, ASTNode* ast, const char* output_file);
+extern AST* load_annotated_ast(const char* filename);
+extern int generate_assembly(CodeGenContext* ctx, const AST* ast, const char* output_file);
 
 void print_header() {
     printf("CODE GENERATION\n");
-    printf("Input:  annotated_ast.txt - from Phase 3\n");
+    printf("Input:  annotated_ast.bin - from Phase 3\n");
     printf("Output: program.s (x86_64 Assembly)\n");
     printf("\n\n");
 }
@@ -19,6 +22,17 @@ void print_input_file_info(const char* filename) {
     printf("INPUT FILE: %s\n", filename);
     printf("\n");
     
+    AstFileHeader header;
+    if (read_ast_file_header(filename, &header) == 0) {
+        printf("Binary AST, version %u%s\n", header.version,
+               header.flags & AST_FILE_ANNOTATED ? " (annotated)" : " (not annotated)");
+        printf("Total nodes: %u\n", header.node_count);
+        printf("Statements: %u\n", header.statement_count);
+        printf("Symbol references: %u\n", header.symbol_count);
+        printf("\n\n");
+        return;
+    }
+    
     FILE* file = fopen(filename, "r");
     if (!file) {
         printf("[ERROR: Cannot read annotated AST file]\n");
@@ -85,7 +99,7 @@ void print_compilation_options() {
     printf("Linker: GNU ld\n");
     printf("Output Format: ELF64\n");
     printf("\n");
-    printf("Optimization Level: -O0 (none)\n");
+    printf("Optimization: register allocation, peephole (window %d)\n", DEFAULT_PEEPHOLE_WINDOW);
     printf("Debug Information: Included\n");
     printf("Symbol Table: Generated\n");
     printf("\n\n");
@@ -166,24 +180,57 @@ void print_build_instructions() {
     printf(" 1. Compile:   gcc program.s -o program\n");
     printf(" 2. Run:       ./program\n");
     printf("\n");
+    printf(" Without as (--object writes program.o directly):\n");
+    printf(" 1. Link:      ld program.o -o program\n");
+    printf(" 2. Run:       ./program\n");
+    printf("\n");
     printf("\n\n");
 }
 
 int main(int argc, char* argv[]) {
     print_header();
     
-    // Determine input file
-    const char* input_file = "annotated_ast.txt";  // Default
-    if (argc > 1) {
-        input_file = argv[1];
-        printf("Using input file: %s\n\n", input_file);
+    // Determine input file; --batch writes batch kernels, --function
+    // PREFIX a callable rule function and --jit runs the rule in process
+    // instead. --object also writes program.o without running as;
+    // --interpret runs the bytecode VM and --benchmark N times it against
+    // the JIT; --image FILE writes a rule image for mmap-loading hosts.
+    const char* input_file = "annotated_ast.bin";  // Default
+    const char* function_prefix = NULL;
+    int batch = 0;
+    int jit = 0;
+    int object = 0;
+    int interpret = 0;
+    long benchmark_count = 0;
+    const char* image_file = NULL;
+    int explicit_input = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--batch") == 0) {
+            batch = 1;
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            jit = 1;
+        } else if (strcmp(argv[i], "--object") == 0) {
+            object = 1;
+        } else if (strcmp(argv[i], "--interpret") == 0) {
+            interpret = 1;
+        } else if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+            benchmark_count = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc) {
+            image_file = argv[++i];
+        } else if (strcmp(argv[i], "--function") == 0 && i + 1 < argc) {
+            function_prefix = argv[++i];
+        } else {
+            input_file = argv[i];
+            explicit_input = 1;
+            printf("Using input file: %s\n\n", input_file);
+        }
     }
     
     // Check if input file exists
     if (access(input_file, F_OK) != 0) {
         printf("ERROR: %s not found!\n", input_file);
-        if (argc == 1) {
-            printf("Please run Phase 3 first to generate annotated_ast.txt\n");
+        if (!explicit_input) {
+            printf("Please run Phase 3 first to generate annotated_ast.bin\n");
         } else {
             printf("Please check the file path and try again\n");
         }
@@ -198,17 +245,97 @@ int main(int argc, char* argv[]) {
     print_compilation_options();
     
     // Load annotated AST
-    ASTNode* ast = load_annotated_ast(input_file);
+    AST* ast = load_annotated_ast(input_file);
     if (!ast) {
         printf("PHASE 4 FAILED: Could not load annotated AST\n\n");
         return 1;
     }
     
+    if (batch) {
+        int result = generate_batch_kernels(ast, "batch.s", DEFAULT_PEEPHOLE_WINDOW);
+        free_asts();
+        free_interned_symbols();
+        if (result != 0) {
+            printf("PHASE 4 FAILED: Code generation errors occurred\n\n");
+            return 1;
+        }
+        printf("Batch kernels written to batch.s\n");
+        printf("Assemble with: gcc -c batch.s, and call logic_batch(lanes, blocks)\n");
+        printf("Or link a streaming evaluator: cc -O2 -o evaluator stream_runtime.c batch.s\n\n");
+        return 0;
+    }
+    
+    if (image_file) {
+        int result = write_rule_image(ast, image_file, DEFAULT_PEEPHOLE_WINDOW, 1);
+        free_asts();
+        free_interned_symbols();
+        if (result != 0) {
+            printf("PHASE 4 FAILED: Could not write %s\n\n", image_file);
+            return 1;
+        }
+        printf("Rule image written to %s\n", image_file);
+        printf("Load it with: logicc -l %s\n\n", image_file);
+        return 0;
+    }
+    
+    if (interpret || benchmark_count > 0) {
+        int result = -1;
+        if (benchmark_count > 0) {
+            result = benchmark_rule(ast, benchmark_count, DEFAULT_PEEPHOLE_WINDOW);
+        } else {
+            Bytecode* bytecode = compile_bytecode(ast);
+            if (bytecode) {
+                vm_run_declared(bytecode);
+                free_bytecode(bytecode);
+                result = 0;
+            }
+        }
+        free_asts();
+        free_interned_symbols();
+        if (result != 0) {
+            printf("PHASE 4 FAILED: Bytecode errors occurred\n\n");
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (jit) {
+        JitRule* rule = jit_compile_rule(ast, DEFAULT_PEEPHOLE_WINDOW);
+        free_asts();
+        free_interned_symbols();
+        if (!rule) {
+            printf("PHASE 4 FAILED: Code generation errors occurred\n\n");
+            return 1;
+        }
+        jit_run_declared(rule);
+        jit_free_rule(rule);
+        return 0;
+    }
+    
+    if (function_prefix) {
+        char assembly_file[512], header_file[512], object_file[512];
+        snprintf(assembly_file, sizeof(assembly_file), "%s.s", function_prefix);
+        snprintf(header_file, sizeof(header_file), "%s.h", function_prefix);
+        snprintf(object_file, sizeof(object_file), "%s.o", function_prefix);
+        int result = generate_rule_function(ast, function_prefix, assembly_file, header_file,
+                                            object_file, DEFAULT_PEEPHOLE_WINDOW);
+        free_asts();
+        free_interned_symbols();
+        if (result != 0) {
+            printf("PHASE 4 FAILED: Code generation errors occurred\n\n");
+            return 1;
+        }
+        printf("Rule function written to %s and %s, declared in %s\n", assembly_file,
+               object_file, header_file);
+        printf("Build a library with: ar rcs lib%s.a %s\n\n", function_prefix, object_file);
+        return 0;
+    }
+    
     // Create code generation context
     CodeGenContext* ctx = create_codegen_context(TARGET_X86_64);
     if (!ctx) {
         printf("PHASE 4 FAILED: Could not create code generation context\n\n");
-        free_ast_node(ast);
+        free_asts();
         return 1;
     }
     
@@ -219,19 +346,18 @@ int main(int argc, char* argv[]) {
     if (result != 0) {
         printf("PHASE 4 FAILED: Code generation errors occurred\n\n");
         free_codegen_context(ctx);
-        free_ast_node(ast);
+        free_asts();
         return 1;
     }
     
     // Display generated code information
     print_generated_code_info(output_file);
     
-    // Count symbols
-    int symbol_count = 0;
-    struct SymbolMap* sym = ctx->symbol_map;
-    while (sym) {
-        symbol_count++;
-        sym = sym->next;
+    if (object && write_program_object(ctx, "program.o") != 0) {
+        printf("PHASE 4 FAILED: Could not write program.o\n\n");
+        free_codegen_context(ctx);
+        free_asts();
+        return 1;
     }
     
     // Print build instructions
@@ -241,7 +367,8 @@ int main(int argc, char* argv[]) {
 
     // Cleanup
     free_codegen_context(ctx);
-    free_ast_node(ast);
+    free_asts();
+    free_interned_symbols();
     
     return 0;
 }
\ No newline at end of file
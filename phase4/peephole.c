@@ -0,0 +1,339 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "code_generator.h"
+
+// Peephole optimization over the allocated instruction buffer. Each rule
+// looks at one instruction and at most peephole_window live instructions
+// after it. Memory operands are all RBX-relative with constant offsets, so
+// two memory operands alias exactly when their offsets are equal.
+//
+// Registers are treated as live at anything other than a move, an ALU,
+// shift or bit instruction, and at the end of a program; a batch kernel
+// body returns nothing in registers and a rule function only RAX. Flag
+// words and lanes hold the results and stay live at the end; spill slots
+// are temporaries and do not.
+
+typedef struct {
+    CodeGenContext* ctx;
+    uint8_t* removed;           // Instructions deleted in this pass
+    int window;
+} Peephole;
+
+typedef struct {
+    const char* name;
+    int (*apply)(Peephole* p, int index);
+} PeepholeRule;
+
+static int rule_forward_store(Peephole* p, int index);
+static int rule_dead_store(Peephole* p, int index);
+static int rule_coalesce_move(Peephole* p, int index);
+static int rule_idiom(Peephole* p, int index);
+static int rule_fuse_andn(Peephole* p, int index);
+
+// Rules in the order they are tried at each instruction
+static const PeepholeRule peephole_rules[] = {
+    {"store-to-load forwarding", rule_forward_store},
+    {"dead-store elimination",   rule_dead_store},
+    {"move coalescing",          rule_coalesce_move},
+    {"idiom replacement",        rule_idiom},
+    {"and-not fusion",           rule_fuse_andn},
+};
+
+#define PEEPHOLE_RULE_COUNT (int)(sizeof(peephole_rules) / sizeof(peephole_rules[0]))
+#define PEEPHOLE_MAX_PASSES 8
+
+// An operand slot viewed as a location: register, immediate or memory
+typedef struct {
+    uint8_t kind;
+    uint8_t base;
+    int32_t value;
+} Location;
+
+static Location operand_location(const Instruction* inst, int index) {
+    Location loc = {inst->kinds[index], inst->bases[index], inst->values[index]};
+    if (loc.kind != OPERAND_MEMORY) loc.base = 0;
+    return loc;
+}
+
+static int same_location(Location a, Location b) {
+    return a.kind == b.kind && a.base == b.base && a.value == b.value;
+}
+
+static void set_operand(Instruction* inst, int index, Location loc) {
+    inst->kinds[index] = loc.kind;
+    inst->bases[index] = loc.base;
+    inst->values[index] = loc.value;
+}
+
+// Two-operand moves and ALU instructions; anything else ends a scan
+static int is_simple(const Instruction* inst) {
+    switch ((InstructionType)inst->type) {
+        case INST_MOV:
+        case INST_ADD:
+        case INST_SUB:
+        case INST_AND:
+        case INST_OR:
+        case INST_XOR:
+        case INST_CMP:
+        case INST_TEST:
+        case INST_SHL:
+        case INST_SHR:
+        case INST_BTS:
+        case INST_BTR:
+        case INST_ANDN:
+            return inst->operand_count == 2;
+        case INST_NOT:
+        case INST_NEG:
+            return inst->operand_count == 1;
+        default:
+            return 0;
+    }
+}
+
+// xor r, r sets r to zero without reading it
+static int is_zeroing(const Instruction* inst) {
+    return inst->type == INST_XOR && inst->kinds[0] == OPERAND_REGISTER &&
+           same_location(operand_location(inst, 0), operand_location(inst, 1));
+}
+
+static int writes_destination(const Instruction* inst) {
+    return inst->type != INST_CMP && inst->type != INST_TEST;
+}
+
+static int reads_destination(const Instruction* inst) {
+    return inst->type != INST_MOV && !is_zeroing(inst);
+}
+
+// Whether a simple instruction reads loc, directly or as a memory base
+static int reads_location(const Instruction* inst, Location loc) {
+    for (int i = 0; i < inst->operand_count; i++) {
+        Location op = operand_location(inst, i);
+        if (loc.kind == OPERAND_REGISTER && op.kind == OPERAND_MEMORY && op.base == loc.value) {
+            return 1;
+        }
+        if (!same_location(op, loc)) continue;
+        if (i > 0 || inst->operand_count == 1 || reads_destination(inst)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int writes_location(const Instruction* inst, Location loc) {
+    return writes_destination(inst) && same_location(operand_location(inst, 0), loc);
+}
+
+static int next_live(const Peephole* p, int index) {
+    do {
+        index++;
+    } while (index < p->ctx->instruction_count && p->removed[index]);
+    return index;
+}
+
+static int is_spill_slot(const Peephole* p, Location loc) {
+    return loc.kind == OPERAND_MEMORY && loc.base == REG_RBX && -loc.value > p->ctx->variable_size;
+}
+
+// Whether loc's value is dead after instruction index: overwritten before
+// any read within the window, or never read again
+static int dead_after(const Peephole* p, int index, Location loc) {
+    int limit = p->window;
+    int i = next_live(p, index);
+    for (; i < p->ctx->instruction_count && limit > 0; i = next_live(p, i), limit--) {
+        const Instruction* inst = &p->ctx->instructions[i];
+        if (!is_simple(inst)) return 0;
+        if (reads_location(inst, loc)) return 0;
+        if (writes_location(inst, loc)) return 1;
+    }
+    if (i < p->ctx->instruction_count) return 0;
+    if (loc.kind == OPERAND_REGISTER) {
+        return IS_BATCH_MODE(p->ctx->mode) ||
+               (p->ctx->mode == CODEGEN_FUNCTION && loc.value != REG_RAX);
+    }
+    return is_spill_slot(p, loc);
+}
+
+// mov M, x followed by a read of M with neither M nor x changed in
+// between: the read takes x instead, so mov r, M becomes mov r, x
+static int rule_forward_store(Peephole* p, int index) {
+    const Instruction* store = &p->ctx->instructions[index];
+    if (store->type != INST_MOV || store->kinds[0] != OPERAND_MEMORY ||
+        store->kinds[1] == OPERAND_MEMORY) {
+        return 0;
+    }
+    Location slot = operand_location(store, 0);
+    Location value = operand_location(store, 1);
+
+    int hits = 0;
+    int limit = p->window;
+    for (int i = next_live(p, index); i < p->ctx->instruction_count && limit > 0;
+         i = next_live(p, i), limit--) {
+        Instruction* inst = &p->ctx->instructions[i];
+        if (!is_simple(inst)) break;
+        if (inst->operand_count == 2 && same_location(operand_location(inst, 1), slot)) {
+            set_operand(inst, 1, value);
+            hits++;
+        }
+        if (writes_location(inst, slot) || writes_location(inst, value)) break;
+    }
+    return hits;
+}
+
+// mov M, x whose value is overwritten before being read, or a spill slot
+// that is never read again
+static int rule_dead_store(Peephole* p, int index) {
+    const Instruction* store = &p->ctx->instructions[index];
+    if (store->type != INST_MOV || store->kinds[0] != OPERAND_MEMORY) return 0;
+
+    if (!dead_after(p, index, operand_location(store, 0))) return 0;
+    p->removed[index] = 1;
+    return 1;
+}
+
+// mov r, x: dropped when r is a self-move or dead, or folded into the one
+// instruction that reads r when r dies there and x is unchanged until then
+static int rule_coalesce_move(Peephole* p, int index) {
+    const Instruction* move = &p->ctx->instructions[index];
+    if (move->type != INST_MOV || move->kinds[0] != OPERAND_REGISTER) return 0;
+    Location reg = operand_location(move, 0);
+    Location source = operand_location(move, 1);
+
+    if (same_location(reg, source)) {
+        p->removed[index] = 1;
+        return 1;
+    }
+
+    // Find the next instruction that touches r
+    int limit = p->window;
+    int i = next_live(p, index);
+    for (; i < p->ctx->instruction_count && limit > 0; i = next_live(p, i), limit--) {
+        const Instruction* inst = &p->ctx->instructions[i];
+        if (!is_simple(inst)) return 0;
+        if (reads_location(inst, reg) || writes_location(inst, reg)) break;
+        if (writes_location(inst, source)) return 0;
+    }
+    if (i >= p->ctx->instruction_count || limit == 0) return 0;
+
+    Instruction* user = &p->ctx->instructions[i];
+    if (!reads_location(user, reg)) {
+        p->removed[index] = 1; // Overwritten before use
+        return 1;
+    }
+
+    // r must be read only as the source, and the source must fit there
+    if (user->operand_count != 2 || same_location(operand_location(user, 0), reg) ||
+        !same_location(operand_location(user, 1), reg)) {
+        return 0;
+    }
+    // x86 takes at most one memory operand, and vpandn's complemented one
+    // must be a register
+    if (source.kind == OPERAND_MEMORY &&
+        (user->kinds[0] == OPERAND_MEMORY || user->type == INST_ANDN)) {
+        return 0;
+    }
+    if (!dead_after(p, i, reg)) return 0;
+
+    set_operand(user, 1, source);
+    p->removed[index] = 1;
+    return 1;
+}
+
+// mov $0, r becomes xor r, r; or/xor with 0 and and/or of a register with
+// itself are dropped
+static int rule_idiom(Peephole* p, int index) {
+    Instruction* inst = &p->ctx->instructions[index];
+    if (inst->operand_count != 2 || inst->kinds[0] != OPERAND_REGISTER) return 0;
+    Location dest = operand_location(inst, 0);
+    Location source = operand_location(inst, 1);
+    int zero = source.kind == OPERAND_IMMEDIATE && source.value == 0;
+
+    if (inst->type == INST_MOV && zero) {
+        inst->type = INST_XOR;
+        set_operand(inst, 1, dest);
+        return 1;
+    }
+    if (((inst->type == INST_OR || inst->type == INST_XOR) && zero) ||
+        ((inst->type == INST_AND || inst->type == INST_OR) && same_location(dest, source))) {
+        p->removed[index] = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// xor $1, s (NOT s) followed by and s, r where s dies: r = r AND NOT s,
+// a single vpandn. Only batch AVX2 code has an and-not instruction.
+static int rule_fuse_andn(Peephole* p, int index) {
+    const Instruction* complement = &p->ctx->instructions[index];
+    if (p->ctx->mode != CODEGEN_BATCH_AVX2 || complement->type != INST_XOR ||
+        complement->kinds[0] != OPERAND_REGISTER || complement->kinds[1] != OPERAND_IMMEDIATE ||
+        complement->values[1] != 1) {
+        return 0;
+    }
+    Location reg = operand_location(complement, 0);
+    
+    // Find the next instruction that touches s
+    int limit = p->window;
+    int i = next_live(p, index);
+    for (; i < p->ctx->instruction_count && limit > 0; i = next_live(p, i), limit--) {
+        const Instruction* inst = &p->ctx->instructions[i];
+        if (!is_simple(inst)) return 0;
+        if (reads_location(inst, reg) || writes_location(inst, reg)) break;
+    }
+    if (i >= p->ctx->instruction_count || limit == 0) return 0;
+    
+    Instruction* user = &p->ctx->instructions[i];
+    if (user->type != INST_AND || user->kinds[0] != OPERAND_REGISTER ||
+        same_location(operand_location(user, 0), reg) ||
+        !same_location(operand_location(user, 1), reg) || !dead_after(p, i, reg)) {
+        return 0;
+    }
+    
+    user->type = INST_ANDN;
+    p->removed[index] = 1;
+    return 1;
+}
+
+void optimize_peephole(CodeGenContext* ctx) {
+    if (ctx->peephole_window <= 0 || ctx->instruction_count == 0) return;
+
+    Peephole p = {ctx, NULL, ctx->peephole_window};
+    p.removed = calloc(ctx->instruction_count, 1);
+    if (!p.removed) {
+        fprintf(stderr, "Out of memory for peephole optimization\n");
+        exit(1);
+    }
+
+    int before = ctx->instruction_count;
+    int hits[PEEPHOLE_RULE_COUNT] = {0};
+    for (int pass = 0; pass < PEEPHOLE_MAX_PASSES; pass++) {
+        int changed = 0;
+        for (int i = 0; i < ctx->instruction_count; i++) {
+            for (int r = 0; r < PEEPHOLE_RULE_COUNT && !p.removed[i]; r++) {
+                int n = peephole_rules[r].apply(&p, i);
+                hits[r] += n;
+                changed += n;
+            }
+        }
+
+        // Compact the buffer
+        int out = 0;
+        for (int i = 0; i < ctx->instruction_count; i++) {
+            if (!p.removed[i]) {
+                ctx->instructions[out++] = ctx->instructions[i];
+            }
+        }
+        ctx->instruction_count = out;
+        memset(p.removed, 0, out);
+
+        if (!changed) break;
+    }
+    free(p.removed);
+
+    printf("│ Peephole (window %d): %d -> %d instructions\n", ctx->peephole_window,
+           before, ctx->instruction_count);
+    for (int r = 0; r < PEEPHOLE_RULE_COUNT; r++) {
+        printf("│   %-26s %d\n", peephole_rules[r].name, hits[r]);
+    }
+}
@@ -0,0 +1,284 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "code_generator.h"
+
+// Linear-scan register allocation over the instruction buffer. Generated
+// code is straight-line, so a virtual register's live interval is simply
+// the range from its first to its last reference. In batch AVX2 mode the
+// same register numbers name ymm registers and slots are 32 bytes.
+
+// Allocation order: caller-saved registers first, then callee-saved. RBX
+// is the variable frame base and never allocated. R11 comes last because
+// it is withheld as the scratch register once anything spills.
+static const Register allocation_order[] = {
+    REG_RAX, REG_RCX, REG_RDX, REG_RSI, REG_RDI, REG_R8, REG_R9, REG_R10,
+    REG_R12, REG_R13, REG_R14, REG_R15, REG_R11
+};
+
+#define ALLOCATABLE_COUNT (int)(sizeof(allocation_order) / sizeof(allocation_order[0]))
+#define SPILL_SCRATCH REG_R11
+
+typedef struct {
+    int vreg;
+    int start;          // First instruction referencing the register
+    int end;            // Last instruction referencing it
+} LiveInterval;
+
+static int is_virtual(const Instruction* inst, int index) {
+    return inst->kinds[index] == OPERAND_REGISTER && inst->values[index] >= REG_VIRTUAL;
+}
+
+static int compare_interval_start(const void* a, const void* b) {
+    const LiveInterval* x = a;
+    const LiveInterval* y = b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return x->vreg - y->vreg;
+}
+
+// Compute the live interval of every referenced virtual register, sorted
+// by start; returns how many there are. interval_of is scratch space
+// indexed by virtual register.
+static int compute_intervals(const CodeGenContext* ctx, LiveInterval* intervals, int32_t* interval_of) {
+    int count = 0;
+    for (int v = 0; v < ctx->virtual_register_count; v++) {
+        interval_of[v] = -1;
+    }
+
+    for (int i = 0; i < ctx->instruction_count; i++) {
+        const Instruction* inst = &ctx->instructions[i];
+        for (int j = 0; j < inst->operand_count; j++) {
+            if (!is_virtual(inst, j)) continue;
+            int v = inst->values[j] - REG_VIRTUAL;
+            if (interval_of[v] < 0) {
+                interval_of[v] = count;
+                intervals[count].vreg = v;
+                intervals[count].start = i;
+                count++;
+            }
+            intervals[interval_of[v]].end = i;
+        }
+    }
+
+    // Registers are mostly created in order of first use, so this is
+    // nearly sorted already
+    qsort(intervals, count, sizeof(LiveInterval), compare_interval_start);
+    return count;
+}
+
+// Give an interval a stack slot below the variables, reusing any slot
+// whose previous interval has ended
+static int32_t assign_spill_slot(CodeGenContext* ctx, const LiveInterval* interval,
+                                 int32_t* slot_offsets, int* slot_ends, int* slot_count) {
+    for (int i = 0; i < *slot_count; i++) {
+        if (slot_ends[i] < interval->start) {
+            slot_ends[i] = interval->end;
+            return -slot_offsets[i];
+        }
+    }
+
+    ctx->stack_offset += ctx->slot_size;
+    slot_offsets[*slot_count] = ctx->stack_offset;
+    slot_ends[*slot_count] = interval->end;
+    (*slot_count)++;
+    return -ctx->stack_offset;
+}
+
+// Assign each interval a register from the first register_limit entries
+// of allocation_order, or a stack slot. location[v] receives the register
+// number, or the (negative) RBX offset of the slot. Returns the number of
+// spilled intervals.
+static int linear_scan(CodeGenContext* ctx, const LiveInterval* intervals, int count,
+                       int register_limit, int32_t* location) {
+    int active[ALLOCATABLE_COUNT];      // Interval indices, by increasing end
+    int active_count = 0;
+    int free_registers[ALLOCATABLE_COUNT];
+    int free_count = 0;
+    for (int i = register_limit - 1; i >= 0; i--) {
+        if (!(ctx->reserved_registers & (1u << allocation_order[i]))) {
+            free_registers[free_count++] = allocation_order[i];
+        }
+    }
+
+    int32_t* slot_offsets = malloc((count + 1) * sizeof(int32_t));
+    int* slot_ends = malloc((count + 1) * sizeof(int));
+    if (!slot_offsets || !slot_ends) {
+        fprintf(stderr, "Out of memory for register allocation\n");
+        exit(1);
+    }
+    int slot_count = 0;
+    int spills = 0;
+
+    for (int i = 0; i < count; i++) {
+        const LiveInterval* current = &intervals[i];
+
+        // Expire intervals ending at or before this start: a register read
+        // by the instruction that starts the next interval can be its
+        // destination
+        int kept = 0;
+        for (int a = 0; a < active_count; a++) {
+            const LiveInterval* old = &intervals[active[a]];
+            if (old->end <= current->start) {
+                free_registers[free_count++] = location[old->vreg];
+            } else {
+                active[kept++] = active[a];
+            }
+        }
+        active_count = kept;
+
+        int assigned = i;
+        if (free_count > 0) {
+            location[current->vreg] = free_registers[--free_count];
+        } else {
+            // Spill whichever of the current and the active intervals
+            // ends last
+            const LiveInterval* last = &intervals[active[active_count - 1]];
+            if (last->end > current->end) {
+                location[current->vreg] = location[last->vreg];
+                location[last->vreg] = assign_spill_slot(ctx, last, slot_offsets, slot_ends, &slot_count);
+                active_count--;
+            } else {
+                location[current->vreg] = assign_spill_slot(ctx, current, slot_offsets, slot_ends, &slot_count);
+                assigned = -1;
+            }
+            spills++;
+        }
+
+        if (assigned >= 0) {
+            int pos = active_count++;
+            while (pos > 0 && intervals[active[pos - 1]].end > current->end) {
+                active[pos] = active[pos - 1];
+                pos--;
+            }
+            active[pos] = assigned;
+        }
+    }
+
+    free(slot_offsets);
+    free(slot_ends);
+    return spills;
+}
+
+// Replace a virtual register operand with its assigned location
+static void rewrite_operand(Instruction* inst, int index, const int32_t* location) {
+    if (!is_virtual(inst, index)) return;
+
+    int32_t loc = location[inst->values[index] - REG_VIRTUAL];
+    if (loc >= 0) {
+        inst->values[index] = loc;
+    } else {
+        inst->kinds[index] = OPERAND_MEMORY;
+        inst->bases[index] = REG_RBX;
+        inst->values[index] = loc;
+    }
+}
+
+static int same_operand(const Instruction* inst, int a, int b) {
+    return inst->kinds[a] == inst->kinds[b] && inst->values[a] == inst->values[b] &&
+           (inst->kinds[a] != OPERAND_MEMORY || inst->bases[a] == inst->bases[b]);
+}
+
+// A move between the scratch register and memory operand index of inst:
+// a load into the scratch register if load is set, else a store from it
+static Instruction scratch_move(const Instruction* inst, int index, int load) {
+    Instruction move;
+    memset(&move, 0, sizeof(Instruction));
+    move.type = INST_MOV;
+    move.operand_count = 2;
+    int reg = load ? 0 : 1;
+    move.kinds[reg] = OPERAND_REGISTER;
+    move.values[reg] = SPILL_SCRATCH;
+    move.kinds[1 - reg] = OPERAND_MEMORY;
+    move.bases[1 - reg] = inst->bases[index];
+    move.values[1 - reg] = inst->values[index];
+    move.comment = NO_TEXT;
+    return move;
+}
+
+void allocate_registers(CodeGenContext* ctx) {
+    int count = ctx->virtual_register_count;
+    if (count == 0) return;
+
+    LiveInterval* intervals = malloc(count * sizeof(LiveInterval));
+    int32_t* location = malloc(count * sizeof(int32_t));
+    if (!intervals || !location) {
+        fprintf(stderr, "Out of memory for register allocation\n");
+        exit(1);
+    }
+    count = compute_intervals(ctx, intervals, location);
+
+    // Try the whole register set first; if anything spills, redo the
+    // scan without the scratch register that memory-to-memory moves need
+    int frame_size = ctx->stack_offset;
+    int spills = linear_scan(ctx, intervals, count, ALLOCATABLE_COUNT, location);
+    if (spills > 0) {
+        ctx->stack_offset = frame_size;
+        spills = linear_scan(ctx, intervals, count, ALLOCATABLE_COUNT - 1, location);
+    }
+    ctx->spill_count = spills;
+
+    // Rewrite the buffer. Moves that became self-moves are dropped, and an
+    // instruction left with two memory operands loads its source into the
+    // scratch register first. AVX2 instructions other than moves cannot
+    // write memory, so in batch AVX2 mode a spilled destination is loaded
+    // into the scratch register, operated on and stored back.
+    int out = 0;
+    int capacity = ctx->instruction_capacity;
+    Instruction* rewritten = malloc(capacity * sizeof(Instruction));
+    if (!rewritten) {
+        fprintf(stderr, "Out of memory for register allocation\n");
+        exit(1);
+    }
+    for (int i = 0; i < ctx->instruction_count; i++) {
+        Instruction inst = ctx->instructions[i];
+        for (int j = 0; j < inst.operand_count; j++) {
+            rewrite_operand(&inst, j, location);
+        }
+
+        if (inst.type == INST_MOV && inst.operand_count == 2 && same_operand(&inst, 0, 1)) {
+            continue;
+        }
+
+        if (out + 3 > capacity) {
+            capacity *= 2;
+            rewritten = realloc(rewritten, capacity * sizeof(Instruction));
+            if (!rewritten) {
+                fprintf(stderr, "Out of memory for register allocation\n");
+                exit(1);
+            }
+        }
+
+        if (ctx->mode == CODEGEN_BATCH_AVX2 && inst.type != INST_MOV &&
+            inst.kinds[0] == OPERAND_MEMORY) {
+            rewritten[out++] = scratch_move(&inst, 0, 1);
+            Instruction store = scratch_move(&inst, 0, 0);
+            inst.kinds[0] = OPERAND_REGISTER;
+            inst.bases[0] = 0;
+            inst.values[0] = SPILL_SCRATCH;
+            rewritten[out++] = inst;
+            rewritten[out++] = store;
+            continue;
+        }
+        
+        if (inst.operand_count == 2 && inst.kinds[0] == OPERAND_MEMORY &&
+            inst.kinds[1] == OPERAND_MEMORY) {
+            rewritten[out++] = scratch_move(&inst, 1, 1);
+
+            inst.kinds[1] = OPERAND_REGISTER;
+            inst.bases[1] = 0;
+            inst.values[1] = SPILL_SCRATCH;
+        }
+        rewritten[out++] = inst;
+    }
+
+    free(ctx->instructions);
+    ctx->instructions = rewritten;
+    ctx->instruction_count = out;
+    ctx->instruction_capacity = capacity;
+
+    printf("│ Register allocation: %d virtual registers, %d spilled\n", count, spills);
+
+    free(intervals);
+    free(location);
+}
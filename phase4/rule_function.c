@@ -0,0 +1,275 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <ctype.h>
+#include "code_generator.h"
+
+// Rule functions. The program is compiled as it would be for _start, over
+// flag words below RBX, and wrapped in a System V function:
+//
+//     int <prefix>_eval(const uint8_t* inputs, uint8_t* outputs);
+//
+// The prologue saves RBX and whichever of R12-R15 the body uses, clears
+// the flag words and sets each input's bit from its byte (any nonzero
+// byte is TRUE). The epilogue writes every other variable to its output
+// byte as 0 or 1. Inputs and outputs are numbered separately, in
+// order of first appearance, and the generated header names each index.
+// An input has no output, so a program that assigns one again is rejected
+// rather than compiled with that assignment lost.
+// The prologue and epilogue are instructions around the body in the same
+// buffer, so the assembly writer and the JIT emit identical code.
+
+static const Register callee_saved[] = {REG_RBX, REG_R12, REG_R13, REG_R14, REG_R15};
+#define CALLEE_SAVED_COUNT (int)(sizeof(callee_saved) / sizeof(callee_saved[0]))
+
+// Callee-saved registers the function must preserve: RBX, the frame base,
+// and any the allocator handed out
+static int saved_registers(const CodeGenContext* ctx, Register* saved) {
+    uint32_t used = 1u << REG_RBX;
+    for (int i = 0; i < ctx->instruction_count; i++) {
+        const Instruction* inst = &ctx->instructions[i];
+        for (int j = 0; j < inst->operand_count; j++) {
+            if (inst->kinds[j] == OPERAND_REGISTER) used |= 1u << inst->values[j];
+            if (inst->kinds[j] == OPERAND_MEMORY) used |= 1u << inst->bases[j];
+        }
+    }
+
+    int count = 0;
+    for (int i = 0; i < CALLEE_SAVED_COUNT; i++) {
+        if (used & (1u << callee_saved[i])) saved[count++] = callee_saved[i];
+    }
+    return count;
+}
+
+// The prefix becomes part of C identifiers and file names
+static int valid_prefix(const char* prefix) {
+    if (!prefix[0] || !(isalpha((unsigned char)prefix[0]) || prefix[0] == '_')) return 0;
+    for (const char* c = prefix; *c; c++) {
+        if (!isalnum((unsigned char)*c) && *c != '_') return 0;
+    }
+    return 1;
+}
+
+static void write_upper(FILE* file, const char* text) {
+    for (const char* c = text; *c; c++) {
+        fputc(toupper((unsigned char)*c), file);
+    }
+}
+
+static int write_header(const CodeGenContext* ctx, const char* prefix, const char* header_file) {
+    FILE* file = fopen(header_file, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create header file %s\n", header_file);
+        return -1;
+    }
+
+    fprintf(file, "// Generated by Roadmap Compiler Phase 4 - do not edit\n");
+    fprintf(file, "#ifndef ");
+    write_upper(file, prefix);
+    fprintf(file, "_H\n#define ");
+    write_upper(file, prefix);
+    fprintf(file, "_H\n\n#include <stdint.h>\n\n");
+
+    // Index of each variable in inputs[] or outputs[]
+    int counts[2] = {0, 0};
+    for (int pass = 0; pass < 2; pass++) {
+        const char* kind = pass == 0 ? "INPUT" : "OUTPUT";
+        for (int i = 0; i < ctx->symbol_count; i++) {
+            if (ctx->symbols[i].is_bound || ctx->symbols[i].is_input != (pass == 0)) continue;
+            fprintf(file, "#define ");
+            write_upper(file, prefix);
+            fprintf(file, "_%s_%s %d\n", kind, ctx->symbols[i].name, counts[pass]++);
+        }
+        fprintf(file, "#define ");
+        write_upper(file, prefix);
+        fprintf(file, "_%s_COUNT %d\n\n", kind, counts[pass]);
+    }
+
+    fprintf(file, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+    fprintf(file, "// Reads one byte per input (nonzero is TRUE) and writes one 0/1 byte\n");
+    fprintf(file, "// per output. Returns the last expression statement's value, or 0.\n");
+    fprintf(file, "// Inputs are the variables first assigned a literal; the compiler\n");
+    fprintf(file, "// rejects a program that assigns one again, so they are never outputs.\n");
+    fprintf(file, "int %s_eval(const uint8_t* inputs, uint8_t* outputs);\n\n", prefix);
+    fprintf(file, "#ifdef __cplusplus\n}\n#endif\n\n#endif\n");
+    fclose(file);
+    return 0;
+}
+
+static Operand register_operand(Register reg) {
+    Operand op = {.type = OPERAND_REGISTER, .value.reg = reg};
+    return op;
+}
+
+static Operand immediate_operand(int value) {
+    Operand op = {.type = OPERAND_IMMEDIATE, .value.immediate = value};
+    return op;
+}
+
+static Operand memory_operand(Register base, int offset) {
+    Operand op = {.type = OPERAND_MEMORY, .value.memory = {base, offset}};
+    return op;
+}
+
+// Wrap the allocated body in the function's prologue and epilogue. RDI
+// holds inputs and RSI outputs on entry; outputs is kept in the slot
+// below the spill slots, since every other register may be allocated.
+static void wrap_rule_function(CodeGenContext* ctx) {
+    int outputs_slot = ctx->stack_offset + 8;
+    Register saved[CALLEE_SAVED_COUNT];
+    int saved_count = saved_registers(ctx, saved);
+
+    int body_count = ctx->instruction_count;
+    Instruction* body = malloc((body_count + 1) * sizeof(Instruction));
+    if (!body) {
+        fprintf(stderr, "Out of memory for rule function\n");
+        exit(1);
+    }
+    memcpy(body, ctx->instructions, body_count * sizeof(Instruction));
+    ctx->instruction_count = 0;
+
+    Operand rax = register_operand(REG_RAX);
+    Operand rdx = register_operand(REG_RDX);
+    Operand rbx = register_operand(REG_RBX);
+    Operand rsi = register_operand(REG_RSI);
+    Operand rsp = register_operand(REG_RSP);
+
+    for (int i = 0; i < saved_count; i++) {
+        emit_instruction(ctx, INST_PUSH, 1, register_operand(saved[i]));
+    }
+    emit_instruction(ctx, INST_MOV, 2, rbx, rsp);
+    emit_comment(ctx, "Frame base");
+    emit_instruction(ctx, INST_SUB, 2, rsp, immediate_operand(outputs_slot));
+    emit_instruction(ctx, INST_MOV, 2, memory_operand(REG_RBX, -outputs_slot), rsi);
+    emit_comment(ctx, "outputs");
+    for (int offset = 8; offset <= ctx->variable_size; offset += 8) {
+        emit_instruction(ctx, INST_MOV, 2, memory_operand(REG_RBX, -offset), immediate_operand(0));
+    }
+
+    // Any nonzero input byte is TRUE: negating it sets the sign bit
+    int index = 0;
+    for (int i = 0; i < ctx->symbol_count; i++) {
+        const struct SymbolMap* sym = &ctx->symbols[i];
+        if (!sym->is_input) continue;
+        emit_instruction(ctx, INST_MOVZB, 2, rax, memory_operand(REG_RDI, index++));
+        emit_comment(ctx, sym->name);
+        emit_instruction(ctx, INST_NEG, 1, rax);
+        emit_instruction(ctx, INST_SHR, 2, rax, immediate_operand(63));
+        if (sym->bit > 0) {
+            emit_instruction(ctx, INST_SHL, 2, rax, immediate_operand(sym->bit));
+        }
+        emit_instruction(ctx, INST_OR, 2, memory_operand(REG_RBX, -sym->stack_offset), rax);
+    }
+
+    for (int i = 0; i < body_count; i++) {
+        const Instruction* inst = &body[i];
+        if (inst->type == INST_LABEL) {
+            emit_label(ctx, (uint32_t)inst->values[0]);
+            continue;
+        }
+        emit_instruction(ctx, (InstructionType)inst->type, inst->operand_count,
+                         instruction_operand(inst, 0), instruction_operand(inst, 1),
+                         instruction_operand(inst, 2));
+        ctx->instructions[ctx->instruction_count - 1].comment = inst->comment;
+    }
+    free(body);
+
+    emit_instruction(ctx, INST_MOV, 2, rsi, memory_operand(REG_RBX, -outputs_slot));
+    index = 0;
+    for (int i = 0; i < ctx->symbol_count; i++) {
+        const struct SymbolMap* sym = &ctx->symbols[i];
+        if (sym->is_input || sym->is_bound) continue;
+        emit_instruction(ctx, INST_MOV, 2, rdx, memory_operand(REG_RBX, -sym->stack_offset));
+        emit_comment(ctx, sym->name);
+        if (sym->bit > 0) {
+            emit_instruction(ctx, INST_SHR, 2, rdx, immediate_operand(sym->bit));
+        }
+        emit_instruction(ctx, INST_AND, 2, rdx, immediate_operand(1));
+        emit_instruction(ctx, INST_MOVB, 2, memory_operand(REG_RSI, index++), rdx);
+    }
+    emit_instruction(ctx, INST_MOV, 2, rsp, rbx);
+    for (int i = saved_count - 1; i >= 0; i--) {
+        emit_instruction(ctx, INST_POP, 1, register_operand(saved[i]));
+    }
+    emit_instruction(ctx, INST_RET, 0);
+}
+
+CodeGenContext* compile_rule_function(const AST* ast, int peephole_window) {
+    CodeGenContext* ctx = create_codegen_context(TARGET_X86_64);
+    ctx->mode = CODEGEN_FUNCTION;
+    ctx->peephole_window = peephole_window;
+    generate_program(ctx, ast);
+    if (ctx->failed) {
+        free_codegen_context(ctx);
+        return NULL;
+    }
+    allocate_registers(ctx);
+    optimize_peephole(ctx);
+
+    int inputs = 0, outputs = 0;
+    for (int i = 0; i < ctx->symbol_count; i++) {
+        inputs += ctx->symbols[i].is_input;
+        outputs += !ctx->symbols[i].is_input && !ctx->symbols[i].is_bound;
+    }
+    printf("│\n");
+    printf("│ Inputs: %d, outputs: %d\n", inputs, outputs);
+    printf("│ %d instructions, %d spilled\n", ctx->instruction_count, ctx->spill_count);
+
+    wrap_rule_function(ctx);
+    return ctx;
+}
+
+int generate_rule_function(const AST* ast, const char* prefix, const char* assembly_file,
+                           const char* header_file, const char* object_file, int peephole_window) {
+    if (!ast) return -1;
+    if (!valid_prefix(prefix)) {
+        fprintf(stderr, "Error: function prefix '%s' is not a C identifier\n", prefix);
+        return -1;
+    }
+
+    char name[256];
+    snprintf(name, sizeof(name), "%s_eval", prefix);
+
+    printf("┌─ RULE FUNCTION GENERATION\n");
+    printf("│\n");
+    printf("│ Function: %s\n", name);
+    printf("│ Output: %s, %s%s%s\n", assembly_file, header_file, object_file ? ", " : "",
+           object_file ? object_file : "");
+    printf("│\n");
+
+    CodeGenContext* ctx = compile_rule_function(ast, peephole_window);
+    printf("│\n");
+    printf("└─\n\n");
+    if (!ctx) return -1;
+
+    FILE* file = fopen(assembly_file, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create assembly file %s\n", assembly_file);
+        free_codegen_context(ctx);
+        return -1;
+    }
+
+    fprintf(file, "# Rule function generated by Roadmap Compiler Phase 4\n");
+    fprintf(file, "# Target Architecture: x86_64 (System V)\n");
+    fprintf(file, "#\n");
+    fprintf(file, "# int %s(const uint8_t* inputs, uint8_t* outputs)\n", name);
+    fprintf(file, "# Declared in %s\n", header_file);
+    fprintf(file, "\n.section .text\n");
+    fprintf(file, "\n    .globl   %s\n", name);
+    fprintf(file, "    .type    %s, @function\n", name);
+    fprintf(file, "%s:\n", name);
+    for (int i = 0; i < ctx->instruction_count; i++) {
+        write_instruction(file, ctx, &ctx->instructions[i]);
+    }
+    fprintf(file, "    .size    %s, .-%s\n", name, name);
+    fprintf(file, "\n.section .note.GNU-stack,\"\",@progbits\n");
+    fclose(file);
+
+    int result = write_header(ctx, prefix, header_file);
+    if (result == 0 && object_file) {
+        result = write_rule_object(ctx, name, object_file);
+    }
+    free_codegen_context(ctx);
+    return result;
+}
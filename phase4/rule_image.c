@@ -0,0 +1,438 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "rule_image.h"
+
+// Rule image writer and loader. The writer lays out the bytecode, name
+// tables and statement lines from compile_bytecode, and the machine code
+// the JIT would map, in one buffer. The loader maps the file read-only,
+// checks the offsets and bytecode once, and evaluates out of the mapping:
+// the only allocation is the names' pointer array, and only the native
+// code's pages change protection (to read-execute).
+
+static double elapsed_microseconds(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e6 + (now.tv_nsec - start->tv_nsec) / 1e3;
+}
+
+static void append_bytes(MachineCode* image, const void* data, size_t size) {
+    if (image->size + size > image->capacity) {
+        size_t capacity = image->capacity ? image->capacity : 4096;
+        while (capacity < image->size + size) capacity *= 2;
+        image->bytes = realloc(image->bytes, capacity);
+        if (!image->bytes) {
+            fprintf(stderr, "Out of memory for rule image\n");
+            exit(1);
+        }
+        image->capacity = capacity;
+    }
+    if (size > 0) memcpy(image->bytes + image->size, data, size);
+    image->size += size;
+}
+
+// Pad to alignment and return the offset of what comes next
+static uint32_t align_image(MachineCode* image, size_t alignment) {
+    static const uint8_t zero[1] = {0};
+    while (image->size % alignment != 0) {
+        append_bytes(image, zero, 1);
+    }
+    return (uint32_t)image->size;
+}
+
+// Slot order for lookups, sorted by name
+static const char* const* sort_names;
+
+static int compare_slots(const void* a, const void* b) {
+    return strcmp(sort_names[*(const uint32_t*)a], sort_names[*(const uint32_t*)b]);
+}
+
+// The -f rule function as machine code, or 0 bytes when it cannot be used
+static void compile_native(const AST* ast, int peephole_window, MachineCode* native) {
+    printf("┌─ NATIVE CODE\n");
+    CodeGenContext* ctx = compile_rule_function(ast, peephole_window);
+    if (!ctx || encode_x86_64(ctx, native) != 0) {
+        free_machine_code(native);
+        memset(native, 0, sizeof(*native));
+    }
+    free_codegen_context(ctx);
+    printf("│ Machine code: %zu bytes\n", native->size);
+    printf("│\n");
+    printf("└─\n\n");
+}
+
+int write_rule_image(const AST* ast, const char* output_file, int peephole_window,
+                     int native) {
+    Bytecode* bc = compile_bytecode(ast);
+    if (!bc) return -1;
+
+    MachineCode code = {0};
+    if (native) {
+        compile_native(ast, peephole_window, &code);
+    }
+
+    uint32_t slot_count = bc->input_count + bc->output_count;
+    MachineCode image = {0}, strings = {0};
+    RuleImageHeader header = {0};
+    memcpy(header.magic, RULE_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = RULE_IMAGE_VERSION;
+    header.register_count = bc->register_count;
+    header.input_count = bc->input_count;
+    header.output_count = bc->output_count;
+    header.bound_count = bc->bound_count;
+    header.code_words = bc->size;
+    header.statement_count = bc->statement_count;
+    append_bytes(&image, &header, sizeof(header));
+
+    header.code_offset = align_image(&image, 8);
+    append_bytes(&image, bc->code, (size_t)bc->size * sizeof(uint32_t));
+
+    // The strings start with an empty one, as in an ELF string table
+    header.names_offset = align_image(&image, 8);
+    append_bytes(&strings, "", 1);
+    for (uint32_t slot = 0; slot < slot_count; slot++) {
+        uint32_t offset = (uint32_t)strings.size;
+        append_bytes(&strings, bc->names[slot], strlen(bc->names[slot]) + 1);
+        append_bytes(&image, &offset, sizeof(offset));
+    }
+
+    uint32_t* sorted = malloc((slot_count + 1) * sizeof(uint32_t));
+    if (!sorted) {
+        fprintf(stderr, "Out of memory for rule image\n");
+        exit(1);
+    }
+    for (uint32_t slot = 0; slot < slot_count; slot++) {
+        sorted[slot] = slot;
+    }
+    sort_names = bc->names;
+    qsort(sorted, slot_count, sizeof(uint32_t), compare_slots);
+    header.sorted_offset = align_image(&image, 8);
+    append_bytes(&image, sorted, (size_t)slot_count * sizeof(uint32_t));
+    free(sorted);
+
+    header.input_values_offset = align_image(&image, 8);
+    append_bytes(&image, bc->input_values, bc->input_count);
+
+    header.statements_offset = align_image(&image, 8);
+    for (uint32_t i = 0; i < bc->statement_count; i++) {
+        RuleImageStatement statement = {bc->statement_lines[i], bc->statement_starts[i]};
+        append_bytes(&image, &statement, sizeof(statement));
+    }
+
+    header.strings_offset = align_image(&image, 8);
+    header.strings_size = (uint32_t)strings.size;
+    append_bytes(&image, strings.bytes, strings.size);
+    free(strings.bytes);
+
+    if (code.size > 0) {
+        header.native_offset = align_image(&image, RULE_IMAGE_PAGE);
+        header.native_size = (uint32_t)code.size;
+        append_bytes(&image, code.bytes, code.size);
+    }
+    free_machine_code(&code);
+
+    header.file_size = align_image(&image, 8);
+    memcpy(image.bytes, &header, sizeof(header));
+
+    int result = 0;
+    FILE* file = fopen(output_file, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create rule image %s\n", output_file);
+        result = -1;
+    } else {
+        if (fwrite(image.bytes, 1, image.size, file) != image.size) {
+            fprintf(stderr, "Error: Cannot write rule image %s\n", output_file);
+            result = -1;
+        }
+        fclose(file);
+    }
+
+    if (result == 0) {
+        printf("┌─ RULE IMAGE\n");
+        printf("│\n");
+        printf("│ %s: %zu bytes\n", output_file, image.size);
+        printf("│ Bytecode: %u words, %u registers\n", bc->size, bc->register_count);
+        printf("│ Slots: %u inputs, %u outputs\n", bc->input_count, bc->output_count);
+        printf("│ Statements: %u\n", bc->statement_count);
+        if (header.native_size > 0) {
+            printf("│ Native code: %u bytes at offset %u\n", header.native_size,
+                   header.native_offset);
+        }
+        printf("│\n");
+        printf("└─\n\n");
+    }
+    free(image.bytes);
+    free_bytecode(bc);
+    return result;
+}
+
+// An array of count elements of size bytes at offset lies inside the file
+static int in_file(const RuleImageHeader* h, uint32_t offset, uint64_t count, size_t size) {
+    return offset % 4 == 0 && offset >= sizeof(RuleImageHeader) &&
+           (uint64_t)offset + count * size <= h->file_size;
+}
+
+static const char* check_header(const RuleImageHeader* h, size_t file_size) {
+    if (file_size < sizeof(RuleImageHeader) ||
+        memcmp(h->magic, RULE_IMAGE_MAGIC, sizeof(h->magic)) != 0) {
+        return "not a rule image";
+    }
+    if (h->version != RULE_IMAGE_VERSION) return "unsupported version";
+    if (h->file_size != file_size) return "truncated";
+
+    uint64_t slot_count = (uint64_t)h->input_count + h->output_count;
+    if (slot_count + h->bound_count > BYTECODE_MAX_SLOTS ||
+        h->register_count > BYTECODE_REGISTERS) {
+        return "more slots or registers than the bytecode has";
+    }
+    if (h->code_words == 0 || !in_file(h, h->code_offset, h->code_words, sizeof(uint32_t)) ||
+        !in_file(h, h->names_offset, slot_count, sizeof(uint32_t)) ||
+        !in_file(h, h->sorted_offset, slot_count, sizeof(uint32_t)) ||
+        !in_file(h, h->input_values_offset, h->input_count, 1) ||
+        !in_file(h, h->statements_offset, h->statement_count, sizeof(RuleImageStatement)) ||
+        h->strings_size == 0 || !in_file(h, h->strings_offset, h->strings_size, 1)) {
+        return "table outside the file";
+    }
+    if (h->native_size > 0 &&
+        (h->native_offset % RULE_IMAGE_PAGE != 0 ||
+         !in_file(h, h->native_offset, h->native_size, 1))) {
+        return "native code outside the file";
+    }
+    return NULL;
+}
+
+// Every instruction reads and writes registers and slots that exist, and
+// control stays inside the code: QNEXT's target word is never executed,
+// targets are instructions, and the last word is HALT
+static const char* check_bytecode(const RuleImage* image) {
+    const Bytecode* bc = &image->bytecode;
+    uint32_t slot_count = bc->input_count + bc->output_count + bc->bound_count;
+    const uint32_t* code = bc->code;
+    uint32_t words = bc->size;
+    if (BC_OP(code[words - 1]) != OP_HALT) return "bytecode does not end in HALT";
+
+    uint8_t* target_word = calloc(words, 1);
+    if (!target_word) {
+        fprintf(stderr, "Out of memory for rule image\n");
+        exit(1);
+    }
+    const char* error = NULL;
+    for (uint32_t pc = 0; pc < words && !error; pc++) {
+        uint32_t word = code[pc];
+        switch (BC_OP(word)) {
+            case OP_LOADV: case OP_STOREV: case OP_STOREK:
+            case OP_ANDV: case OP_ANDNV: case OP_ORV:
+                if (BC_BC(word) >= slot_count) error = "bytecode slot out of range";
+                break;
+            case OP_QNEXT:
+                if (BC_BC(word) >= slot_count) error = "bytecode slot out of range";
+                else if (pc + 2 >= words) error = "QNEXT without a target";
+                else if (code[pc + 1] >= words) error = "QNEXT target out of range";
+                else target_word[++pc] = 1;
+                break;
+            default:
+                if (BC_OP(word) >= OP_COUNT) error = "unknown opcode";
+                break;
+        }
+    }
+    for (uint32_t pc = 0; pc < words && !error; pc++) {
+        if (target_word[pc] && target_word[code[pc]]) error = "QNEXT target is not an instruction";
+    }
+    for (uint32_t i = 0; i < image->header->statement_count && !error; i++) {
+        uint32_t first = image->statements[i].first_word;
+        if (first >= words || target_word[first]) error = "statement start out of range";
+    }
+    free(target_word);
+    return error;
+}
+
+static const char* check_names(const RuleImage* image) {
+    const RuleImageHeader* h = image->header;
+    const char* strings = (const char*)image->base + h->strings_offset;
+    const uint32_t* names = (const uint32_t*)(image->base + h->names_offset);
+    const uint32_t* sorted = (const uint32_t*)(image->base + h->sorted_offset);
+    uint32_t slot_count = h->input_count + h->output_count;
+    if (strings[h->strings_size - 1] != '\0') return "names not terminated";
+    for (uint32_t slot = 0; slot < slot_count; slot++) {
+        if (names[slot] >= h->strings_size || sorted[slot] >= slot_count) {
+            return "name table out of range";
+        }
+    }
+    return NULL;
+}
+
+// Make the native code's pages read-execute. The rest of the mapping stays
+// read-only; without the native code the image still runs on the VM.
+static void map_native(RuleImage* image) {
+#if defined(__x86_64__)
+    const RuleImageHeader* h = image->header;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (h->native_size == 0 || h->native_offset % page != 0) return;
+    void* code = (void*)(image->base + h->native_offset);
+    size_t length = (h->native_size + page - 1) / page * page;
+    if (mprotect(code, length, PROT_READ | PROT_EXEC) != 0) {
+        perror("mprotect");
+        return;
+    }
+    // Object to function pointer: allowed by POSIX, not by ISO C
+    memcpy(&image->native, &code, sizeof(image->native));
+#else
+    (void)image;
+#endif
+}
+
+RuleImage* load_rule_image(const char* input_file) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int fd = open(input_file, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open rule image %s\n", input_file);
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(RuleImageHeader)) {
+        fprintf(stderr, "Error: %s: not a rule image\n", input_file);
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)info.st_size;
+    void* base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+
+    RuleImage* image = calloc(1, sizeof(RuleImage));
+    if (!image) {
+        fprintf(stderr, "Out of memory for rule image\n");
+        exit(1);
+    }
+    image->base = base;
+    image->mapped_size = size;
+    image->header = base;
+
+    const RuleImageHeader* h = image->header;
+    const char* error = check_header(h, size);
+    if (!error) {
+        Bytecode* bc = &image->bytecode;
+        bc->code = (uint32_t*)(image->base + h->code_offset);
+        bc->size = h->code_words;
+        bc->capacity = h->code_words;
+        bc->register_count = h->register_count;
+        bc->input_count = h->input_count;
+        bc->output_count = h->output_count;
+        bc->bound_count = h->bound_count;
+        bc->input_values = (uint8_t*)(image->base + h->input_values_offset);
+        bc->statement_count = h->statement_count;
+        image->statements = (const RuleImageStatement*)(image->base + h->statements_offset);
+        error = check_names(image);
+    }
+    if (!error) {
+        error = check_bytecode(image);
+    }
+    if (error) {
+        fprintf(stderr, "Error: %s: %s\n", input_file, error);
+        unload_rule_image(image);
+        return NULL;
+    }
+
+    Bytecode* bc = &image->bytecode;
+    uint32_t slot_count = h->input_count + h->output_count;
+    const char* strings = (const char*)image->base + h->strings_offset;
+    const uint32_t* names = (const uint32_t*)(image->base + h->names_offset);
+    bc->names = malloc((slot_count + 1) * sizeof(const char*));
+    if (!bc->names) {
+        fprintf(stderr, "Out of memory for rule image\n");
+        exit(1);
+    }
+    for (uint32_t slot = 0; slot < slot_count; slot++) {
+        bc->names[slot] = strings + names[slot];
+    }
+    map_native(image);
+    image->load_microseconds = elapsed_microseconds(&start);
+
+    printf("┌─ RULE IMAGE LOADED\n");
+    printf("│\n");
+    printf("│ %s: %zu bytes, one read-only shared mapping at %p\n", input_file, size, base);
+    printf("│ Bytecode: %u words, %u registers\n", bc->size, bc->register_count);
+    printf("│ Slots: %u inputs, %u outputs\n", bc->input_count, bc->output_count);
+    if (h->statement_count > 0) {
+        printf("│ Statements: %u, lines %u-%u\n", h->statement_count, image->statements[0].line,
+               image->statements[h->statement_count - 1].line);
+    }
+    if (image->native) {
+        printf("│ Native code: %u bytes, read-execute in place\n", h->native_size);
+    } else {
+        printf("│ Native code: none, evaluating on the VM\n");
+    }
+    printf("│ Ready in %.1f us\n", image->load_microseconds);
+    printf("│\n");
+    printf("└─\n\n");
+    return image;
+}
+
+void unload_rule_image(RuleImage* image) {
+    if (!image) return;
+    free(image->bytecode.names);
+    munmap((void*)image->base, image->mapped_size);
+    free(image);
+}
+
+int rule_image_slot(const RuleImage* image, const char* name) {
+    const RuleImageHeader* h = image->header;
+    const uint32_t* sorted = (const uint32_t*)(image->base + h->sorted_offset);
+    const char* const* names = image->bytecode.names;
+    uint32_t low = 0, high = h->input_count + h->output_count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        int order = strcmp(names[sorted[middle]], name);
+        if (order == 0) return (int)sorted[middle];
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return -1;
+}
+
+int rule_image_eval(const RuleImage* image, uint8_t* variables, const uint8_t* inputs,
+                    uint8_t* outputs) {
+    if (image->native) {
+        return image->native(inputs, outputs);
+    }
+    return vm_run(&image->bytecode, variables, inputs, outputs);
+}
+
+int rule_image_run_declared(const RuleImage* image) {
+    const Bytecode* bc = &image->bytecode;
+    int result = vm_run_declared(bc);
+    if (!image->native) return result;
+
+    uint8_t* variables = malloc(bc->input_count + bc->output_count + bc->bound_count + 1);
+    uint8_t* vm_outputs = calloc(bc->output_count + 1, 1);
+    uint8_t* native_outputs = calloc(bc->output_count + 1, 1);
+    if (!variables || !vm_outputs || !native_outputs) {
+        fprintf(stderr, "Out of memory for rule image\n");
+        exit(1);
+    }
+    vm_run(bc, variables, bc->input_values, vm_outputs);
+    int native_result = image->native(bc->input_values, native_outputs);
+    int agree = native_result == result &&
+                memcmp(vm_outputs, native_outputs, bc->output_count) == 0;
+    printf("NATIVE RUN: %s\n\n", agree ? "same result and outputs as the VM"
+                                       : "results differ from the VM");
+    free(variables);
+    free(vm_outputs);
+    free(native_outputs);
+    return agree ? result : -1;
+}
@@ -0,0 +1,95 @@
+#ifndef RULE_IMAGE_H
+#define RULE_IMAGE_H
+
+#include "code_generator.h"
+#include "bytecode.h"
+
+// Rule images: a compiled program serialised so a host can map it with one
+// read-only mmap and evaluate it straight away, without running any phase.
+// Every reference inside the file is an offset from its start, so the
+// mapping can sit at any address and its pages are shared between all the
+// processes that map the same file. Layout, each part 8-byte aligned:
+//
+//   RuleImageHeader
+//   bytecode          code_words x uint32_t, ending in HALT
+//   slot names        per input and output slot, the offset of its name
+//                     in the strings; the bound slots after them have none
+//   sorted slots      input and output slots ordered by name, for lookups
+//   input values      per input, the literal it was declared with
+//   statements        per statement, its source line and first word
+//   strings           NUL-terminated names
+//   native code       optional x86_64 rule function, page-aligned
+//
+// All fields are little-endian, the byte order of both the writer and the
+// hosts it targets.
+
+#define RULE_IMAGE_MAGIC "LOGICIMG"
+#define RULE_IMAGE_VERSION 1
+#define RULE_IMAGE_PAGE 4096
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t file_size;
+    uint32_t register_count;
+    uint32_t input_count;
+    uint32_t output_count;
+    uint32_t code_offset;
+    uint32_t code_words;
+    uint32_t names_offset;
+    uint32_t sorted_offset;
+    uint32_t input_values_offset;
+    uint32_t statements_offset;
+    uint32_t statement_count;
+    uint32_t strings_offset;
+    uint32_t strings_size;
+    uint32_t native_offset;     // 0 when there is no native code
+    uint32_t native_size;
+    uint32_t bound_count;       // Slots only quantifiers bind, after the outputs
+    uint32_t reserved;          // 0
+} RuleImageHeader;
+
+typedef struct {
+    uint32_t line;
+    uint32_t first_word;
+} RuleImageStatement;
+
+typedef struct {
+    const uint8_t* base;        // The read-only mapping
+    size_t mapped_size;
+    const RuleImageHeader* header;
+    Bytecode bytecode;          // Views into the mapping, nothing copied
+                                // but the names' pointer array
+    const RuleImageStatement* statements;
+    RuleFunction native;        // NULL without native code or when its
+                                // pages cannot be made executable
+    double load_microseconds;
+} RuleImage;
+
+// Compile the program to bytecode and, with native set, to an x86_64 rule
+// function, and write both as an image (rule_image.c)
+int write_rule_image(const AST* ast, const char* output_file, int peephole_window,
+                     int native);
+
+// Map an image and check it; NULL if it is missing, truncated or its
+// bytecode would reach outside its registers, slots or code. The checks
+// make a corrupt file fail cleanly: images are trusted like shared
+// libraries, and native code is not verified.
+RuleImage* load_rule_image(const char* input_file);
+void unload_rule_image(RuleImage* image);
+
+// Slot of a variable, or -1; inputs are slots [0, input_count), outputs
+// follow in outputs[] order
+int rule_image_slot(const RuleImage* image, const char* name);
+
+// Evaluate once with the native code when it is loaded, else on the VM.
+// variables is VM scratch of input_count + output_count + bound_count
+// bytes.
+int rule_image_eval(const RuleImage* image, uint8_t* variables, const uint8_t* inputs,
+                    uint8_t* outputs);
+
+// Run the bytecode with the declared inputs, check the native code agrees
+// and print a summary; returns the result or -1 on a mismatch
+int rule_image_run_declared(const RuleImage* image);
+
+#endif // RULE_IMAGE_H
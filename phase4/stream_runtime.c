@@ -0,0 +1,265 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Streaming evaluator runtime, linked with the batch kernels of one
+// program (logicc -s):
+//
+//     evaluator records.bin results.bin
+//
+// records.bin is a flat array of fixed-width records, one byte per input
+// in lane order (nonzero = TRUE), as a rule function's inputs[] are laid
+// out. The file is mapped read-only and consumed in chunks: each chunk's
+// records are bit-sliced into 256-record blocks, logic_batch evaluates the
+// blocks, and every computed lane, which is already a bitmap of its block,
+// is gathered into its result column. Each column's share of a chunk goes
+// to the output in one write, 128 KB for a full chunk.
+//
+// results.bin: a RESULT_MAGIC header, the column names (NUL-separated,
+// padded to 8 bytes), then one bitmap per computed variable of
+// column_bytes bytes each, bit r % 8 of byte r / 8 holding record r.
+
+void logic_batch(void* lanes, size_t blocks);
+extern const uint32_t logic_batch_lanes;
+extern const uint32_t logic_batch_inputs;
+extern const uint32_t logic_batch_outputs;
+extern const uint8_t logic_batch_lane_is_input[];
+extern const char logic_batch_lane_names[];
+extern const char* logic_batch_kernel_name;     // Set by the first call
+
+#define RESULT_MAGIC "LOGICRES"
+#define RESULT_VERSION 1
+#define BLOCK_RECORDS 256
+#define LANE_BYTES 32
+
+// Chunks are capped at CHUNK_BYTES of lanes and CHUNK_BLOCKS blocks,
+// 1M records and so 128 KB per column write
+#define CHUNK_BYTES (32u << 20)
+#define CHUNK_BLOCKS 4096
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t column_count;
+    uint64_t record_count;
+    uint64_t column_bytes;      // Per column, a multiple of 8
+    uint32_t names_size;        // Including padding
+    uint32_t reserved;
+} ResultHeader;
+
+// 32-byte aligned, as the AVX2 kernel loads whole lanes
+static void* aligned_buffer(size_t size) {
+    void* memory = aligned_alloc(LANE_BYTES, (size + LANE_BYTES - 1) / LANE_BYTES * LANE_BYTES);
+    if (!memory) {
+        fprintf(stderr, "Out of memory for evaluation\n");
+        exit(1);
+    }
+    return memory;
+}
+
+static int write_all(int fd, const void* data, size_t size, off_t offset) {
+    const uint8_t* bytes = data;
+    while (size > 0) {
+        ssize_t written = pwrite(fd, bytes, size, offset);
+        if (written <= 0) return -1;
+        bytes += written;
+        size -= (size_t)written;
+        offset += written;
+    }
+    return 0;
+}
+
+static double seconds_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Bit-slice count records into a block's input lanes, eight records to a
+// byte; records past count stay FALSE
+static void slice_block(uint8_t* block, const uint8_t* records, size_t count, size_t width,
+                        const uint32_t* input_lanes) {
+    for (size_t input = 0; input < width; input++) {
+        uint8_t* lane = block + (size_t)input_lanes[input] * LANE_BYTES;
+        const uint8_t* column = records + input;
+        for (size_t byte = 0; byte * 8 < count; byte++) {
+            uint8_t bits = 0;
+            size_t end = count - byte * 8 < 8 ? count - byte * 8 : 8;
+            for (size_t bit = 0; bit < end; bit++) {
+                bits |= (uint8_t)((column[(byte * 8 + bit) * width] != 0) << bit);
+            }
+            lane[byte] = bits;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s records.bin results.bin\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t lanes = logic_batch_lanes, width = logic_batch_inputs;
+    uint32_t columns = logic_batch_outputs;
+    if (width == 0) {
+        fprintf(stderr, "Error: the program has no inputs to read records for\n");
+        return 1;
+    }
+    uint32_t* input_lanes = malloc((lanes + 1) * sizeof(uint32_t));
+    uint32_t* output_lanes = input_lanes + width;
+    const char** names = malloc((lanes + 1) * sizeof(const char*));
+    if (!input_lanes || !names) {
+        fprintf(stderr, "Out of memory for evaluation\n");
+        return 1;
+    }
+    const char* name = logic_batch_lane_names;
+    uint32_t inputs = 0, outputs = 0;
+    for (uint32_t lane = 0; lane < lanes; lane++) {
+        names[lane] = name;
+        name += strlen(name) + 1;
+        // Lanes past the inputs and outputs only hold quantified variables
+        if (logic_batch_lane_is_input[lane]) {
+            input_lanes[inputs++] = lane;
+        } else if (lane < width + columns) {
+            output_lanes[outputs++] = lane;
+        }
+    }
+
+    int in = open(argv[1], O_RDONLY);
+    struct stat info;
+    if (in < 0 || fstat(in, &info) != 0) {
+        fprintf(stderr, "Error: Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    size_t size = (size_t)info.st_size;
+    if (size % width != 0) {
+        fprintf(stderr, "Error: %s is %zu bytes, not a whole number of %u-byte records\n",
+                argv[1], size, width);
+        return 1;
+    }
+    const uint8_t* records = NULL;
+    if (size > 0) {
+        records = mmap(NULL, size, PROT_READ, MAP_PRIVATE, in, 0);
+        if (records == MAP_FAILED) {
+            perror("mmap");
+            return 1;
+        }
+        madvise((void*)records, size, MADV_SEQUENTIAL);
+    }
+    close(in);
+    uint64_t record_count = size / width;
+
+    // Header and names, then the columns at fixed offsets
+    ResultHeader header = {0};
+    memcpy(header.magic, RESULT_MAGIC, sizeof(header.magic));
+    header.version = RESULT_VERSION;
+    header.column_count = columns;
+    header.record_count = record_count;
+    header.column_bytes = (record_count + 63) / 64 * 8;
+    size_t names_size = 0;
+    for (uint32_t i = 0; i < columns; i++) {
+        names_size += strlen(names[output_lanes[i]]) + 1;
+    }
+    header.names_size = (uint32_t)((names_size + 7) / 8 * 8);
+    char* name_table = calloc(header.names_size + 1, 1);
+    if (!name_table) {
+        fprintf(stderr, "Out of memory for evaluation\n");
+        return 1;
+    }
+    for (uint32_t i = 0, at = 0; i < columns; i++) {
+        size_t length = strlen(names[output_lanes[i]]) + 1;
+        memcpy(name_table + at, names[output_lanes[i]], length);
+        at += (uint32_t)length;
+    }
+    off_t columns_offset = (off_t)(sizeof(header) + header.names_size);
+
+    int out = open(argv[2], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0 || write_all(out, &header, sizeof(header), 0) != 0 ||
+        write_all(out, name_table, header.names_size, sizeof(header)) != 0 ||
+        ftruncate(out, columns_offset + (off_t)(header.column_bytes * columns)) != 0) {
+        fprintf(stderr, "Error: Cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    size_t stride = (size_t)lanes * LANE_BYTES;
+    size_t chunk_blocks = CHUNK_BYTES / stride;
+    if (chunk_blocks > CHUNK_BLOCKS) chunk_blocks = CHUNK_BLOCKS;
+    if (chunk_blocks == 0) chunk_blocks = 1;
+    uint8_t* blocks = aligned_buffer(chunk_blocks * stride);
+    uint8_t* column = aligned_buffer(chunk_blocks * LANE_BYTES);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t done = 0;
+    while (done < record_count) {
+        uint64_t chunk = record_count - done;
+        if (chunk > chunk_blocks * BLOCK_RECORDS) chunk = chunk_blocks * BLOCK_RECORDS;
+        size_t count = (size_t)(chunk + BLOCK_RECORDS - 1) / BLOCK_RECORDS;
+
+        // Computed lanes read before assignment are FALSE
+        memset(blocks, 0, count * stride);
+        for (size_t b = 0; b < count; b++) {
+            uint64_t first = done + b * BLOCK_RECORDS;
+            size_t in_block = record_count - first < BLOCK_RECORDS ? record_count - first
+                                                                   : BLOCK_RECORDS;
+            slice_block(blocks + b * stride, records + first * width, in_block, width,
+                        input_lanes);
+        }
+        logic_batch(blocks, count);
+
+        // A chunk starts on a block boundary, so on a byte and 8-byte one
+        size_t bytes = (size_t)(chunk + 7) / 8;
+        for (uint32_t i = 0; i < columns; i++) {
+            for (size_t b = 0; b < count; b++) {
+                memcpy(column + b * LANE_BYTES,
+                       blocks + b * stride + (size_t)output_lanes[i] * LANE_BYTES, LANE_BYTES);
+            }
+            if (chunk % 8 != 0) {
+                column[bytes - 1] &= (uint8_t)((1u << (chunk % 8)) - 1);
+            }
+            off_t offset = columns_offset + (off_t)(header.column_bytes * i + done / 8);
+            if (write_all(out, column, bytes, offset) != 0) {
+                fprintf(stderr, "Error: Cannot write %s\n", argv[2]);
+                return 1;
+            }
+        }
+        done += chunk;
+    }
+    double seconds = seconds_since(&start);
+    if (close(out) != 0) {
+        fprintf(stderr, "Error: Cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    printf("┌─ STREAM EVALUATION\n");
+    printf("│\n");
+    printf("│ %s: %llu records of %u bytes\n", argv[1], (unsigned long long)record_count, width);
+    printf("│ %s: %u result columns of %llu bytes\n", argv[2], columns,
+           (unsigned long long)header.column_bytes);
+    printf("│ Kernel: %s, %zu blocks of %d records per chunk\n",
+           logic_batch_kernel_name ? logic_batch_kernel_name : "not called", chunk_blocks,
+           BLOCK_RECORDS);
+    printf("│\n");
+    printf("│ %.3f s, %.0f records/s\n", seconds,
+           seconds > 0 ? record_count / seconds : 0.0);
+    printf("│\n");
+    printf("└─\n");
+
+    if (records) munmap((void*)records, size);
+    free(blocks);
+    free(column);
+    free(name_table);
+    free(names);
+    free(input_lanes);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "bytecode.h"
+
+// Bytecode interpreter. With GCC or Clang each handler ends in its own
+// indirect jump through a table of label addresses (&&label), so the
+// branch predictor sees one dispatch site per opcode rather than a single
+// switch; other compilers fall back to a switch in a loop.
+
+#if defined(__GNUC__)
+#define VM_THREADED 1
+#else
+#define VM_THREADED 0
+#endif
+
+int vm_run(const Bytecode* bytecode, uint8_t* variables, const uint8_t* inputs,
+           uint8_t* outputs) {
+    uint8_t r[BYTECODE_REGISTERS];
+    uint8_t* v = variables;
+    const uint32_t* code = bytecode->code;
+    const uint32_t* pc = code;
+    uint32_t word;
+    int result = 0;
+
+    // Variables read before any assignment are FALSE
+    uint32_t slot_count =
+        bytecode->input_count + bytecode->output_count + bytecode->bound_count;
+    for (uint32_t i = 0; i < bytecode->input_count; i++) {
+        v[i] = inputs[i] != 0;
+    }
+    memset(v + bytecode->input_count, 0, slot_count - bytecode->input_count);
+
+#if VM_THREADED
+    static const void* const dispatch[OP_COUNT] = {
+        [OP_LOADK] = &&op_LOADK,     [OP_LOADV] = &&op_LOADV,   [OP_STOREV] = &&op_STOREV,
+        [OP_STOREK] = &&op_STOREK,   [OP_MOVE] = &&op_MOVE,     [OP_NOT] = &&op_NOT,
+        [OP_AND] = &&op_AND,         [OP_OR] = &&op_OR,         [OP_XOR] = &&op_XOR,
+        [OP_XNOR] = &&op_XNOR,       [OP_IMPLIES] = &&op_IMPLIES,
+        [OP_ANDN] = &&op_ANDN,       [OP_ANDV] = &&op_ANDV,     [OP_ANDNV] = &&op_ANDNV,
+        [OP_ORV] = &&op_ORV,         [OP_QNEXT] = &&op_QNEXT,   [OP_RESULT] = &&op_RESULT,
+        [OP_HALT] = &&op_HALT,
+    };
+#define CASE(op) op_##op:
+#define NEXT() do { word = *pc++; goto *dispatch[BC_OP(word)]; } while (0)
+    NEXT();
+#else
+#define CASE(op) case OP_##op:
+#define NEXT() continue
+    for (;;) {
+    word = *pc++;
+    switch (BC_OP(word)) {
+#endif
+
+    CASE(LOADK)   r[BC_A(word)] = (uint8_t)BC_B(word); NEXT();
+    CASE(LOADV)   r[BC_A(word)] = v[BC_BC(word)]; NEXT();
+    CASE(STOREV)  v[BC_BC(word)] = r[BC_A(word)]; NEXT();
+    CASE(STOREK)  v[BC_BC(word)] = (uint8_t)BC_A(word); NEXT();
+    CASE(MOVE)    r[BC_A(word)] = r[BC_B(word)]; NEXT();
+    CASE(NOT)     r[BC_A(word)] = r[BC_B(word)] ^ 1; NEXT();
+    CASE(AND)     r[BC_A(word)] = r[BC_B(word)] & r[BC_C(word)]; NEXT();
+    CASE(OR)      r[BC_A(word)] = r[BC_B(word)] | r[BC_C(word)]; NEXT();
+    CASE(XOR)     r[BC_A(word)] = r[BC_B(word)] ^ r[BC_C(word)]; NEXT();
+    CASE(XNOR)    r[BC_A(word)] = r[BC_B(word)] ^ r[BC_C(word)] ^ 1; NEXT();
+    CASE(IMPLIES) r[BC_A(word)] = (r[BC_B(word)] ^ 1) | r[BC_C(word)]; NEXT();
+    CASE(ANDN)    r[BC_A(word)] = r[BC_B(word)] & (r[BC_C(word)] ^ 1); NEXT();
+    CASE(ANDV)    r[BC_A(word)] &= v[BC_BC(word)]; NEXT();
+    CASE(ANDNV)   r[BC_A(word)] &= v[BC_BC(word)] ^ 1; NEXT();
+    CASE(ORV)     r[BC_A(word)] |= v[BC_BC(word)]; NEXT();
+    CASE(QNEXT)
+        if (!v[BC_BC(word)]) {
+            v[BC_BC(word)] = 1;
+            pc = code + *pc;
+        } else {
+            pc++;
+        }
+        NEXT();
+    CASE(RESULT)  result = r[BC_A(word)]; NEXT();
+    CASE(HALT)    goto done;
+
+#if !VM_THREADED
+    }
+    }
+#endif
+#undef CASE
+#undef NEXT
+
+done:
+    for (uint32_t i = 0; i < bytecode->output_count; i++) {
+        outputs[i] = v[bytecode->input_count + i];
+    }
+    return result;
+}
+
+int vm_run_declared(const Bytecode* bytecode) {
+    uint32_t slot_count =
+        bytecode->input_count + bytecode->output_count + bytecode->bound_count;
+    uint8_t* variables = malloc(slot_count + 1);
+    uint8_t* outputs = calloc(bytecode->output_count + 1, 1);
+    if (!variables || !outputs) {
+        fprintf(stderr, "Out of memory for VM variables\n");
+        exit(1);
+    }
+
+    int result = vm_run(bytecode, variables, bytecode->input_values, outputs);
+
+    printf("VM RUN: %u inputs at their declared values\n", bytecode->input_count);
+    for (uint32_t i = 0; i < bytecode->input_count; i++) {
+        printf("  %-16s %s (input)\n", bytecode->names[i],
+               bytecode->input_values[i] ? "TRUE" : "FALSE");
+    }
+    for (uint32_t i = 0; i < bytecode->output_count; i++) {
+        printf("  %-16s %s\n", bytecode->names[bytecode->input_count + i],
+               outputs[i] ? "TRUE" : "FALSE");
+    }
+    printf("  Result: %d\n\n", result);
+    free(variables);
+    free(outputs);
+    return result;
+}
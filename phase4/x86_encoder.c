@@ -0,0 +1,339 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "code_generator.h"
+
+// x86_64 machine code for an allocated instruction buffer, the encoding
+// of what write_x86_64_instruction prints. Every operation is 64-bit
+// (REX.W) except the byte load and store. Memory operands are always a
+// base register plus displacement, encoded with an 8- or 32-bit
+// displacement (never mod 00, so RBP/R13 bases need no special case, and
+// RSP/R12 bases take a SIB byte). Jumps and calls to labels are emitted
+// with a 32-bit displacement and patched once every label is placed.
+
+// Hardware register numbers, indexed by Register
+static const uint8_t hardware_register[REG_COUNT] = {
+    [REG_RAX] = 0, [REG_RCX] = 1, [REG_RDX] = 2, [REG_RBX] = 3,
+    [REG_RSP] = 4, [REG_RSI] = 6, [REG_RDI] = 7,
+    [REG_R8] = 8, [REG_R9] = 9, [REG_R10] = 10, [REG_R11] = 11,
+    [REG_R12] = 12, [REG_R13] = 13, [REG_R14] = 14, [REG_R15] = 15,
+};
+
+// Group opcode extensions (the /digit in the reg field)
+enum { EXT_ADD = 0, EXT_OR = 1, EXT_AND = 4, EXT_SUB = 5, EXT_XOR = 6, EXT_CMP = 7 };
+
+typedef struct {
+    uint32_t offset;    // Position of the rel32 field
+    uint32_t label;
+} LabelFixup;
+
+typedef struct {
+    MachineCode* code;
+    uint32_t* label_offsets;    // Offset of each label, UINT32_MAX until placed
+    uint32_t label_count;
+    LabelFixup* fixups;
+    int fixup_count;
+    int fixup_capacity;
+} Encoder;
+
+static void emit_byte(MachineCode* code, uint8_t byte) {
+    if (code->size == code->capacity) {
+        code->capacity = code->capacity ? code->capacity * 2 : 4096;
+        code->bytes = realloc(code->bytes, code->capacity);
+        if (!code->bytes) {
+            fprintf(stderr, "Out of memory for machine code\n");
+            exit(1);
+        }
+    }
+    code->bytes[code->size++] = byte;
+}
+
+static void emit_int32(MachineCode* code, int32_t value) {
+    uint32_t bits = (uint32_t)value;
+    for (int i = 0; i < 4; i++) {
+        emit_byte(code, (uint8_t)(bits >> (8 * i)));
+    }
+}
+
+static int fits_int8(int32_t value) {
+    return value >= -128 && value <= 127;
+}
+
+static int is_physical(const Instruction* inst, int index) {
+    uint8_t reg = inst->kinds[index] == OPERAND_MEMORY ? inst->bases[index] : (uint8_t)inst->values[index];
+    return reg < REG_COUNT;
+}
+
+// REX prefix, ModRM and any SIB and displacement for reg_field (a
+// register number or opcode extension) against operand index of inst,
+// which is a register or memory. force_rex emits REX even when empty,
+// for byte access to SIL and DIL.
+static void emit_operand(MachineCode* code, const uint8_t* opcode, int opcode_length, int wide,
+                         int reg_field, const Instruction* inst, int index, int force_rex) {
+    int memory = inst->kinds[index] == OPERAND_MEMORY;
+    int rm = memory ? hardware_register[inst->bases[index]] : hardware_register[inst->values[index]];
+
+    uint8_t rex = (uint8_t)(0x40 | (wide << 3) | ((reg_field >> 3) << 2) | (rm >> 3));
+    if (rex != 0x40 || force_rex) {
+        emit_byte(code, rex);
+    }
+    for (int i = 0; i < opcode_length; i++) {
+        emit_byte(code, opcode[i]);
+    }
+
+    if (!memory) {
+        emit_byte(code, (uint8_t)(0xC0 | ((reg_field & 7) << 3) | (rm & 7)));
+        return;
+    }
+    int32_t displacement = inst->values[index];
+    int mod = fits_int8(displacement) ? 1 : 2;
+    emit_byte(code, (uint8_t)((mod << 6) | ((reg_field & 7) << 3) | (rm & 7)));
+    if ((rm & 7) == 4) {
+        emit_byte(code, 0x24); // SIB: base only
+    }
+    if (mod == 1) {
+        emit_byte(code, (uint8_t)(int8_t)displacement);
+    } else {
+        emit_int32(code, displacement);
+    }
+}
+
+static void emit_register_operand(MachineCode* code, uint8_t opcode, int wide, int reg_field,
+                                  const Instruction* inst, int index) {
+    emit_operand(code, &opcode, 1, wide, reg_field, inst, index, 0);
+}
+
+// ADD, OR, AND, SUB, XOR and CMP share one encoding pattern
+static int encode_alu(MachineCode* code, const Instruction* inst, int extension) {
+    int dest_register = inst->kinds[0] == OPERAND_REGISTER;
+    switch ((OperandType)inst->kinds[1]) {
+        case OPERAND_REGISTER:
+            emit_register_operand(code, (uint8_t)(extension * 8 + 1), 1,
+                                  hardware_register[inst->values[1]], inst, 0);
+            return 0;
+        case OPERAND_MEMORY:
+            if (!dest_register) return -1;
+            emit_register_operand(code, (uint8_t)(extension * 8 + 3), 1,
+                                  hardware_register[inst->values[0]], inst, 1);
+            return 0;
+        case OPERAND_IMMEDIATE:
+            if (fits_int8(inst->values[1])) {
+                emit_register_operand(code, 0x83, 1, extension, inst, 0);
+                emit_byte(code, (uint8_t)(int8_t)inst->values[1]);
+            } else {
+                emit_register_operand(code, 0x81, 1, extension, inst, 0);
+                emit_int32(code, inst->values[1]);
+            }
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+static int encode_move(MachineCode* code, const Instruction* inst) {
+    switch ((OperandType)inst->kinds[1]) {
+        case OPERAND_REGISTER:
+            emit_register_operand(code, 0x89, 1, hardware_register[inst->values[1]], inst, 0);
+            return 0;
+        case OPERAND_MEMORY:
+            if (inst->kinds[0] != OPERAND_REGISTER) return -1;
+            emit_register_operand(code, 0x8B, 1, hardware_register[inst->values[0]], inst, 1);
+            return 0;
+        case OPERAND_IMMEDIATE:
+            emit_register_operand(code, 0xC7, 1, 0, inst, 0); // Sign-extended imm32
+            emit_int32(code, inst->values[1]);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+static void add_fixup(Encoder* encoder, uint32_t label) {
+    if (encoder->fixup_count == encoder->fixup_capacity) {
+        encoder->fixup_capacity = encoder->fixup_capacity ? encoder->fixup_capacity * 2 : 16;
+        encoder->fixups = realloc(encoder->fixups, encoder->fixup_capacity * sizeof(LabelFixup));
+        if (!encoder->fixups) {
+            fprintf(stderr, "Out of memory for label fixups\n");
+            exit(1);
+        }
+    }
+    encoder->fixups[encoder->fixup_count].offset = (uint32_t)encoder->code->size;
+    encoder->fixups[encoder->fixup_count].label = label;
+    encoder->fixup_count++;
+}
+
+static int encode_branch(Encoder* encoder, const Instruction* inst) {
+    MachineCode* code = encoder->code;
+    if (inst->operand_count != 1 || inst->kinds[0] != OPERAND_LABEL ||
+        (uint32_t)inst->values[0] >= encoder->label_count) {
+        return -1;
+    }
+    switch ((InstructionType)inst->type) {
+        case INST_JMP:  emit_byte(code, 0xE9); break;
+        case INST_CALL: emit_byte(code, 0xE8); break;
+        case INST_JE:   emit_byte(code, 0x0F); emit_byte(code, 0x84); break;
+        case INST_JNE:  emit_byte(code, 0x0F); emit_byte(code, 0x85); break;
+        default:        return -1;
+    }
+    add_fixup(encoder, (uint32_t)inst->values[0]);
+    emit_int32(code, 0);
+    return 0;
+}
+
+static int encode_instruction(Encoder* encoder, const Instruction* inst) {
+    MachineCode* code = encoder->code;
+    for (int i = 0; i < inst->operand_count; i++) {
+        if ((inst->kinds[i] == OPERAND_REGISTER || inst->kinds[i] == OPERAND_MEMORY) &&
+            !is_physical(inst, i)) {
+            return -1; // Not allocated
+        }
+    }
+
+    switch ((InstructionType)inst->type) {
+        case INST_MOV: return encode_move(code, inst);
+        case INST_ADD: return encode_alu(code, inst, EXT_ADD);
+        case INST_OR:  return encode_alu(code, inst, EXT_OR);
+        case INST_AND: return encode_alu(code, inst, EXT_AND);
+        case INST_SUB: return encode_alu(code, inst, EXT_SUB);
+        case INST_XOR: return encode_alu(code, inst, EXT_XOR);
+        case INST_CMP: return encode_alu(code, inst, EXT_CMP);
+
+        case INST_TEST:
+            if (inst->kinds[1] == OPERAND_IMMEDIATE) {
+                emit_register_operand(code, 0xF7, 1, 0, inst, 0);
+                emit_int32(code, inst->values[1]);
+            } else if (inst->kinds[1] == OPERAND_REGISTER) {
+                emit_register_operand(code, 0x85, 1, hardware_register[inst->values[1]], inst, 0);
+            } else {
+                return -1;
+            }
+            return 0;
+
+        case INST_NOT:
+            emit_register_operand(code, 0xF7, 1, 2, inst, 0);
+            return 0;
+        case INST_NEG:
+            emit_register_operand(code, 0xF7, 1, 3, inst, 0);
+            return 0;
+
+        case INST_SHL:
+        case INST_SHR:
+            if (inst->kinds[1] != OPERAND_IMMEDIATE) return -1;
+            if (inst->values[1] == 1) { // Shift by one has its own opcode
+                emit_register_operand(code, 0xD1, 1, inst->type == INST_SHL ? 4 : 5, inst, 0);
+                return 0;
+            }
+            emit_register_operand(code, 0xC1, 1, inst->type == INST_SHL ? 4 : 5, inst, 0);
+            emit_byte(code, (uint8_t)inst->values[1]);
+            return 0;
+
+        case INST_BTS:
+        case INST_BTR: {
+            static const uint8_t opcode[] = {0x0F, 0xBA};
+            if (inst->kinds[1] != OPERAND_IMMEDIATE) return -1;
+            emit_operand(code, opcode, 2, 1, inst->type == INST_BTS ? 5 : 6, inst, 0, 0);
+            emit_byte(code, (uint8_t)inst->values[1]);
+            return 0;
+        }
+
+        case INST_MOVZB: {
+            static const uint8_t opcode[] = {0x0F, 0xB6};
+            if (inst->kinds[0] != OPERAND_REGISTER) return -1;
+            emit_operand(code, opcode, 2, 1, hardware_register[inst->values[0]], inst, 1, 0);
+            return 0;
+        }
+        case INST_MOVB: {
+            // Without REX, byte registers 4-7 are AH, CH, DH and BH
+            static const uint8_t opcode[] = {0x88};
+            if (inst->kinds[1] != OPERAND_REGISTER) return -1;
+            int source = hardware_register[inst->values[1]];
+            emit_operand(code, opcode, 1, 0, source, inst, 0, source >= 4 && source <= 7);
+            return 0;
+        }
+
+        case INST_PUSH:
+        case INST_POP: {
+            if (inst->kinds[0] != OPERAND_REGISTER) return -1;
+            int reg = hardware_register[inst->values[0]];
+            if (reg >= 8) emit_byte(code, 0x41);
+            emit_byte(code, (uint8_t)((inst->type == INST_PUSH ? 0x50 : 0x58) + (reg & 7)));
+            return 0;
+        }
+
+        case INST_RET:
+            emit_byte(code, 0xC3);
+            return 0;
+        case INST_SYSCALL:
+            emit_byte(code, 0x0F);
+            emit_byte(code, 0x05);
+            return 0;
+
+        case INST_JMP:
+        case INST_JE:
+        case INST_JNE:
+        case INST_CALL:
+            return encode_branch(encoder, inst);
+
+        case INST_LABEL:
+            if ((uint32_t)inst->values[0] >= encoder->label_count) return -1;
+            encoder->label_offsets[inst->values[0]] = (uint32_t)code->size;
+            return 0;
+
+        default:
+            return -1; // ANDN is batch AVX2 only
+    }
+}
+
+int encode_x86_64(const CodeGenContext* ctx, MachineCode* code) {
+    Encoder encoder = {code, NULL, ctx->label_count, NULL, 0, 0};
+    code->bytes = NULL;
+    code->size = 0;
+    code->capacity = 0;
+
+    encoder.label_offsets = malloc((ctx->label_count + 1) * sizeof(uint32_t));
+    if (!encoder.label_offsets) {
+        fprintf(stderr, "Out of memory for label offsets\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < ctx->label_count; i++) {
+        encoder.label_offsets[i] = UINT32_MAX;
+    }
+
+    int result = 0;
+    for (int i = 0; i < ctx->instruction_count && result == 0; i++) {
+        const Instruction* inst = &ctx->instructions[i];
+        if (encode_instruction(&encoder, inst) != 0) {
+            fprintf(stderr, "Error: cannot encode instruction %d (%s)\n", i,
+                    instruction_to_string((InstructionType)inst->type));
+            result = -1;
+        }
+    }
+
+    // rel32 is relative to the end of its own field
+    for (int i = 0; i < encoder.fixup_count && result == 0; i++) {
+        const LabelFixup* fixup = &encoder.fixups[i];
+        uint32_t target = encoder.label_offsets[fixup->label];
+        if (target == UINT32_MAX) {
+            fprintf(stderr, "Error: label %s is never defined\n", label_name(ctx, fixup->label));
+            result = -1;
+            break;
+        }
+        int32_t displacement = (int32_t)(target - (fixup->offset + 4));
+        memcpy(code->bytes + fixup->offset, &displacement, 4);
+    }
+
+    free(encoder.label_offsets);
+    free(encoder.fixups);
+    if (result != 0) {
+        free_machine_code(code);
+    }
+    return result;
+}
+
+void free_machine_code(MachineCode* code) {
+    free(code->bytes);
+    code->bytes = NULL;
+    code->size = 0;
+    code->capacity = 0;
+}
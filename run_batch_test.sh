@@ -0,0 +1,171 @@
+#!/bin/bash
+
+# Batch Kernel Test Suite for Roadmap Compiler
+# Compiles one program with logicc -b and checks every kernel against a
+# per-record C reference over several blocks of records
+echo "╔═══════════════════════════════════════════════════════════════╗"
+echo "║                ROADMAP COMPILER - BATCH TESTS                ║"
+echo "║            Testing AVX2, Scalar and Dispatch Kernels         ║"
+echo "╚═══════════════════════════════════════════════════════════════╝"
+echo
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+BLUE='\033[0;34m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+# Check the driver
+if [ ! -f "logicc/logicc" ]; then
+    echo -e "${RED}❌ Missing executable: logicc/logicc (run make in logicc)${NC}"
+    exit 1
+fi
+if ! command -v gcc > /dev/null 2>&1; then
+    echo -e "${RED}❌ gcc is needed to link the batch harness${NC}"
+    exit 1
+fi
+
+echo -e "${GREEN}✓ Driver found${NC}"
+echo
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# A, B, C and D are inputs: their first assignment is a literal
+cat > "$WORK/batch.txt" << 'EOF'
+A = FALSE
+B = FALSE
+C = FALSE
+D = FALSE
+R_AND = A AND B
+R_OR = A OR B
+R_XOR = A XOR C
+R_XNOR = B XNOR D
+R_IMPL = A -> D
+R_BICOND = C <-> D
+R_EQUIV = B === C
+R_NOT = NOT A
+R_ANDN = C AND NOT D
+R_MIXED = (A AND NOT B) OR ((C XOR NOT D) AND (R_IMPL <-> R_OR))
+R_CHAIN = (A AND B AND C AND D) OR NOT (A OR B OR C OR D)
+EOF
+
+echo -e "${YELLOW}Compiling batch kernels...${NC}"
+if ! ./logicc/logicc -b -o "$WORK/batch.s" "$WORK/batch.txt" > "$WORK/logicc.out" 2>&1; then
+    echo -e "${RED}❌ logicc -b failed${NC}"
+    cat "$WORK/logicc.out"
+    exit 1
+fi
+echo "✓ Kernels written ($(grep -c '^#   lane' "$WORK/batch.s") lanes)"
+
+# Lane indices from the kernel's header comment
+grep '^#   lane' "$WORK/batch.s" | \
+    sed -E 's/^#   lane ([0-9]+): ([A-Za-z0-9_]+).*/#define LANE_\2 \1/' > "$WORK/lanes.h"
+
+cat > "$WORK/harness.c" << 'EOF'
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lanes.h"
+
+void logic_batch(void* block, size_t count);
+void logic_batch_avx2(void* block, size_t count);
+void logic_batch_scalar(void* block, size_t count);
+extern const uint32_t logic_batch_lanes;
+
+#define BLOCKS 7
+
+static int get(const uint8_t* block, int lane, int record) {
+    return (block[lane * 32 + record / 8] >> (record % 8)) & 1;
+}
+
+static void set(uint8_t* block, int lane, int record, int value) {
+    if (value) block[lane * 32 + record / 8] |= (uint8_t)(1 << (record % 8));
+}
+
+// Per-record reference for batch.txt
+static void reference(uint8_t* block, int r) {
+    int a = get(block, LANE_A, r), b = get(block, LANE_B, r);
+    int c = get(block, LANE_C, r), d = get(block, LANE_D, r);
+    int impl = !a | d, or = a | b;
+    set(block, LANE_R_AND, r, a & b);
+    set(block, LANE_R_OR, r, or);
+    set(block, LANE_R_XOR, r, a ^ c);
+    set(block, LANE_R_XNOR, r, !(b ^ d));
+    set(block, LANE_R_IMPL, r, impl);
+    set(block, LANE_R_BICOND, r, !(c ^ d));
+    set(block, LANE_R_EQUIV, r, !(b ^ c));
+    set(block, LANE_R_NOT, r, !a);
+    set(block, LANE_R_ANDN, r, c & !d);
+    set(block, LANE_R_MIXED, r, (a & !b) | ((c ^ !d) & !(impl ^ or)));
+    set(block, LANE_R_CHAIN, r, (a & b & c & d) | !(a | b | c | d));
+}
+
+static int run(const char* name, void (*kernel)(void*, size_t),
+               const uint8_t* input, const uint8_t* expected, size_t size) {
+    uint8_t* buffer = aligned_alloc(32, size);
+    memcpy(buffer, input, size);
+    kernel(buffer, BLOCKS);
+    int wrong = memcmp(buffer, expected, size) != 0;
+    printf("%s %s\n", wrong ? "❌" : "✓", name);
+    free(buffer);
+    return wrong;
+}
+
+int main(void) {
+    size_t stride = (size_t)logic_batch_lanes * 32;
+    size_t size = stride * BLOCKS;
+    uint8_t* input = aligned_alloc(32, size);
+    uint8_t* expected = aligned_alloc(32, size);
+
+    // Inputs from a fixed LCG; computed lanes start as garbage in the input
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245u + 12345u;
+        input[i] = (uint8_t)(seed >> 16);
+    }
+    memset(expected, 0, size);
+    for (int b = 0; b < BLOCKS; b++) {
+        uint8_t* in = input + b * stride;
+        uint8_t* out = expected + b * stride;
+        memcpy(out + LANE_A * 32, in + LANE_A * 32, 32);
+        memcpy(out + LANE_B * 32, in + LANE_B * 32, 32);
+        memcpy(out + LANE_C * 32, in + LANE_C * 32, 32);
+        memcpy(out + LANE_D * 32, in + LANE_D * 32, 32);
+        for (int r = 0; r < 256; r++) reference(out, r);
+    }
+
+    int failed = 0;
+    if (__builtin_cpu_supports("avx2")) {
+        failed += run("logic_batch_avx2", logic_batch_avx2, input, expected, size);
+    } else {
+        printf("- logic_batch_avx2 skipped (no AVX2)\n");
+    }
+    failed += run("logic_batch_scalar", logic_batch_scalar, input, expected, size);
+    failed += run("logic_batch", logic_batch, input, expected, size);
+
+    free(input);
+    free(expected);
+    return failed;
+}
+EOF
+
+echo -e "${YELLOW}Linking harness...${NC}"
+if ! gcc -O1 -I "$WORK" -o "$WORK/harness" "$WORK/harness.c" "$WORK/batch.s"; then
+    echo -e "${RED}❌ Harness failed to build${NC}"
+    exit 1
+fi
+echo
+
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+echo -e "${BLUE}                      BATCH TEST RESULTS                       ${NC}"
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+if "$WORK/harness"; then
+    echo
+    echo -e "${GREEN}🎉 ALL BATCH TESTS PASSED! 🎉${NC}"
+else
+    echo
+    echo -e "${RED}❌ BATCH TESTS FAILED${NC}"
+    exit 1
+fi
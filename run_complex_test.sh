@@ -49,7 +49,7 @@ run_complex_test() {
     # Phase 1
     echo "Phase 1: Lexical Analysis"
     cd phase1
-    if ./lexer > /dev/null 2>&1; then
+    if ./lexer --text > /dev/null 2>&1; then
         echo "✓ Lexical analysis passed"
         TOKEN_COUNT=$(grep -v '^#' tokens.txt | grep -v '^$' | grep -v '^EOF' | wc -l 2>/dev/null || echo "0")
         echo "  Generated $TOKEN_COUNT tokens"
@@ -65,7 +65,7 @@ run_complex_test() {
     # Phase 2
     echo "Phase 2: Syntax Analysis"
     cd phase2
-    if ./parser_test ../phase1/tokens.txt > /dev/null 2>&1; then
+    if ./parser_test --text ../phase1/tokens.bin > /dev/null 2>&1; then
         echo "✓ Syntax analysis passed"
         AST_LINES=$(wc -l < ast.txt 2>/dev/null || echo "0")
         echo "  AST generated: $AST_LINES lines"
@@ -81,7 +81,7 @@ run_complex_test() {
     # Phase 3
     echo "Phase 3: Semantic Analysis"
     cd phase3
-    if ./semantic_analyzer ../phase2/ast.txt > /dev/null 2>&1; then
+    if ./semantic_analyzer ../phase2/ast.bin > /dev/null 2>&1; then
         echo "✓ Semantic analysis passed"
     else
         echo "❌ Semantic analysis failed"
@@ -95,7 +95,7 @@ run_complex_test() {
     # Phase 4
     echo "Phase 4: Code Generation"
     cd phase4
-    if ./code_generator ../phase3/annotated_ast.txt > /dev/null 2>&1; then
+    if ./code_generator ../phase3/annotated_ast.bin > /dev/null 2>&1; then
         echo "✓ Code generation passed"
         INST_COUNT=$(grep -c "^    " program.s 2>/dev/null || echo "0")
         echo "  Assembly instructions: $INST_COUNT"
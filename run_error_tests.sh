@@ -59,7 +59,7 @@ run_error_test() {
     # Phase 1: Lexical Analysis
     echo "Phase 1: Lexical Analysis"
     cd phase1
-    if ./lexer > lexer_error.log 2>&1; then
+    if ./lexer --text > lexer_error.log 2>&1; then
         echo "✓ Lexical analysis passed"
         TOKEN_COUNT=$(grep -v '^#' tokens.txt | grep -v '^$' | grep -v '^EOF' | wc -l 2>/dev/null || echo "0")
         echo "  Generated $TOKEN_COUNT tokens"
@@ -87,7 +87,7 @@ run_error_test() {
     # Phase 2: Syntax Analysis
     echo "Phase 2: Syntax Analysis"
     cd phase2
-    if ./parser_test ../phase1/tokens.txt > parser_error.log 2>&1; then
+    if ./parser_test --text ../phase1/tokens.bin > parser_error.log 2>&1; then
         echo "✓ Syntax analysis passed"
         AST_LINES=$(wc -l < ast.txt 2>/dev/null || echo "0")
         echo "  AST generated: $AST_LINES lines"
@@ -115,7 +115,7 @@ run_error_test() {
     # Phase 3: Semantic Analysis
     echo "Phase 3: Semantic Analysis"
     cd phase3
-    if ./semantic_analyzer ../phase2/ast.txt > semantic_error.log 2>&1; then
+    if ./semantic_analyzer ../phase2/ast.bin > semantic_error.log 2>&1; then
         # Check if semantic errors were reported but analysis continued
         if grep -q "error\|Error\|❌" semantic_error.log; then
             echo -e "${RED}❌ Semantic errors detected${NC}"
@@ -154,7 +154,7 @@ run_error_test() {
     if [ "$phase_failed" != "Phase3" ]; then
         echo "Phase 4: Code Generation"
         cd phase4
-        if ./code_generator ../phase3/annotated_ast.txt > codegen_error.log 2>&1; then
+        if ./code_generator ../phase3/annotated_ast.bin > codegen_error.log 2>&1; then
             echo "✓ Code generation passed"
             INST_COUNT=$(grep -c "^    " program.s 2>/dev/null || echo "0")
             echo "  Assembly instructions: $INST_COUNT"
@@ -306,6 +306,14 @@ run_error_test "Whitespace Only Input" \
 "No meaningful tokens" \
 "Input with only whitespace should be handled"
 
+# Test 11: Semantic Error - Quantified variable used outside its quantifier
+run_error_test "Quantifier Binding Out Of Scope" \
+"R = E_Q Q (Q AND TRUE)
+S = Q" \
+"Phase3" \
+"Undefined variable error" \
+"A quantifier binds its variable only within its body"
+
 # Cleanup
 rm -f test.txt
 
@@ -0,0 +1,124 @@
+#!/bin/bash
+
+# Constant Folding Test Suite for Roadmap Compiler
+# Checks that semantic analysis propagates constant assignments and folds
+# every operator, that a compiled program stores the folded values without
+# evaluating any expression, and that batch kernels and the VM fold only
+# what holds whatever the inputs are
+echo "╔═══════════════════════════════════════════════════════════════╗"
+echo "║            ROADMAP COMPILER - CONSTANT FOLDING TESTS         ║"
+echo "║        Testing Propagation, Folded Stores and Inputs         ║"
+echo "╚═══════════════════════════════════════════════════════════════╝"
+echo
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+BLUE='\033[0;34m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+# Check the driver
+if [ ! -f "logicc/logicc" ]; then
+    echo -e "${RED}❌ Missing executable: logicc/logicc (run make in logicc)${NC}"
+    exit 1
+fi
+
+echo -e "${GREEN}✓ Driver found${NC}"
+echo
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# A and B are inputs outside program mode. P, Q and R fold only with their
+# declared values; K, Z and the expression statement fold without them,
+# Z because NOT K is FALSE whatever B is.
+cat > "$WORK/fold.txt" << 'EOF'
+A = TRUE
+B = FALSE
+P = A AND NOT B
+Q = P -> B
+R = Q <-> (A XOR B)
+K = NOT FALSE
+Z = B AND NOT K
+W = (B OR K) -> A
+Z OR NOT K
+EOF
+
+# Name and value of each constant symbol table entry
+constants() {
+    grep -E '(TRUE|FALSE)$' "$1" | awk '{print $1, $NF}'
+}
+
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+echo -e "${BLUE}                 CONSTANT FOLDING TEST RESULTS                 ${NC}"
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+
+FAILED=0
+echo -e "${YELLOW}Compiling a program...${NC}"
+if ! (cd "$WORK" && "$OLDPWD/logicc/logicc" -d fold.txt > program.out 2>&1); then
+    echo -e "${RED}❌ logicc failed${NC}"
+    tail -5 "$WORK/program.out"
+    exit 1
+fi
+SUMMARY=$(grep -E "^Constant folding" "$WORK/program.out")
+if [ "$SUMMARY" == "Constant folding: 7 of 9 statements folded, 3 without the inputs" ]; then
+    echo "✓ $SUMMARY"
+else
+    echo -e "${RED}❌ Unexpected folding summary: $SUMMARY${NC}"
+    FAILED=1
+fi
+EXPECTED="A TRUE
+B FALSE
+P TRUE
+Q FALSE
+R FALSE
+K TRUE
+Z FALSE
+W TRUE"
+if [ "$(constants "$WORK/symbol_table.txt")" == "$EXPECTED" ]; then
+    echo "✓ Every variable folded to its value"
+else
+    echo -e "${RED}❌ Folded values differ${NC}"
+    diff <(echo "$EXPECTED") <(constants "$WORK/symbol_table.txt")
+    FAILED=1
+fi
+# Flag-word stores only: no operator is evaluated
+if grep -qE '^\s+(andq|orq|notq)|xorq +\$1' "$WORK/program.s"; then
+    echo -e "${RED}❌ program.s still evaluates expressions${NC}"
+    FAILED=1
+else
+    echo "✓ program.s stores the folded values"
+fi
+echo
+
+echo -e "${YELLOW}Compiling batch kernels...${NC}"
+(cd "$WORK" && "$OLDPWD/logicc/logicc" -b fold.txt > batch.out 2>&1)
+FOLDED=$(grep -c "Folded" "$WORK/batch.s")
+if [ "$FOLDED" == "2" ]; then
+    echo "✓ Only K and Z are folded; P, Q, R and W read the input lanes"
+else
+    echo -e "${RED}❌ $FOLDED folded stores, expected 2${NC}"
+    FAILED=1
+fi
+echo
+
+echo -e "${YELLOW}Running on the VM...${NC}"
+./logicc/logicc -i "$WORK/fold.txt" > "$WORK/vm.out" 2>&1
+VM=$(sed -n '/^VM RUN/,$p' "$WORK/vm.out" | grep -E '^  ' | awk '{print $1, $2}')
+if [ "$VM" == "$EXPECTED
+Result: 0" ]; then
+    echo "✓ Variables and result match the folded values"
+else
+    echo -e "${RED}❌ VM run differs${NC}"
+    echo "$VM"
+    FAILED=1
+fi
+
+if [ $FAILED -eq 0 ]; then
+    echo
+    echo -e "${GREEN}🎉 ALL CONSTANT FOLDING TESTS PASSED! 🎉${NC}"
+else
+    echo
+    echo -e "${RED}❌ CONSTANT FOLDING TESTS FAILED${NC}"
+    exit 1
+fi
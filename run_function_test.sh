@@ -0,0 +1,143 @@
+#!/bin/bash
+
+# Rule Function Test Suite for Roadmap Compiler
+# Builds one program with logicc -f into a static library, links it into a
+# C harness and checks every input combination against a C reference, and
+# checks that a program assigning an input again is rejected and that a
+# variable only a quantifier binds stays out of the interface
+echo "╔═══════════════════════════════════════════════════════════════╗"
+echo "║            ROADMAP COMPILER - RULE FUNCTION TESTS            ║"
+echo "║           Testing rules_eval from librules.a (System V)      ║"
+echo "╚═══════════════════════════════════════════════════════════════╝"
+echo
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+BLUE='\033[0;34m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+# Check the driver
+if [ ! -f "logicc/logicc" ]; then
+    echo -e "${RED}❌ Missing executable: logicc/logicc (run make in logicc)${NC}"
+    exit 1
+fi
+if ! command -v gcc > /dev/null 2>&1; then
+    echo -e "${RED}❌ gcc is needed to link the rule harness${NC}"
+    exit 1
+fi
+
+echo -e "${GREEN}✓ Driver found${NC}"
+echo
+
+LOGICC="$(pwd)/logicc/logicc"
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# A, B, C and D are inputs: their first assignment is a literal
+cat > "$WORK/rules.txt" << 'EOF'
+A = FALSE
+B = FALSE
+C = FALSE
+D = FALSE
+R_AND = A AND B
+R_OR = A OR B
+R_XOR = A XOR C
+R_XNOR = B XNOR D
+R_IMPL = A -> D
+R_BICOND = C <-> D
+R_EQUIV = B === C
+R_NOT = NOT A
+R_MIXED = (A AND NOT B) OR ((C XOR NOT D) AND (R_IMPL <-> R_OR))
+(A AND B AND C AND D) OR NOT (A OR B OR C OR D)
+EOF
+
+echo -e "${YELLOW}Building librules.a...${NC}"
+if ! (cd "$WORK" && "$LOGICC" -f rules rules.txt > logicc.out 2>&1); then
+    echo -e "${RED}❌ logicc -f failed${NC}"
+    cat "$WORK/logicc.out"
+    exit 1
+fi
+echo "✓ rules.s, rules.h, rules.o and librules.a written"
+
+# An input has no output, so assigning one again must be rejected
+cat > "$WORK/reassigned.txt" << 'EOF'
+A = TRUE
+A = NOT A
+B = A
+EOF
+if (cd "$WORK" && "$LOGICC" -f reassigned reassigned.txt > reassigned.out 2>&1); then
+    echo -e "${RED}❌ A reassigned input was accepted${NC}"
+    exit 1
+fi
+echo "✓ Rejected: $(grep -E '^Error' "$WORK/reassigned.out")"
+
+# A variable only a quantifier binds is neither an input nor an output
+cat > "$WORK/bound.txt" << 'EOF'
+A = TRUE
+R = E_Q Q (Q AND A)
+EOF
+if ! (cd "$WORK" && "$LOGICC" -f bound bound.txt > bound.out 2>&1) ||
+   grep -q '_Q ' "$WORK/bound.h"; then
+    echo -e "${RED}❌ A quantified variable appears in the interface${NC}"
+    exit 1
+fi
+echo "✓ Quantified variable kept out of bound.h"
+
+cat > "$WORK/harness.c" << 'EOF'
+#include <stdio.h>
+#include "rules.h"
+
+int main(void) {
+    int failed = 0;
+    for (int bits = 0; bits < 16; bits++) {
+        uint8_t in[RULES_INPUT_COUNT], out[RULES_OUTPUT_COUNT];
+        int a = bits & 1, b = (bits >> 1) & 1, c = (bits >> 2) & 1, d = (bits >> 3) & 1;
+
+        // Any nonzero byte is TRUE
+        in[RULES_INPUT_A] = a ? 0x80 : 0;
+        in[RULES_INPUT_B] = b;
+        in[RULES_INPUT_C] = c ? 0xff : 0;
+        in[RULES_INPUT_D] = d ? 2 : 0;
+        int result = rules_eval(in, out);
+
+        int impl = !a | d, or = a | b;
+        int expected[RULES_OUTPUT_COUNT];
+        expected[RULES_OUTPUT_R_AND] = a & b;
+        expected[RULES_OUTPUT_R_OR] = or;
+        expected[RULES_OUTPUT_R_XOR] = a ^ c;
+        expected[RULES_OUTPUT_R_XNOR] = !(b ^ d);
+        expected[RULES_OUTPUT_R_IMPL] = impl;
+        expected[RULES_OUTPUT_R_BICOND] = !(c ^ d);
+        expected[RULES_OUTPUT_R_EQUIV] = !(b ^ c);
+        expected[RULES_OUTPUT_R_NOT] = !a;
+        expected[RULES_OUTPUT_R_MIXED] = (a & !b) | ((c ^ !d) & !(impl ^ or));
+        int wrong = result != ((a & b & c & d) | !(a | b | c | d));
+        for (int i = 0; i < RULES_OUTPUT_COUNT; i++) {
+            wrong |= out[i] != expected[i];
+        }
+        printf("%s A=%d B=%d C=%d D=%d -> %d\n", wrong ? "❌" : "✓", a, b, c, d, result);
+        failed += wrong;
+    }
+    return failed;
+}
+EOF
+
+echo -e "${YELLOW}Linking harness...${NC}"
+if ! gcc -O2 -I "$WORK" -o "$WORK/harness" "$WORK/harness.c" -L "$WORK" -lrules; then
+    echo -e "${RED}❌ Harness failed to build${NC}"
+    exit 1
+fi
+echo
+
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+echo -e "${BLUE}                   RULE FUNCTION TEST RESULTS                  ${NC}"
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+if "$WORK/harness"; then
+    echo
+    echo -e "${GREEN}🎉 ALL RULE FUNCTION TESTS PASSED! 🎉${NC}"
+else
+    echo
+    echo -e "${RED}❌ RULE FUNCTION TESTS FAILED${NC}"
+    exit 1
+fi
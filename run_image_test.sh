@@ -0,0 +1,112 @@
+#!/bin/bash
+
+# Rule Image Test Suite for Roadmap Compiler
+# Writes rule images with logicc -r, loads them with logicc -l and checks
+# that every variable matches logicc -i on the source, that the native
+# code agrees with the VM, and that a truncated image is rejected
+echo "╔═══════════════════════════════════════════════════════════════╗"
+echo "║               ROADMAP COMPILER - RULE IMAGE TESTS            ║"
+echo "║          Testing Image Writing, mmap Loading and Checks      ║"
+echo "╚═══════════════════════════════════════════════════════════════╝"
+echo
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+BLUE='\033[0;34m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+# Check the driver
+if [ ! -f "logicc/logicc" ]; then
+    echo -e "${RED}❌ Missing executable: logicc/logicc (run make in logicc)${NC}"
+    exit 1
+fi
+
+echo -e "${GREEN}✓ Driver found${NC}"
+echo
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+cat > "$WORK/rules.txt" << 'EOF'
+A = TRUE
+B = FALSE
+C = TRUE
+D = FALSE
+R_AND = A AND B AND C AND NOT D
+R_OR = A OR B OR NOT C
+R_XOR = A XOR C
+R_IMPL = A -> D
+R_BICOND = C <-> D
+R_MIXED = (A AND NOT B) OR ((C XOR NOT D) AND (R_IMPL <-> R_OR))
+R_AND OR R_MIXED
+EOF
+
+# Quantified rules, expanded over the bound variable in native code
+cat > "$WORK/quantifiers.txt" << 'EOF'
+A = TRUE
+B = FALSE
+R_EXISTS = E_Q Q (Q AND A)
+R_FORALL = U_Q Q (Q OR B)
+R_EXISTS AND NOT R_FORALL
+EOF
+
+# Variable lines of a VM RUN listing
+variables() {
+    sed -n '/^VM RUN/,$p' "$1" | grep -E '^  '
+}
+
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+echo -e "${BLUE}                   RULE IMAGE TEST RESULTS                     ${NC}"
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+
+FAILED=0
+for NAME in rules quantifiers; do
+    echo -e "${YELLOW}Testing $NAME.txt...${NC}"
+    if ! ./logicc/logicc -r "$WORK/$NAME.img" "$WORK/$NAME.txt" > "$WORK/$NAME.write" 2>&1; then
+        echo -e "${RED}❌ logicc -r failed${NC}"
+        grep -E "Error" "$WORK/$NAME.write"
+        FAILED=1
+        continue
+    fi
+    ./logicc/logicc -i "$WORK/$NAME.txt" > "$WORK/$NAME.vm" 2>&1
+    if ! ./logicc/logicc -l "$WORK/$NAME.img" > "$WORK/$NAME.load" 2>&1; then
+        echo -e "${RED}❌ logicc -l failed${NC}"
+        cat "$WORK/$NAME.load"
+        FAILED=1
+        continue
+    fi
+    grep -E "Ready in" "$WORK/$NAME.load" | sed 's/^│ /  /'
+    if [ "$(variables "$WORK/$NAME.vm")" == "$(variables "$WORK/$NAME.load")" ]; then
+        echo "✓ Variables and result match logicc -i"
+    else
+        echo -e "${RED}❌ Image and source runs differ${NC}"
+        diff <(variables "$WORK/$NAME.vm") <(variables "$WORK/$NAME.load")
+        FAILED=1
+    fi
+    if grep -q "same result and outputs as the VM" "$WORK/$NAME.load"; then
+        echo "✓ Native code agrees with the VM"
+    else
+        echo -e "${RED}❌ Native code differs from the VM${NC}"
+        FAILED=1
+    fi
+    echo
+done
+
+echo -e "${YELLOW}Loading a truncated image...${NC}"
+head -c 100 "$WORK/rules.img" > "$WORK/truncated.img"
+if ./logicc/logicc -l "$WORK/truncated.img" > "$WORK/truncated.load" 2>&1; then
+    echo -e "${RED}❌ Truncated image was loaded${NC}"
+    FAILED=1
+else
+    echo "✓ Rejected: $(grep -E '^Error' "$WORK/truncated.load")"
+fi
+
+if [ $FAILED -eq 0 ]; then
+    echo
+    echo -e "${GREEN}🎉 ALL RULE IMAGE TESTS PASSED! 🎉${NC}"
+else
+    echo
+    echo -e "${RED}❌ RULE IMAGE TESTS FAILED${NC}"
+    exit 1
+fi
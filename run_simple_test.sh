@@ -57,7 +57,7 @@ run_simple_test() {
     # Phase 1
     echo "Phase 1: Lexical Analysis"
     cd phase1
-    if ./lexer > /dev/null 2>&1; then
+    if ./lexer --text > /dev/null 2>&1; then
         echo "✓ Lexical analysis passed"
         TOKEN_COUNT=$(grep -v '^#' tokens.txt | grep -v '^$' | grep -v '^EOF' | wc -l 2>/dev/null || echo "0")
         echo "  Generated $TOKEN_COUNT tokens"
@@ -73,7 +73,7 @@ run_simple_test() {
     # Phase 2
     echo "Phase 2: Syntax Analysis"
     cd phase2
-    if ./parser_test ../phase1/tokens.txt > /dev/null 2>&1; then
+    if ./parser_test ../phase1/tokens.bin > /dev/null 2>&1; then
         echo "✓ Syntax analysis passed"
     else
         echo "❌ Syntax analysis failed"
@@ -87,7 +87,7 @@ run_simple_test() {
     # Phase 3
     echo "Phase 3: Semantic Analysis"
     cd phase3
-    if ./semantic_analyzer ../phase2/ast.txt > /dev/null 2>&1; then
+    if ./semantic_analyzer ../phase2/ast.bin > /dev/null 2>&1; then
         echo "✓ Semantic analysis passed"
     else
         echo "❌ Semantic analysis failed"
@@ -101,7 +101,7 @@ run_simple_test() {
     # Phase 4
     echo "Phase 4: Code Generation"
     cd phase4
-    if ./code_generator ../phase3/annotated_ast.txt > /dev/null 2>&1; then
+    if ./code_generator ../phase3/annotated_ast.bin > /dev/null 2>&1; then
         echo "✓ Code generation passed"
     else
         echo "❌ Code generation failed"
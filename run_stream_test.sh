@@ -0,0 +1,173 @@
+#!/bin/bash
+
+# Streaming Evaluator Test Suite for Roadmap Compiler
+# Links an evaluator with logicc -s, runs it over a record file that ends
+# in a partial block and checks every result bit against a per-record C
+# reference, then checks that a file of partial records is rejected
+echo "╔═══════════════════════════════════════════════════════════════╗"
+echo "║          ROADMAP COMPILER - STREAMING EVALUATOR TESTS        ║"
+echo "║        Testing Record Files, Bit-Slicing and Result Columns  ║"
+echo "╚═══════════════════════════════════════════════════════════════╝"
+echo
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+BLUE='\033[0;34m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+# Check the driver
+if [ ! -f "logicc/logicc" ]; then
+    echo -e "${RED}❌ Missing executable: logicc/logicc (run make in logicc)${NC}"
+    exit 1
+fi
+if ! command -v gcc > /dev/null 2>&1; then
+    echo -e "${RED}❌ gcc is needed to link the evaluator${NC}"
+    exit 1
+fi
+
+echo -e "${GREEN}✓ Driver found${NC}"
+echo
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# A, B, C and D are inputs: their first assignment is a literal
+cat > "$WORK/stream.txt" << 'EOF'
+A = FALSE
+B = FALSE
+C = FALSE
+D = FALSE
+R_AND = A AND B
+R_XOR = A XOR C
+R_IMPL = A -> D
+R_NOT = NOT A
+R_MIXED = (A AND NOT B) OR ((C XOR NOT D) AND (R_IMPL <-> R_XOR))
+EOF
+
+# Writes records.bin, or checks results.bin against a per-record reference
+cat > "$WORK/check.c" << 'EOF'
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Two full 1M-record chunks, then a chunk ending in a partial block and a
+// partial byte
+#define RECORDS 2500003
+
+static uint8_t records[RECORDS * 4];
+
+static void make_records(void) {
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sizeof(records); i++) {
+        seed = seed * 1103515245u + 12345u;
+        uint8_t value = (uint8_t)(seed >> 16);
+        records[i] = value & 1 ? value : 0;   // Any nonzero byte is TRUE
+    }
+}
+
+static int reference(const char* name, const uint8_t* record) {
+    int a = record[0] != 0, b = record[1] != 0, c = record[2] != 0, d = record[3] != 0;
+    int impl = !a | d, xor = a ^ c;
+    if (strcmp(name, "R_AND") == 0) return a & b;
+    if (strcmp(name, "R_XOR") == 0) return xor;
+    if (strcmp(name, "R_IMPL") == 0) return impl;
+    if (strcmp(name, "R_NOT") == 0) return !a;
+    if (strcmp(name, "R_MIXED") == 0) return (a & !b) | ((c ^ !d) & !(impl ^ xor));
+    return -1;
+}
+
+int main(int argc, char* argv[]) {
+    make_records();
+    if (argc == 3 && strcmp(argv[1], "write") == 0) {
+        FILE* file = fopen(argv[2], "wb");
+        fwrite(records, 1, sizeof(records), file);
+        return fclose(file) != 0;
+    }
+
+    FILE* file = fopen(argv[2], "rb");
+    if (!file) return 1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    uint8_t* results = malloc(size);
+    if (fread(results, 1, size, file) != (size_t)size) return 1;
+    fclose(file);
+
+    uint32_t columns, names_size;
+    uint64_t record_count, column_bytes;
+    memcpy(&columns, results + 12, 4);
+    memcpy(&record_count, results + 16, 8);
+    memcpy(&column_bytes, results + 24, 8);
+    memcpy(&names_size, results + 32, 4);
+    if (memcmp(results, "LOGICRES", 8) != 0 || record_count != RECORDS || columns != 5) {
+        printf("❌ Bad header\n");
+        return 1;
+    }
+
+    int failed = 0;
+    const char* name = (const char*)results + 40;
+    for (uint32_t i = 0; i < columns; i++, name += strlen(name) + 1) {
+        const uint8_t* column = results + 40 + names_size + i * column_bytes;
+        long wrong = 0;
+        for (uint64_t r = 0; r < column_bytes * 8; r++) {
+            int bit = (column[r / 8] >> (r % 8)) & 1;
+            int expected = r < RECORDS ? reference(name, records + r * 4) : 0;
+            wrong += bit != expected;
+        }
+        printf("%s %s: %ld wrong bits\n", wrong ? "❌" : "✓", name, wrong);
+        failed |= wrong != 0;
+    }
+    free(results);
+    return failed;
+}
+EOF
+
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+echo -e "${BLUE}                STREAMING EVALUATOR TEST RESULTS               ${NC}"
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+
+echo -e "${YELLOW}Linking the evaluator...${NC}"
+if ! (cd "$WORK" && "$OLDPWD/logicc/logicc" -s evaluator stream.txt > logicc.out 2>&1); then
+    echo -e "${RED}❌ logicc -s failed${NC}"
+    tail -5 "$WORK/logicc.out"
+    exit 1
+fi
+if ! gcc -O1 -o "$WORK/check" "$WORK/check.c"; then
+    echo -e "${RED}❌ Checker failed to build${NC}"
+    exit 1
+fi
+echo "✓ Evaluator linked"
+echo
+
+FAILED=0
+echo -e "${YELLOW}Evaluating records...${NC}"
+"$WORK/check" write "$WORK/records.bin"
+if "$WORK/evaluator" "$WORK/records.bin" "$WORK/results.bin" > "$WORK/run.out" 2>&1; then
+    grep -E "records/s" "$WORK/run.out" | sed 's/^│ /  /'
+    "$WORK/check" check "$WORK/results.bin" || FAILED=1
+else
+    echo -e "${RED}❌ Evaluator failed${NC}"
+    cat "$WORK/run.out"
+    FAILED=1
+fi
+echo
+
+echo -e "${YELLOW}Evaluating a partial record...${NC}"
+printf 'abcde' > "$WORK/partial.bin"
+if "$WORK/evaluator" "$WORK/partial.bin" "$WORK/partial.out" > "$WORK/partial.log" 2>&1; then
+    echo -e "${RED}❌ Partial record was accepted${NC}"
+    FAILED=1
+else
+    echo "✓ Rejected: $(grep -E '^Error' "$WORK/partial.log")"
+fi
+
+if [ $FAILED -eq 0 ]; then
+    echo
+    echo -e "${GREEN}🎉 ALL STREAMING EVALUATOR TESTS PASSED! 🎉${NC}"
+else
+    echo
+    echo -e "${RED}❌ STREAMING EVALUATOR TESTS FAILED${NC}"
+    exit 1
+fi
@@ -0,0 +1,107 @@
+#!/bin/bash
+
+# Bytecode VM Test Suite for Roadmap Compiler
+# Runs quantified rules on the VM with logicc -i against known values, and
+# benchmarks the VM against the JIT with logicc -n on plain and quantified
+# rules, which checks that both produce the same outputs
+echo "╔═══════════════════════════════════════════════════════════════╗"
+echo "║              ROADMAP COMPILER - BYTECODE VM TESTS            ║"
+echo "║          Testing the Interpreter, Quantifiers and JIT        ║"
+echo "╚═══════════════════════════════════════════════════════════════╝"
+echo
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+BLUE='\033[0;34m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+# Check the driver
+if [ ! -f "logicc/logicc" ]; then
+    echo -e "${RED}❌ Missing executable: logicc/logicc (run make in logicc)${NC}"
+    exit 1
+fi
+
+echo -e "${GREEN}✓ Driver found${NC}"
+echo
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# A is TRUE and B FALSE; Q is only ever bound by a quantifier
+cat > "$WORK/quantifiers.txt" << 'EOF'
+A = TRUE
+B = FALSE
+R_EXISTS = E_Q A (A AND B)
+R_FORALL = U_Q Q (Q OR A)
+R_NEVER = E_Q Q (Q AND NOT Q)
+R_ALWAYS = U_Q Q (Q OR NOT Q)
+R_NESTED = U_Q Q (E_Q B (Q XNOR B))
+R_RESTORED = A AND NOT B
+R_SHARED = ((A AND B) OR ((A AND B) XOR A)) AND ((A AND B) -> B)
+R_EXISTS OR R_NESTED
+EOF
+
+cat > "$WORK/rules.txt" << 'EOF'
+A = FALSE
+B = FALSE
+C = FALSE
+D = FALSE
+R_AND = A AND B AND C AND NOT D
+R_OR = A OR B OR NOT C
+R_XOR = A XOR C
+R_XNOR = B XNOR D
+R_IMPL = A -> D
+R_BICOND = C <-> D
+R_EQUIV = B === C
+R_NOT = NOT A
+R_ANDN = (A OR B) AND NOT (C XOR D)
+R_MIXED = (A AND NOT B) OR ((C XOR NOT D) AND (R_IMPL <-> R_OR))
+(A AND B AND C AND D) OR NOT (A OR B OR C OR D)
+EOF
+
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+echo -e "${BLUE}                   BYTECODE VM TEST RESULTS                    ${NC}"
+echo -e "${BLUE}═══════════════════════════════════════════════════════════════${NC}"
+
+FAILED=0
+echo -e "${YELLOW}Interpreting quantified rules...${NC}"
+if ! ./logicc/logicc -i "$WORK/quantifiers.txt" > "$WORK/vm.out" 2>&1; then
+    echo -e "${RED}❌ logicc -i failed${NC}"
+    cat "$WORK/vm.out"
+    exit 1
+fi
+for EXPECTED in "R_EXISTS FALSE" "R_FORALL TRUE" "R_NEVER FALSE" "R_ALWAYS TRUE" \
+                "R_NESTED TRUE" "R_RESTORED TRUE" "R_SHARED TRUE" "Result: 1"; do
+    NAME=${EXPECTED% *}
+    VALUE=${EXPECTED##* }
+    if grep -qE "^  ${NAME} +${VALUE}\$" "$WORK/vm.out"; then
+        echo "✓ ${NAME%:} = $VALUE"
+    else
+        echo -e "${RED}❌ $NAME: expected $VALUE, got $(grep -E "^  ${NAME} " "$WORK/vm.out")${NC}"
+        FAILED=1
+    fi
+done
+echo
+
+for NAME in rules quantifiers; do
+    echo -e "${YELLOW}Benchmarking the VM against the JIT on $NAME.txt...${NC}"
+    if ./logicc/logicc -n 100000 "$WORK/$NAME.txt" > "$WORK/$NAME.bench" 2>&1 &&
+       grep -q "Results agree" "$WORK/$NAME.bench"; then
+        grep -E "ns per evaluation|faster|agree" "$WORK/$NAME.bench" | sed 's/^│ //'
+    else
+        echo -e "${RED}❌ VM and JIT results differ${NC}"
+        grep -E "differ|Error" "$WORK/$NAME.bench"
+        FAILED=1
+    fi
+    echo
+done
+
+if [ $FAILED -eq 0 ]; then
+    echo
+    echo -e "${GREEN}🎉 ALL BYTECODE VM TESTS PASSED! 🎉${NC}"
+else
+    echo
+    echo -e "${RED}❌ BYTECODE VM TESTS FAILED${NC}"
+    exit 1
+fi